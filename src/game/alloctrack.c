@@ -0,0 +1,400 @@
+#include "alloctrack.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(GAME_TRACK_ALLOCATIONS)
+
+int AllocTrack_isEnabled()
+{
+    return 0;
+}
+
+void AllocTrack_beginFrame()
+{
+}
+
+void AllocTrack_endFrame()
+{
+}
+
+void AllocTrack_allowFrame(const char *reason)
+{
+    (void)reason;
+}
+
+void AllocTrack_setSteadyState(int afterFrames)
+{
+    (void)afterFrames;
+}
+
+AllocTrackStats AllocTrack_getStats()
+{
+    return (AllocTrackStats){0};
+}
+
+void AllocTrack_logSites()
+{
+}
+
+void *AllocTrack_memAlloc(unsigned int size, const char *file, int line)
+{
+    (void)file, (void)line;
+    return MemAlloc(size);
+}
+
+void *AllocTrack_memRealloc(void *ptr, unsigned int size, const char *file, int line)
+{
+    (void)file, (void)line;
+    return MemRealloc(ptr, size);
+}
+
+void AllocTrack_memFree(void *ptr)
+{
+    MemFree(ptr);
+}
+
+void AllocTrack_recordArena(size_t size)
+{
+    (void)size;
+}
+
+// a raylib built with the hooks still links when the tracking is compiled out
+void *AllocTrack_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *AllocTrack_calloc(size_t count, size_t size)
+{
+    return calloc(count, size);
+}
+
+void *AllocTrack_realloc(void *ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+void AllocTrack_free(void *ptr)
+{
+    free(ptr);
+}
+
+#else
+
+#if defined(PLATFORM_WEB)
+#define ALLOCTRACK_THREAD
+#define ALLOCTRACK_LOCK()
+#define ALLOCTRACK_UNLOCK()
+#else
+#include <pthread.h>
+// the job workers allocate too, e.g. when encoding images (see export.c)
+#define ALLOCTRACK_THREAD __thread
+#define ALLOCTRACK_LOCK() pthread_mutex_lock(&_allocTrackMutex)
+#define ALLOCTRACK_UNLOCK() pthread_mutex_unlock(&_allocTrackMutex)
+static pthread_mutex_t _allocTrackMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// the hooks keep the size of each block in front of it; 16 bytes keep malloc's alignment
+#define ALLOCTRACK_HEADER_SIZE 16
+// new sites go to "other" once the table is this full, which keeps the probing short
+#define ALLOCTRACK_SITE_LIMIT (ALLOCTRACK_MAX_SITES*3/4)
+
+typedef struct AllocSite {
+    // NULL for a free slot; "raylib" for allocations made by raylib itself
+    const char *file;
+    int line;
+    // return address inside raylib, NULL for game call sites
+    void *address;
+    int allocations;
+    size_t bytes;
+} AllocSite;
+
+typedef struct AllocTrack {
+    AllocSite sites[ALLOCTRACK_MAX_SITES];
+    int siteCount;
+    AllocSite other;
+    int isInFrame;
+    // frame from which allocations are fatal, 0: no check
+    int steadyStateFrame;
+    const char *allowReason;
+    int frameAllocations;
+    size_t frameBytes;
+    int frameArenaAllocations;
+    AllocSite *frameSites[ALLOCTRACK_FRAME_SITES];
+    int frameSiteCount;
+    AllocTrackStats stats;
+} AllocTrack;
+
+static AllocTrack _allocTrack;
+
+// call site of the tracked MemAlloc, MemRealloc or MemFree in progress on this thread;
+// a hook that runs inside it records the call under that site and clears it
+static ALLOCTRACK_THREAD int _pendingCall;
+static ALLOCTRACK_THREAD const char *_pendingFile;
+static ALLOCTRACK_THREAD int _pendingLine;
+
+static AllocSite *FindSite(const char *file, int line, void *address)
+{
+    unsigned int hash = (unsigned int)((size_t)file >> 4) * 31u + (unsigned int)line * 2654435761u +
+        (unsigned int)((size_t)address >> 2);
+    for (int i = 0; i < ALLOCTRACK_MAX_SITES; i++)
+    {
+        AllocSite *site = &_allocTrack.sites[(hash + i) % ALLOCTRACK_MAX_SITES];
+        if (site->file == NULL)
+        {
+            if (_allocTrack.siteCount >= ALLOCTRACK_SITE_LIMIT) break;
+            _allocTrack.siteCount++;
+            *site = (AllocSite){ .file = file, .line = line, .address = address };
+            return site;
+        }
+        if (site->file == file && site->line == line && site->address == address) return site;
+    }
+    return &_allocTrack.other;
+}
+
+static void RecordAllocation(const char *file, int line, void *address, size_t size, int isNew)
+{
+    ALLOCTRACK_LOCK();
+    AllocSite *site = FindSite(file, line, address);
+    site->allocations++;
+    site->bytes += size;
+    _allocTrack.stats.totalAllocations++;
+    _allocTrack.stats.totalBytes += size;
+    if (isNew) _allocTrack.stats.liveAllocations++;
+    if (_allocTrack.isInFrame)
+    {
+        _allocTrack.frameAllocations++;
+        _allocTrack.frameBytes += size;
+        int isListed = 0;
+        for (int i = 0; i < _allocTrack.frameSiteCount; i++) isListed |= _allocTrack.frameSites[i] == site;
+        if (!isListed && _allocTrack.frameSiteCount < ALLOCTRACK_FRAME_SITES)
+        {
+            _allocTrack.frameSites[_allocTrack.frameSiteCount++] = site;
+        }
+    }
+    ALLOCTRACK_UNLOCK();
+}
+
+static void RecordFree()
+{
+    ALLOCTRACK_LOCK();
+    _allocTrack.stats.liveAllocations--;
+    ALLOCTRACK_UNLOCK();
+}
+
+static void RecordLiveBytes(size_t freed, size_t allocated)
+{
+    ALLOCTRACK_LOCK();
+    AllocTrackStats *stats = &_allocTrack.stats;
+    stats->isHooked = 1;
+    stats->liveBytes = stats->liveBytes - freed + allocated;
+    if (stats->liveBytes > stats->peakLiveBytes) stats->peakLiveBytes = stats->liveBytes;
+    ALLOCTRACK_UNLOCK();
+}
+
+// records a hooked allocation under the pending game call site or the caller in raylib
+static void RecordHookedAllocation(void *address, size_t size, int isNew)
+{
+    if (_pendingCall)
+    {
+        _pendingCall = 0;
+        RecordAllocation(_pendingFile, _pendingLine, NULL, size, isNew);
+    }
+    else RecordAllocation("raylib", 0, address, size, isNew);
+}
+
+static void LogSite(int logLevel, const AllocSite *site)
+{
+    if (site->address) TraceLog(logLevel, "    raylib %p: %d allocations, %.1f KB", site->address, site->allocations,
+        site->bytes / 1024.0);
+    else TraceLog(logLevel, "    %s:%d: %d allocations, %.1f KB", site->file, site->line, site->allocations,
+        site->bytes / 1024.0);
+}
+
+static int CompareSitesByBytes(const void *a, const void *b)
+{
+    const AllocSite *siteA = *(const AllocSite**)a;
+    const AllocSite *siteB = *(const AllocSite**)b;
+    if (siteA->bytes != siteB->bytes) return siteA->bytes < siteB->bytes ? 1 : -1;
+    return siteB->allocations - siteA->allocations;
+}
+
+int AllocTrack_isEnabled()
+{
+    return 1;
+}
+
+void AllocTrack_beginFrame()
+{
+    ALLOCTRACK_LOCK();
+    _allocTrack.isInFrame = 1;
+    _allocTrack.frameAllocations = 0;
+    _allocTrack.frameBytes = 0;
+    _allocTrack.frameArenaAllocations = 0;
+    _allocTrack.frameSiteCount = 0;
+    _allocTrack.allowReason = NULL;
+    ALLOCTRACK_UNLOCK();
+}
+
+void AllocTrack_endFrame()
+{
+    ALLOCTRACK_LOCK();
+    _allocTrack.isInFrame = 0;
+    AllocTrackStats *stats = &_allocTrack.stats;
+    stats->lastFrameAllocations = _allocTrack.frameAllocations;
+    stats->lastFrameBytes = _allocTrack.frameBytes;
+    stats->lastFrameArenaAllocations = _allocTrack.frameArenaAllocations;
+    if (_allocTrack.frameAllocations > stats->maxFrameAllocations) stats->maxFrameAllocations = _allocTrack.frameAllocations;
+    if (_allocTrack.frameAllocations > 0) stats->allocatingFrames++;
+    int isSteady = _allocTrack.steadyStateFrame > 0 && stats->frame >= _allocTrack.steadyStateFrame;
+    int isAllocating = _allocTrack.frameAllocations > 0 || _allocTrack.frameArenaAllocations > 0;
+    stats->frame++;
+    ALLOCTRACK_UNLOCK();
+
+    if (!isSteady || !isAllocating) return;
+    if (_allocTrack.allowReason)
+    {
+        TraceLog(LOG_DEBUG, "AllocTrack: frame %d allocated %d times, %.1f KB (%s)", stats->frame - 1,
+            _allocTrack.frameAllocations, _allocTrack.frameBytes / 1024.0, _allocTrack.allowReason);
+        return;
+    }
+    TraceLog(LOG_ERROR, "AllocTrack: frame %d allocated %d times, %.1f KB, and %d times from arenas; "
+        "steady state since frame %d; call sites with their totals:", stats->frame - 1, _allocTrack.frameAllocations, _allocTrack.frameBytes / 1024.0,
+        _allocTrack.frameArenaAllocations, _allocTrack.steadyStateFrame);
+    for (int i = 0; i < _allocTrack.frameSiteCount; i++) LogSite(LOG_ERROR, _allocTrack.frameSites[i]);
+    TraceLog(LOG_FATAL, "AllocTrack: allocation in a steady state frame");
+}
+
+void AllocTrack_allowFrame(const char *reason)
+{
+    _allocTrack.allowReason = reason;
+}
+
+void AllocTrack_setSteadyState(int afterFrames)
+{
+    _allocTrack.steadyStateFrame = afterFrames > 0 ? _allocTrack.stats.frame + afterFrames : 0;
+    if (afterFrames > 0) TraceLog(LOG_INFO, "AllocTrack: allocations are fatal from frame %d on",
+        _allocTrack.steadyStateFrame);
+}
+
+AllocTrackStats AllocTrack_getStats()
+{
+    ALLOCTRACK_LOCK();
+    AllocTrackStats stats = _allocTrack.stats;
+    ALLOCTRACK_UNLOCK();
+    return stats;
+}
+
+void AllocTrack_logSites()
+{
+    static AllocSite snapshot[ALLOCTRACK_MAX_SITES + 1];
+    static AllocSite *sorted[ALLOCTRACK_MAX_SITES + 1];
+    ALLOCTRACK_LOCK();
+    memcpy(snapshot, _allocTrack.sites, sizeof(_allocTrack.sites));
+    snapshot[ALLOCTRACK_MAX_SITES] = _allocTrack.other;
+    AllocTrackStats stats = _allocTrack.stats;
+    ALLOCTRACK_UNLOCK();
+
+    int count = 0;
+    for (int i = 0; i <= ALLOCTRACK_MAX_SITES; i++)
+    {
+        if (snapshot[i].allocations > 0) sorted[count++] = &snapshot[i];
+    }
+    qsort(sorted, count, sizeof(sorted[0]), CompareSitesByBytes);
+    TraceLog(LOG_INFO, "AllocTrack: %d allocations, %.1f KB in %d frames, %d of them allocating, at most %d in one frame",
+        stats.totalAllocations, stats.totalBytes / 1024.0, stats.frame, stats.allocatingFrames, stats.maxFrameAllocations);
+    if (stats.isHooked) TraceLog(LOG_INFO, "    live: %d blocks, %.1f KB, peak %.1f KB", stats.liveAllocations,
+        stats.liveBytes / 1024.0, stats.peakLiveBytes / 1024.0);
+    else TraceLog(LOG_INFO, "    live: %d blocks of the game, raylib was built without the hooks", stats.liveAllocations);
+    for (int i = 0; i < count; i++)
+    {
+        if (sorted[i] == &snapshot[ALLOCTRACK_MAX_SITES]) TraceLog(LOG_INFO, "    other: %d allocations, %.1f KB",
+            sorted[i]->allocations, sorted[i]->bytes / 1024.0);
+        else LogSite(LOG_INFO, sorted[i]);
+    }
+}
+
+void *AllocTrack_memAlloc(unsigned int size, const char *file, int line)
+{
+    _pendingCall = 1;
+    _pendingFile = file;
+    _pendingLine = line;
+    void *ptr = (MemAlloc)(size);
+    // without the hooks the call site was not taken
+    if (_pendingCall) RecordAllocation(file, line, NULL, size, ptr != NULL);
+    _pendingCall = 0;
+    return ptr;
+}
+
+void *AllocTrack_memRealloc(void *ptr, unsigned int size, const char *file, int line)
+{
+    _pendingCall = 1;
+    _pendingFile = file;
+    _pendingLine = line;
+    void *result = (MemRealloc)(ptr, size);
+    if (_pendingCall) RecordAllocation(file, line, NULL, size, ptr == NULL && result != NULL);
+    _pendingCall = 0;
+    return result;
+}
+
+void AllocTrack_memFree(void *ptr)
+{
+    if (ptr == NULL) return;
+    _pendingCall = 1;
+    _pendingFile = NULL;
+    (MemFree)(ptr);
+    if (_pendingCall) RecordFree();
+    _pendingCall = 0;
+}
+
+void AllocTrack_recordArena(size_t size)
+{
+    (void)size;
+    ALLOCTRACK_LOCK();
+    if (_allocTrack.isInFrame) _allocTrack.frameArenaAllocations++;
+    ALLOCTRACK_UNLOCK();
+}
+
+void *AllocTrack_malloc(size_t size)
+{
+    char *block = malloc(ALLOCTRACK_HEADER_SIZE + size);
+    if (block == NULL) return NULL;
+    *(size_t*)block = size;
+    RecordLiveBytes(0, size);
+    RecordHookedAllocation(__builtin_return_address(0), size, 1);
+    return block + ALLOCTRACK_HEADER_SIZE;
+}
+
+void *AllocTrack_calloc(size_t count, size_t size)
+{
+    char *block = calloc(1, ALLOCTRACK_HEADER_SIZE + count*size);
+    if (block == NULL) return NULL;
+    *(size_t*)block = count*size;
+    RecordLiveBytes(0, count*size);
+    RecordHookedAllocation(__builtin_return_address(0), count*size, 1);
+    return block + ALLOCTRACK_HEADER_SIZE;
+}
+
+void *AllocTrack_realloc(void *ptr, size_t size)
+{
+    char *block = ptr ? (char*)ptr - ALLOCTRACK_HEADER_SIZE : NULL;
+    size_t oldSize = block ? *(size_t*)block : 0;
+    block = realloc(block, ALLOCTRACK_HEADER_SIZE + size);
+    if (block == NULL) return NULL;
+    *(size_t*)block = size;
+    RecordLiveBytes(oldSize, size);
+    RecordHookedAllocation(__builtin_return_address(0), size, ptr == NULL);
+    return block + ALLOCTRACK_HEADER_SIZE;
+}
+
+void AllocTrack_free(void *ptr)
+{
+    if (ptr == NULL) return;
+    char *block = (char*)ptr - ALLOCTRACK_HEADER_SIZE;
+    RecordLiveBytes(*(size_t*)block, 0);
+    RecordFree();
+    _pendingCall = 0;
+    free(block);
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef __GAME_ALLOCTRACK_H__
+#define __GAME_ALLOCTRACK_H__
+
+#include "raylib.h"
+#include <stddef.h>
+
+// Allocation tracking, compiled in with GAME_TRACK_ALLOCATIONS; without it every function
+// is a no-op. Game modules include this header after raylib.h so that their MemAlloc,
+// MemRealloc and MemFree calls are recorded with the file and line of the call, and
+// Arena_alloc reports arena allocations (see arena.h). raylib's own allocations, e.g. in
+// LoadRenderTexture, LoadModel or LoadImageFromTexture, are only seen when raylib itself
+// is built with the hooks below and linked into the same executable as this module, which
+// is the unity build (GAME_UNITY_BUILD in raylib_game.c):
+//
+//   make CUSTOM_CFLAGS="-D'RL_MALLOC(sz)=AllocTrack_malloc(sz)' -D'RL_CALLOC(n,sz)=AllocTrack_calloc(n,sz)'
+//       -D'RL_REALLOC(ptr,sz)=AllocTrack_realloc(ptr,sz)' -D'RL_FREE(ptr)=AllocTrack_free(ptr)'"
+//
+// Those are recorded under their return address inside raylib, unless they come from a
+// tracked MemAlloc call. Only the hooks know the sizes of freed blocks, so live bytes are
+// 0 without them.
+//
+// Allocations between AllocTrack_beginFrame and AllocTrack_endFrame are counted per frame.
+// After AllocTrack_setSteadyState(n) a frame past the n-th that allocates is fatal: its
+// call sites are logged and raylib's LOG_FATAL ends the program. Frames that allocate on
+// purpose, such as a capture, a script reload or a resize, call AllocTrack_allowFrame.
+// main.c turns the check on in Game_init when GAME_ALLOC_STEADY_FRAMES is defined as n.
+
+// call sites with their own totals; later sites are summed up in one "other" entry
+#define ALLOCTRACK_MAX_SITES 256
+// call sites of the current frame that are logged when the steady state check fails
+#define ALLOCTRACK_FRAME_SITES 8
+
+typedef struct AllocTrackStats {
+    // Game_update frames since the game code was loaded
+    int frame;
+    int lastFrameAllocations;
+    size_t lastFrameBytes;
+    int lastFrameArenaAllocations;
+    int maxFrameAllocations;
+    // frames with at least one heap allocation, allowed ones included
+    int allocatingFrames;
+    int totalAllocations;
+    size_t totalBytes;
+    int liveAllocations;
+    // only with the raylib hooks
+    size_t liveBytes;
+    size_t peakLiveBytes;
+    // raylib was built with the hooks
+    int isHooked;
+} AllocTrackStats;
+
+int AllocTrack_isEnabled();
+// frame boundaries, at the start and at the end of Game_update
+void AllocTrack_beginFrame();
+void AllocTrack_endFrame();
+// exempts the current frame from the steady state check; reason is a string literal
+void AllocTrack_allowFrame(const char *reason);
+// frames after which allocations are fatal, 0 turns the check off
+void AllocTrack_setSteadyState(int afterFrames);
+AllocTrackStats AllocTrack_getStats();
+// logs the call sites by bytes allocated
+void AllocTrack_logSites();
+
+// targets of the macros below
+void *AllocTrack_memAlloc(unsigned int size, const char *file, int line);
+void *AllocTrack_memRealloc(void *ptr, unsigned int size, const char *file, int line);
+void AllocTrack_memFree(void *ptr);
+void AllocTrack_recordArena(size_t size);
+
+// raylib hooks, see above
+void *AllocTrack_malloc(size_t size);
+void *AllocTrack_calloc(size_t count, size_t size);
+void *AllocTrack_realloc(void *ptr, size_t size);
+void AllocTrack_free(void *ptr);
+
+#if defined(GAME_TRACK_ALLOCATIONS)
+#define MemAlloc(size) AllocTrack_memAlloc((size), __FILE__, __LINE__)
+#define MemRealloc(ptr, size) AllocTrack_memRealloc((ptr), (size), __FILE__, __LINE__)
+#define MemFree(ptr) AllocTrack_memFree(ptr)
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+#include "arena.h"
+#include "raylib.h"
+#include "alloctrack.h"
+#include <string.h>
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64*1024)
+#define ARENA_ALIGNMENT 16
+
+struct ArenaBlock {
+    ArenaBlock *next;
+    size_t size;
+    size_t used;
+    // data follows, aligned to ARENA_ALIGNMENT
+};
+
+#define ARENA_HEADER_SIZE ((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+void *Arena_alloc(Arena *arena, size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+#if defined(GAME_TRACK_ALLOCATIONS)
+    AllocTrack_recordArena(size);
+#endif
+    ArenaBlock *block = arena->blocks;
+    if (block == NULL || block->used + size > block->size)
+    {
+        size_t blockSize = arena->blockSize ? arena->blockSize : ARENA_DEFAULT_BLOCK_SIZE;
+        if (blockSize < size) blockSize = size;
+        block = MemAlloc(ARENA_HEADER_SIZE + blockSize);
+        if (block == NULL) return NULL;
+        block->size = blockSize;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+
+    void *ptr = (char*)block + ARENA_HEADER_SIZE + block->used;
+    block->used += size;
+    arena->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+char *Arena_strdup(Arena *arena, const char *str, int length)
+{
+    if (length < 0) length = (int)strlen(str);
+    char *copy = Arena_alloc(arena, length + 1);
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+void Arena_free(Arena *arena)
+{
+    ArenaBlock *block = arena->blocks;
+    while (block)
+    {
+        ArenaBlock *next = block->next;
+        MemFree(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+    arena->used = 0;
+}
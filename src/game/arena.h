@@ -0,0 +1,22 @@
+#ifndef __GAME_ARENA_H__
+#define __GAME_ARENA_H__
+
+#include <stddef.h>
+
+// Bump allocator made of a chain of blocks. Allocations are never moved or freed
+// individually; everything is released at once with Arena_free.
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct Arena {
+    ArenaBlock *blocks;
+    size_t blockSize;       // minimum size of new blocks, 0: default
+    size_t used;            // bytes handed out over all blocks
+} Arena;
+
+// returns 16 byte aligned, zero initialized memory
+void *Arena_alloc(Arena *arena, size_t size);
+char *Arena_strdup(Arena *arena, const char *str, int length);
+void Arena_free(Arena *arena);
+
+#endif
@@ -0,0 +1,662 @@
+#include "bundle.h"
+#include "rlgl.h"
+#include "alloctrack.h"
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+// on windows and the web the bundle is read into memory instead
+#define BUNDLE_USE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define BUNDLE_MAGIC "RBND"
+#define BUNDLE_VERSION 1
+#define BUNDLE_NAME_LENGTH 52
+#define BUNDLE_NONE -1
+#define BUNDLE_MAX_TEXTURES 64
+// larger textures in a bundle are taken for corruption
+#define BUNDLE_MAX_TEXTURE_SIZE 8192
+
+typedef enum BundleEntryType {
+    BUNDLE_ENTRY_DATA = 1,
+    BUNDLE_ENTRY_TEXTURE,
+    BUNDLE_ENTRY_MODEL,
+    BUNDLE_ENTRY_FONT,
+} BundleEntryType;
+
+// file layout: header, entry table, data section; all offsets are relative to the
+// data section and aligned to BUNDLE_ALIGNMENT. Bundle_open checks the entry table, the
+// loaders check every offset and count inside the entries before following it, so a
+// truncated or corrupt file fails to load instead of reading past the mapping.
+typedef struct BundleHeader {
+    char magic[4];
+    int version;
+    int entryCount;
+    int dataOffset;
+} BundleHeader;
+
+typedef struct BundleEntry {
+    char name[BUNDLE_NAME_LENGTH];
+    int type;
+    int offset;
+    int size;
+} BundleEntry;
+
+typedef struct BundleTexture {
+    int width, height;
+    int format;
+    int mipmaps;
+    int dataOffset;
+} BundleTexture;
+
+typedef struct BundleMaterial {
+    Color diffuse;
+    int texture;            // entry index or BUNDLE_NONE for raylib's default texture
+} BundleMaterial;
+
+// vertices, texcoords, texcoords2, normals, tangents, colors, indices
+#define BUNDLE_MESH_ARRAYS 7
+
+typedef struct BundleMesh {
+    int vertexCount;
+    int triangleCount;
+    int material;
+    int arrays[BUNDLE_MESH_ARRAYS];   // offsets or BUNDLE_NONE
+} BundleMesh;
+
+// followed by BundleMaterial[materialCount] and BundleMesh[meshCount]
+typedef struct BundleModel {
+    Matrix transform;
+    int meshCount;
+    int materialCount;
+    int ditherBaked;
+} BundleModel;
+
+typedef struct BundleGlyph {
+    int value;
+    int offsetX, offsetY;
+    int advanceX;
+} BundleGlyph;
+
+typedef struct BundleFont {
+    int baseSize;
+    int glyphCount;
+    int glyphPadding;
+    int texture;
+    int recsOffset;
+    int glyphsOffset;
+} BundleFont;
+
+typedef struct Bundle {
+    unsigned char *base;
+    size_t size;
+    int isMapped;
+    const BundleHeader *header;
+    const BundleEntry *entries;
+    unsigned char *data;
+    size_t dataSize;
+} Bundle;
+
+static Bundle _bundle;
+
+static int IsBundleValid(const Bundle *bundle)
+{
+    if (bundle->size < sizeof(BundleHeader)) return 0;
+    const BundleHeader *header = (const BundleHeader*)bundle->base;
+    if (memcmp(header->magic, BUNDLE_MAGIC, 4) != 0 || header->version != BUNDLE_VERSION) return 0;
+    if (header->entryCount < 0 || header->dataOffset < (int)sizeof(BundleHeader)) return 0;
+    if (header->dataOffset % BUNDLE_ALIGNMENT != 0) return 0;
+    if (sizeof(BundleHeader) + (size_t)header->entryCount*sizeof(BundleEntry) > (size_t)header->dataOffset) return 0;
+    if ((size_t)header->dataOffset > bundle->size || bundle->size - header->dataOffset > INT_MAX) return 0;
+
+    const BundleEntry *entries = (const BundleEntry*)(bundle->base + sizeof(BundleHeader));
+    size_t dataSize = bundle->size - header->dataOffset;
+    for (int i = 0; i < header->entryCount; i++)
+    {
+        if (entries[i].offset < 0 || entries[i].size < 0) return 0;
+        if ((size_t)entries[i].offset + entries[i].size > dataSize) return 0;
+        if (memchr(entries[i].name, '\0', BUNDLE_NAME_LENGTH) == NULL) return 0;
+    }
+    return 1;
+}
+
+int Bundle_open(const char *fileName)
+{
+    Bundle_close();
+    if (!FileExists(fileName)) return 0;
+
+    Bundle bundle = {0};
+#if defined(BUNDLE_USE_MMAP)
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
+    void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return 0;
+    // everything in the bundle is needed at startup, let the kernel read ahead
+    madvise(mapping, st.st_size, MADV_WILLNEED);
+    bundle.base = mapping;
+    bundle.size = st.st_size;
+    bundle.isMapped = 1;
+#else
+    int size = 0;
+    bundle.base = LoadFileData(fileName, &size);
+    bundle.size = size;
+    if (bundle.base == NULL) return 0;
+#endif
+
+    _bundle = bundle;
+    if (!IsBundleValid(&_bundle))
+    {
+        TraceLog(LOG_ERROR, "Bundle: %s is not a valid bundle", fileName);
+        Bundle_close();
+        return 0;
+    }
+    _bundle.header = (const BundleHeader*)_bundle.base;
+    _bundle.entries = (const BundleEntry*)(_bundle.base + sizeof(BundleHeader));
+    _bundle.data = _bundle.base + _bundle.header->dataOffset;
+    _bundle.dataSize = _bundle.size - _bundle.header->dataOffset;
+    TraceLog(LOG_INFO, "Bundle: opened %s, %d entries, %d KB%s", fileName, _bundle.header->entryCount,
+        (int)(_bundle.size / 1024), _bundle.isMapped ? " (mapped)" : "");
+    return 1;
+}
+
+void Bundle_close()
+{
+    if (_bundle.base == NULL) return;
+#if defined(BUNDLE_USE_MMAP)
+    munmap(_bundle.base, _bundle.size);
+#else
+    UnloadFileData(_bundle.base);
+#endif
+    _bundle = (Bundle){0};
+}
+
+int Bundle_isOpen()
+{
+    return _bundle.header != NULL;
+}
+
+static const BundleEntry *FindEntry(const char *name, int type)
+{
+    if (_bundle.header == NULL) return NULL;
+    for (int i = 0; i < _bundle.header->entryCount; i++)
+    {
+        if (_bundle.entries[i].type == type && strcmp(_bundle.entries[i].name, name) == 0) return &_bundle.entries[i];
+    }
+    return NULL;
+}
+
+int Bundle_contains(const char *name)
+{
+    if (_bundle.header == NULL) return 0;
+    for (int i = 0; i < _bundle.header->entryCount; i++)
+    {
+        if (strcmp(_bundle.entries[i].name, name) == 0) return 1;
+    }
+    return 0;
+}
+
+// NULL unless all size bytes at the offset lie inside the data section; every field of
+// the format is 4 bytes, so nothing valid starts at an odd offset
+static void *DataAt(int offset, size_t size)
+{
+    if (offset < 0 || (offset & 3) != 0 || (size_t)offset > _bundle.dataSize || size > _bundle.dataSize - offset) return NULL;
+    return _bundle.data + offset;
+}
+
+static void *ArrayAt(int offset, int count, size_t elementSize)
+{
+    if (count < 0 || (size_t)count > _bundle.dataSize/elementSize) return NULL;
+    return DataAt(offset, (size_t)count*elementSize);
+}
+
+// offset of the first byte after the array, which has been checked with ArrayAt
+static int OffsetAfter(const void *array, int count, size_t elementSize)
+{
+    return (int)((const unsigned char*)array - _bundle.data + (size_t)count*elementSize);
+}
+
+static int IsInBundle(const void *ptr)
+{
+    return _bundle.base && (const unsigned char*)ptr >= _bundle.base && (const unsigned char*)ptr < _bundle.base + _bundle.size;
+}
+
+// the texture's pixels in the mapping, no data if the entry is not a valid texture
+static Image GetBundleImage(int entryIndex)
+{
+    if (entryIndex < 0 || entryIndex >= _bundle.header->entryCount) return (Image){0};
+    const BundleEntry *entry = &_bundle.entries[entryIndex];
+    const BundleTexture *texture = DataAt(entry->offset, sizeof(BundleTexture));
+    if (entry->type != BUNDLE_ENTRY_TEXTURE || texture == NULL) return (Image){0};
+
+    // the writer stores a single level
+    int isValid = texture->width > 0 && texture->height > 0 && texture->width <= BUNDLE_MAX_TEXTURE_SIZE
+        && texture->height <= BUNDLE_MAX_TEXTURE_SIZE && texture->mipmaps == 1
+        && texture->format >= PIXELFORMAT_UNCOMPRESSED_GRAYSCALE && texture->format <= PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA;
+    int pixelSize = isValid ? GetPixelDataSize(texture->width, texture->height, texture->format) : 0;
+    void *pixels = isValid ? DataAt(texture->dataOffset, pixelSize) : NULL;
+    if (pixels == NULL)
+    {
+        TraceLog(LOG_ERROR, "Bundle: texture %s is corrupt", entry->name);
+        return (Image){0};
+    }
+
+    return (Image){
+        .data = pixels,
+        .width = texture->width,
+        .height = texture->height,
+        .mipmaps = texture->mipmaps,
+        .format = texture->format,
+    };
+}
+
+static Texture2D LoadBundleTexture(int entryIndex)
+{
+    // uploaded directly from the mapped pages
+    Image image = GetBundleImage(entryIndex);
+    if (image.data == NULL) return (Texture2D){0};
+    return LoadTextureFromImage(image);
+}
+
+// vertices, texcoords, texcoords2, normals, tangents, colors, indices
+static const size_t _meshArrayElementSizes[BUNDLE_MESH_ARRAYS] = {
+    3*sizeof(float), 2*sizeof(float), 2*sizeof(float), 3*sizeof(float), 4*sizeof(float), 4, 3*sizeof(unsigned short)
+};
+
+static int IsBundleMeshValid(const BundleMesh *mesh, int materialCount)
+{
+    if (mesh->vertexCount <= 0 || mesh->triangleCount < 0 || mesh->material < 0 || mesh->material >= materialCount) return 0;
+    if (mesh->arrays[0] == BUNDLE_NONE) return 0;
+    for (int i = 0; i < BUNDLE_MESH_ARRAYS; i++)
+    {
+        int count = i == 6 ? mesh->triangleCount : mesh->vertexCount;
+        if (mesh->arrays[i] != BUNDLE_NONE && ArrayAt(mesh->arrays[i], count, _meshArrayElementSizes[i]) == NULL) return 0;
+    }
+    // indices past the vertices would read outside the vertex arrays when drawn
+    if (mesh->arrays[6] != BUNDLE_NONE)
+    {
+        const unsigned short *indices = DataAt(mesh->arrays[6], 0);
+        for (int i = 0; i < mesh->triangleCount*3; i++)
+        {
+            if (indices[i] >= mesh->vertexCount) return 0;
+        }
+    }
+    else if (mesh->triangleCount > mesh->vertexCount/3) return 0;
+    return 1;
+}
+
+// the model's tables and meshes, or NULL if any of them does not fit the data section
+static const BundleModel *GetBundleModel(const BundleEntry *entry, const BundleMaterial **materials,
+    const BundleMesh **meshes)
+{
+    const BundleModel *model = DataAt(entry->offset, sizeof(BundleModel));
+    if (model == NULL) return NULL;
+    *materials = ArrayAt(entry->offset + (int)sizeof(BundleModel), model->materialCount, sizeof(BundleMaterial));
+    if (*materials == NULL) return NULL;
+    *meshes = ArrayAt(OffsetAfter(*materials, model->materialCount, sizeof(BundleMaterial)), model->meshCount,
+        sizeof(BundleMesh));
+    if (*meshes == NULL) return NULL;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        if (!IsBundleMeshValid(&(*meshes)[i], model->materialCount)) return NULL;
+    }
+    return model;
+}
+
+static Model LoadBundleModel(const char *name, int *ditherBaked, int upload)
+{
+    Model model = {0};
+    const BundleEntry *entry = FindEntry(name, BUNDLE_ENTRY_MODEL);
+    if (entry == NULL) return model;
+
+    const BundleMaterial *materials = NULL;
+    const BundleMesh *meshes = NULL;
+    const BundleModel *bundleModel = GetBundleModel(entry, &materials, &meshes);
+    if (bundleModel == NULL)
+    {
+        TraceLog(LOG_ERROR, "Bundle: model %s is corrupt", name);
+        return model;
+    }
+
+    model.transform = bundleModel->transform;
+    model.meshCount = bundleModel->meshCount;
+    model.materialCount = bundleModel->materialCount;
+    model.meshes = MemAlloc(model.meshCount*sizeof(Mesh));
+    model.meshMaterial = MemAlloc(model.meshCount*sizeof(int));
+    model.materials = MemAlloc(model.materialCount*sizeof(Material));
+
+    for (int i = 0; i < model.materialCount; i++)
+    {
+        model.materials[i] = LoadMaterialDefault();
+        model.materials[i].maps[MATERIAL_MAP_DIFFUSE].color = materials[i].diffuse;
+        if (upload && materials[i].texture != BUNDLE_NONE)
+        {
+            model.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture = LoadBundleTexture(materials[i].texture);
+        }
+    }
+
+    for (int i = 0; i < model.meshCount; i++)
+    {
+        const BundleMesh *bundleMesh = &meshes[i];
+        Mesh *mesh = &model.meshes[i];
+        mesh->vertexCount = bundleMesh->vertexCount;
+        mesh->triangleCount = bundleMesh->triangleCount;
+        // checked by GetBundleModel
+        mesh->vertices = DataAt(bundleMesh->arrays[0], 0);
+        mesh->texcoords = DataAt(bundleMesh->arrays[1], 0);
+        mesh->texcoords2 = DataAt(bundleMesh->arrays[2], 0);
+        mesh->normals = DataAt(bundleMesh->arrays[3], 0);
+        mesh->tangents = DataAt(bundleMesh->arrays[4], 0);
+        mesh->colors = DataAt(bundleMesh->arrays[5], 0);
+        mesh->indices = DataAt(bundleMesh->arrays[6], 0);
+        if (upload) UploadMesh(mesh, false);
+        model.meshMaterial[i] = bundleMesh->material;
+    }
+
+    if (ditherBaked) *ditherBaked = bundleModel->ditherBaked;
+    return model;
+}
+
+Model Bundle_loadModel(const char *name, int *ditherBaked)
+{
+    return LoadBundleModel(name, ditherBaked, 1);
+}
+
+Model Bundle_loadModelCpu(const char *name, int *ditherBaked)
+{
+    return LoadBundleModel(name, ditherBaked, 0);
+}
+
+Image Bundle_loadMaterialImage(const char *name, int material)
+{
+    const BundleEntry *entry = FindEntry(name, BUNDLE_ENTRY_MODEL);
+    if (entry == NULL) return (Image){0};
+
+    const BundleMaterial *materials = NULL;
+    const BundleMesh *meshes = NULL;
+    const BundleModel *bundleModel = GetBundleModel(entry, &materials, &meshes);
+    if (bundleModel == NULL || material < 0 || material >= bundleModel->materialCount) return (Image){0};
+    if (materials[material].texture == BUNDLE_NONE) return (Image){0};
+
+    Image pixels = GetBundleImage(materials[material].texture);
+    if (pixels.data == NULL) return (Image){0};
+    Image image = ImageCopy(pixels);
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    if (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+    {
+        // compressed formats are not decoded on the CPU
+        TraceLog(LOG_WARNING, "Bundle: texture of %s material %d cannot be read on the CPU", name, material);
+        UnloadImage(image);
+        return (Image){0};
+    }
+    return image;
+}
+
+void Bundle_unloadModel(Model model)
+{
+    // the vertex arrays of bundle models belong to the mapping
+    for (int i = 0; i < model.meshCount; i++)
+    {
+        Mesh *mesh = &model.meshes[i];
+        if (IsInBundle(mesh->vertices)) mesh->vertices = NULL;
+        if (IsInBundle(mesh->texcoords)) mesh->texcoords = NULL;
+        if (IsInBundle(mesh->texcoords2)) mesh->texcoords2 = NULL;
+        if (IsInBundle(mesh->normals)) mesh->normals = NULL;
+        if (IsInBundle(mesh->tangents)) mesh->tangents = NULL;
+        if (IsInBundle(mesh->colors)) mesh->colors = NULL;
+        if (IsInBundle(mesh->indices)) mesh->indices = NULL;
+    }
+    UnloadModel(model);
+}
+
+Font Bundle_loadFont(const char *name)
+{
+    Font font = {0};
+    const BundleEntry *entry = FindEntry(name, BUNDLE_ENTRY_FONT);
+    if (entry == NULL) return font;
+
+    const BundleFont *bundleFont = DataAt(entry->offset, sizeof(BundleFont));
+    const Rectangle *recs = bundleFont ? ArrayAt(bundleFont->recsOffset, bundleFont->glyphCount, sizeof(Rectangle)) : NULL;
+    const BundleGlyph *glyphs = bundleFont ? ArrayAt(bundleFont->glyphsOffset, bundleFont->glyphCount, sizeof(BundleGlyph)) : NULL;
+    if (recs == NULL || glyphs == NULL)
+    {
+        TraceLog(LOG_ERROR, "Bundle: font %s is corrupt", name);
+        return font;
+    }
+    font.baseSize = bundleFont->baseSize;
+    font.glyphCount = bundleFont->glyphCount;
+    font.glyphPadding = bundleFont->glyphPadding;
+    font.texture = LoadBundleTexture(bundleFont->texture);
+    // UnloadFont frees these, so they are the only part that is copied
+    font.recs = MemAlloc(font.glyphCount*sizeof(Rectangle));
+    font.glyphs = MemAlloc(font.glyphCount*sizeof(GlyphInfo));
+    memcpy(font.recs, recs, font.glyphCount*sizeof(Rectangle));
+    for (int i = 0; i < font.glyphCount; i++)
+    {
+        font.glyphs[i] = (GlyphInfo){
+            .value = glyphs[i].value,
+            .offsetX = glyphs[i].offsetX,
+            .offsetY = glyphs[i].offsetY,
+            .advanceX = glyphs[i].advanceX,
+        };
+    }
+    return font;
+}
+
+unsigned char *Bundle_getData(const char *name, int *size)
+{
+    const BundleEntry *entry = FindEntry(name, BUNDLE_ENTRY_DATA);
+    if (entry == NULL) return NULL;
+    if (size) *size = entry->size;
+    // the entry table is checked by Bundle_open
+    return DataAt(entry->offset, entry->size);
+}
+
+const char *Bundle_getText(const char *name)
+{
+    int size = 0;
+    const char *text = (const char*)Bundle_getData(name, &size);
+    if (text == NULL || size == 0 || text[size - 1] != '\0') return NULL;
+    return text;
+}
+
+// packing
+
+struct BundleWriter {
+    BundleEntry *entries;
+    int entryCount;
+    int entryCapacity;
+    unsigned char *data;
+    int dataSize;
+    int dataCapacity;
+    unsigned int textureIds[BUNDLE_MAX_TEXTURES];
+    int textureEntries[BUNDLE_MAX_TEXTURES];
+    int textureCount;
+};
+
+BundleWriter *BundleWriter_create()
+{
+    return MemAlloc(sizeof(BundleWriter));
+}
+
+void BundleWriter_free(BundleWriter *writer)
+{
+    MemFree(writer->entries);
+    MemFree(writer->data);
+    MemFree(writer);
+}
+
+// appends data at the next aligned offset and returns that offset
+static int AppendAligned(BundleWriter *writer, const void *data, int size)
+{
+    int offset = (writer->dataSize + BUNDLE_ALIGNMENT - 1) & ~(BUNDLE_ALIGNMENT - 1);
+    if (offset + size > writer->dataCapacity)
+    {
+        int capacity = writer->dataCapacity ? writer->dataCapacity : 64*1024;
+        while (capacity < offset + size) capacity *= 2;
+        writer->data = MemRealloc(writer->data, capacity);
+        memset(writer->data + writer->dataCapacity, 0, capacity - writer->dataCapacity);
+        writer->dataCapacity = capacity;
+    }
+    if (data) memcpy(writer->data + offset, data, size);
+    writer->dataSize = offset + size;
+    return offset;
+}
+
+static int AddEntry(BundleWriter *writer, const char *name, int type, int offset, int size)
+{
+    if ((int)strlen(name) >= BUNDLE_NAME_LENGTH)
+    {
+        TraceLog(LOG_WARNING, "BundleWriter: name '%s' is too long and gets truncated", name);
+    }
+    if (writer->entryCount == writer->entryCapacity)
+    {
+        writer->entryCapacity = writer->entryCapacity ? writer->entryCapacity*2 : 32;
+        writer->entries = MemRealloc(writer->entries, writer->entryCapacity*sizeof(BundleEntry));
+    }
+    BundleEntry *entry = &writer->entries[writer->entryCount];
+    *entry = (BundleEntry){ .type = type, .offset = offset, .size = size };
+    strncpy(entry->name, name, BUNDLE_NAME_LENGTH - 1);
+    return writer->entryCount++;
+}
+
+static int AddTexture(BundleWriter *writer, const char *name, Texture2D texture)
+{
+    if (texture.id == 0 || texture.id == rlGetTextureIdDefault()) return BUNDLE_NONE;
+    for (int i = 0; i < writer->textureCount; i++)
+    {
+        if (writer->textureIds[i] == texture.id) return writer->textureEntries[i];
+    }
+    if (writer->textureCount == BUNDLE_MAX_TEXTURES)
+    {
+        TraceLog(LOG_WARNING, "BundleWriter: too many textures");
+        return BUNDLE_NONE;
+    }
+
+    Image image = LoadImageFromTexture(texture);
+    BundleTexture bundleTexture = {
+        .width = image.width,
+        .height = image.height,
+        .format = image.format,
+        .mipmaps = 1,
+        .dataOffset = AppendAligned(writer, image.data, GetPixelDataSize(image.width, image.height, image.format)),
+    };
+    UnloadImage(image);
+
+    const char *entryName = TextFormat("%s#%d", name, writer->textureCount);
+    int entry = AddEntry(writer, entryName, BUNDLE_ENTRY_TEXTURE,
+        AppendAligned(writer, &bundleTexture, sizeof(bundleTexture)), sizeof(bundleTexture));
+    writer->textureIds[writer->textureCount] = texture.id;
+    writer->textureEntries[writer->textureCount++] = entry;
+    return entry;
+}
+
+static int AppendArray(BundleWriter *writer, const void *data, int size)
+{
+    return data ? AppendAligned(writer, data, size) : BUNDLE_NONE;
+}
+
+void BundleWriter_addModel(BundleWriter *writer, const char *name, Model model, int ditherBaked)
+{
+    int size = sizeof(BundleModel) + model.materialCount*sizeof(BundleMaterial) + model.meshCount*sizeof(BundleMesh);
+    BundleModel *bundleModel = MemAlloc(size);
+    BundleMaterial *materials = (BundleMaterial*)(bundleModel + 1);
+    BundleMesh *meshes = (BundleMesh*)(materials + model.materialCount);
+    *bundleModel = (BundleModel){
+        .transform = model.transform,
+        .meshCount = model.meshCount,
+        .materialCount = model.materialCount,
+        .ditherBaked = ditherBaked,
+    };
+
+    for (int i = 0; i < model.materialCount; i++)
+    {
+        MaterialMap *map = &model.materials[i].maps[MATERIAL_MAP_DIFFUSE];
+        materials[i] = (BundleMaterial){ .diffuse = map->color, .texture = AddTexture(writer, name, map->texture) };
+    }
+
+    for (int i = 0; i < model.meshCount; i++)
+    {
+        Mesh *mesh = &model.meshes[i];
+        int vertexCount = mesh->vertexCount;
+        meshes[i] = (BundleMesh){
+            .vertexCount = vertexCount,
+            .triangleCount = mesh->triangleCount,
+            .material = model.meshMaterial[i],
+            .arrays = {
+                AppendArray(writer, mesh->vertices, vertexCount*3*sizeof(float)),
+                AppendArray(writer, mesh->texcoords, vertexCount*2*sizeof(float)),
+                AppendArray(writer, mesh->texcoords2, vertexCount*2*sizeof(float)),
+                AppendArray(writer, mesh->normals, vertexCount*3*sizeof(float)),
+                AppendArray(writer, mesh->tangents, vertexCount*4*sizeof(float)),
+                AppendArray(writer, mesh->colors, vertexCount*4*sizeof(unsigned char)),
+                AppendArray(writer, mesh->indices, mesh->triangleCount*3*sizeof(unsigned short)),
+            },
+        };
+    }
+
+    AddEntry(writer, name, BUNDLE_ENTRY_MODEL, AppendAligned(writer, bundleModel, size), size);
+    MemFree(bundleModel);
+}
+
+void BundleWriter_addFont(BundleWriter *writer, const char *name, Font font)
+{
+    BundleGlyph *glyphs = MemAlloc(font.glyphCount*sizeof(BundleGlyph));
+    for (int i = 0; i < font.glyphCount; i++)
+    {
+        glyphs[i] = (BundleGlyph){
+            .value = font.glyphs[i].value,
+            .offsetX = font.glyphs[i].offsetX,
+            .offsetY = font.glyphs[i].offsetY,
+            .advanceX = font.glyphs[i].advanceX,
+        };
+    }
+    BundleFont bundleFont = {
+        .baseSize = font.baseSize,
+        .glyphCount = font.glyphCount,
+        .glyphPadding = font.glyphPadding,
+        .texture = AddTexture(writer, name, font.texture),
+        .recsOffset = AppendAligned(writer, font.recs, font.glyphCount*sizeof(Rectangle)),
+        .glyphsOffset = AppendAligned(writer, glyphs, font.glyphCount*sizeof(BundleGlyph)),
+    };
+    MemFree(glyphs);
+    AddEntry(writer, name, BUNDLE_ENTRY_FONT, AppendAligned(writer, &bundleFont, sizeof(bundleFont)), sizeof(bundleFont));
+}
+
+void BundleWriter_addData(BundleWriter *writer, const char *name, const void *data, int size)
+{
+    AddEntry(writer, name, BUNDLE_ENTRY_DATA, AppendAligned(writer, data, size), size);
+}
+
+int BundleWriter_save(BundleWriter *writer, const char *fileName)
+{
+    int tableSize = sizeof(BundleHeader) + writer->entryCount*sizeof(BundleEntry);
+    int dataOffset = (tableSize + BUNDLE_ALIGNMENT - 1) & ~(BUNDLE_ALIGNMENT - 1);
+    int size = dataOffset + writer->dataSize;
+    unsigned char *file = MemAlloc(size);
+    BundleHeader header = {
+        .magic = BUNDLE_MAGIC,
+        .version = BUNDLE_VERSION,
+        .entryCount = writer->entryCount,
+        .dataOffset = dataOffset,
+    };
+    memcpy(file, &header, sizeof(header));
+    memcpy(file + sizeof(header), writer->entries, writer->entryCount*sizeof(BundleEntry));
+    memcpy(file + dataOffset, writer->data, writer->dataSize);
+    int success = SaveFileData(fileName, file, size);
+    MemFree(file);
+    TraceLog(success ? LOG_INFO : LOG_ERROR, "BundleWriter: %s %s, %d entries, %d KB", success ? "saved" : "failed to save",
+        fileName, writer->entryCount, size / 1024);
+    return success;
+}
@@ -0,0 +1,47 @@
+#ifndef __GAME_BUNDLE_H__
+#define __GAME_BUNDLE_H__
+
+#include "raylib.h"
+
+// Resource bundle: models, fonts, shader sources and the compiled script baked into
+// one file by tools/bundlepack.c ("make bundle"). Vertex arrays and texture pixels
+// are stored ready for upload at BUNDLE_ALIGNMENT, so at runtime the file is mapped
+// and the GPU uploads read straight from the mapped pages. Entries are looked up by
+// the resource path they were packed from, e.g. "resources/polyobjects.glb".
+//
+// Models loaded from a bundle keep pointing into the mapping: their vertex data is
+// read only and they must be released with Bundle_unloadModel before Bundle_close.
+
+#define BUNDLE_FILE "resources/game.bundle"
+#define BUNDLE_ALIGNMENT 64
+
+int Bundle_open(const char *fileName);
+void Bundle_close();
+int Bundle_isOpen();
+int Bundle_contains(const char *name);
+
+// dither blocks are baked into texcoords2 at pack time, see ModelImport_process
+Model Bundle_loadModel(const char *name, int *ditherBaked);
+// same without touching GL: no uploaded meshes and default textures, for the soft rasterizer
+Model Bundle_loadModelCpu(const char *name, int *ditherBaked);
+// R8G8B8A8 copy of a material's texture, no data for raylib's default texture; free with UnloadImage
+Image Bundle_loadMaterialImage(const char *name, int material);
+// also works for models that were not loaded from the bundle
+void Bundle_unloadModel(Model model);
+Font Bundle_loadFont(const char *name);
+// zero terminated text, valid until Bundle_close
+const char *Bundle_getText(const char *name);
+// raw entry data, valid until Bundle_close
+unsigned char *Bundle_getData(const char *name, int *size);
+
+// packing, used by tools/bundlepack.c
+typedef struct BundleWriter BundleWriter;
+
+BundleWriter *BundleWriter_create();
+void BundleWriter_addModel(BundleWriter *writer, const char *name, Model model, int ditherBaked);
+void BundleWriter_addFont(BundleWriter *writer, const char *name, Font font);
+void BundleWriter_addData(BundleWriter *writer, const char *name, const void *data, int size);
+int BundleWriter_save(BundleWriter *writer, const char *fileName);
+void BundleWriter_free(BundleWriter *writer);
+
+#endif
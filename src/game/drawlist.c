@@ -0,0 +1,279 @@
+#include "drawlist.h"
+#include "alloctrack.h"
+#include <raymath.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+// same clip planes as rlgl uses in BeginMode3D
+#define DRAWLIST_NEAR 0.01
+#define DRAWLIST_FAR 1000.0
+
+typedef struct DrawList {
+    Frustum frustum;
+    Vector3 cameraPosition;
+    DrawListItem *items;
+    int count;
+    int capacity;
+    DrawListStats stats;
+} DrawList;
+
+static DrawList _drawList;
+
+typedef struct DrawListViewModel {
+    Model *model;
+    // meshCount items per view, the first counts[view] of them queued
+    DrawListItem *items;
+    int counts[DRAWLIST_MAX_VIEWS];
+    int capacity;
+} DrawListViewModel;
+
+typedef struct DrawListViews {
+    Frustum frustums[DRAWLIST_MAX_VIEWS];
+    Vector3 cameraPositions[DRAWLIST_MAX_VIEWS];
+    int count;
+    DrawListViewModel models[DRAWLIST_VIEW_MODELS];
+    int modelCount;
+    // slot that is replaced next once all are taken
+    int nextModel;
+} DrawListViews;
+
+static DrawListViews _views;
+
+static Vector4 NormalizePlane(float x, float y, float z, float w)
+{
+    float length = sqrtf(x*x + y*y + z*z);
+    return (Vector4){ x / length, y / length, z / length, w / length };
+}
+
+Matrix Frustum_getProjection(Camera3D camera, float aspect)
+{
+    if (camera.projection == CAMERA_ORTHOGRAPHIC)
+    {
+        double top = camera.fovy / 2.0;
+        double right = top * aspect;
+        return MatrixOrtho(-right, right, -top, top, DRAWLIST_NEAR, DRAWLIST_FAR);
+    }
+    return MatrixPerspective(camera.fovy * DEG2RAD, aspect, DRAWLIST_NEAR, DRAWLIST_FAR);
+}
+
+Frustum Frustum_fromCamera(Camera3D camera, float aspect)
+{
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    return Frustum_fromMatrix(MatrixMultiply(view, Frustum_getProjection(camera, aspect)));
+}
+
+Frustum Frustum_fromMatrix(Matrix m)
+{
+    // rows of the view projection matrix combined as in Gribb & Hartmann
+    Frustum frustum;
+    frustum.planes[0] = NormalizePlane(m.m3 + m.m0, m.m7 + m.m4, m.m11 + m.m8, m.m15 + m.m12);   // left
+    frustum.planes[1] = NormalizePlane(m.m3 - m.m0, m.m7 - m.m4, m.m11 - m.m8, m.m15 - m.m12);   // right
+    frustum.planes[2] = NormalizePlane(m.m3 + m.m1, m.m7 + m.m5, m.m11 + m.m9, m.m15 + m.m13);   // bottom
+    frustum.planes[3] = NormalizePlane(m.m3 - m.m1, m.m7 - m.m5, m.m11 - m.m9, m.m15 - m.m13);   // top
+    frustum.planes[4] = NormalizePlane(m.m3 + m.m2, m.m7 + m.m6, m.m11 + m.m10, m.m15 + m.m14);  // near
+    frustum.planes[5] = NormalizePlane(m.m3 - m.m2, m.m7 - m.m6, m.m11 - m.m10, m.m15 - m.m14);  // far
+    return frustum;
+}
+
+int Frustum_containsBox(const Frustum *frustum, BoundingBox box)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        Vector4 p = frustum->planes[i];
+        // corner furthest along the plane normal
+        float x = p.x >= 0.0f ? box.max.x : box.min.x;
+        float y = p.y >= 0.0f ? box.max.y : box.min.y;
+        float z = p.z >= 0.0f ? box.max.z : box.min.z;
+        if (p.x*x + p.y*y + p.z*z + p.w < 0.0f) return 0;
+    }
+    return 1;
+}
+
+BoundingBox BoundingBox_transform(BoundingBox box, Matrix transform)
+{
+    Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 extents = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+    Vector3 newCenter = Vector3Transform(center, transform);
+    Vector3 newExtents = {
+        fabsf(transform.m0)*extents.x + fabsf(transform.m4)*extents.y + fabsf(transform.m8)*extents.z,
+        fabsf(transform.m1)*extents.x + fabsf(transform.m5)*extents.y + fabsf(transform.m9)*extents.z,
+        fabsf(transform.m2)*extents.x + fabsf(transform.m6)*extents.y + fabsf(transform.m10)*extents.z,
+    };
+    return (BoundingBox){ Vector3Subtract(newCenter, newExtents), Vector3Add(newCenter, newExtents) };
+}
+
+void DrawList_begin(Camera3D camera, float aspect)
+{
+    _drawList.frustum = Frustum_fromCamera(camera, aspect);
+    _drawList.cameraPosition = camera.position;
+    _drawList.count = 0;
+}
+
+void DrawList_addModel(Model *model, const BoundingBox *meshBounds)
+{
+    DrawList *list = &_drawList;
+    if (list->count + model->meshCount > list->capacity)
+    {
+        list->capacity = list->count + model->meshCount + 64;
+        list->items = MemRealloc(list->items, list->capacity * sizeof(DrawListItem));
+    }
+
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        float distance = 0.0f;
+        if (meshBounds)
+        {
+            BoundingBox bounds = BoundingBox_transform(meshBounds[i], model->transform);
+            if (!Frustum_containsBox(&list->frustum, bounds))
+            {
+                list->stats.meshesCulled++;
+                continue;
+            }
+            Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+            distance = Vector3DistanceSqr(center, list->cameraPosition);
+        }
+        list->items[list->count++] = (DrawListItem){ .model = model, .meshIndex = i, .distance = distance };
+        list->stats.meshesSubmitted++;
+    }
+}
+
+static int CompareDrawListItems(const void *a, const void *b)
+{
+    const DrawListItem *itemA = a;
+    const DrawListItem *itemB = b;
+    if (itemA->distance != itemB->distance) return itemA->distance < itemB->distance ? -1 : 1;
+    // keep the order deterministic for meshes at the same distance
+    if (itemA->model != itemB->model) return itemA->model < itemB->model ? -1 : 1;
+    return itemA->meshIndex - itemB->meshIndex;
+}
+
+void DrawList_end()
+{
+    if (_drawList.count < 2) return;
+    qsort(_drawList.items, _drawList.count, sizeof(DrawListItem), CompareDrawListItems);
+}
+
+void DrawList_beginViews(const Camera3D *cameras, const float *aspects, int viewCount)
+{
+    if (viewCount > DRAWLIST_MAX_VIEWS) viewCount = DRAWLIST_MAX_VIEWS;
+    for (int i = 0; i < viewCount; i++)
+    {
+        _views.frustums[i] = Frustum_fromCamera(cameras[i], aspects[i]);
+        _views.cameraPositions[i] = cameras[i].position;
+    }
+    _views.count = viewCount;
+    _views.modelCount = 0;
+    _views.nextModel = 0;
+}
+
+static DrawListViewModel *CullModelForViews(Model *model, const BoundingBox *meshBounds)
+{
+    DrawListViews *views = &_views;
+    int slot = views->modelCount < DRAWLIST_VIEW_MODELS ? views->modelCount++ : views->nextModel++ % DRAWLIST_VIEW_MODELS;
+    DrawListViewModel *entry = &views->models[slot];
+    entry->model = model;
+    if (model->meshCount*views->count > entry->capacity)
+    {
+        entry->capacity = model->meshCount*views->count;
+        entry->items = MemRealloc(entry->items, entry->capacity * sizeof(DrawListItem));
+    }
+
+    for (int v = 0; v < views->count; v++) entry->counts[v] = 0;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        BoundingBox bounds = { 0 };
+        Vector3 center = { 0 };
+        if (meshBounds)
+        {
+            bounds = BoundingBox_transform(meshBounds[i], model->transform);
+            center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+            _drawList.stats.viewBoundsTransformed++;
+        }
+        for (int v = 0; v < views->count; v++)
+        {
+            if (meshBounds && !Frustum_containsBox(&views->frustums[v], bounds)) continue;
+            float distance = meshBounds ? Vector3DistanceSqr(center, views->cameraPositions[v]) : 0.0f;
+            entry->items[v*model->meshCount + entry->counts[v]++] = (DrawListItem){
+                .model = model, .meshIndex = i, .distance = distance };
+        }
+    }
+    for (int v = 0; v < views->count; v++)
+    {
+        if (entry->counts[v] < 2) continue;
+        qsort(&entry->items[v*model->meshCount], entry->counts[v], sizeof(DrawListItem), CompareDrawListItems);
+    }
+    return entry;
+}
+
+void DrawList_addModelForView(int view, Model *model, const BoundingBox *meshBounds)
+{
+    DrawList *list = &_drawList;
+    list->count = 0;
+    if (view < 0 || view >= _views.count) return;
+    DrawListViewModel *entry = NULL;
+    for (int i = 0; i < _views.modelCount; i++)
+    {
+        if (_views.models[i].model == model) entry = &_views.models[i];
+    }
+    if (entry == NULL) entry = CullModelForViews(model, meshBounds);
+
+    int count = entry->counts[view];
+    if (count > list->capacity)
+    {
+        list->capacity = count + 64;
+        list->items = MemRealloc(list->items, list->capacity * sizeof(DrawListItem));
+    }
+    memcpy(list->items, &entry->items[view*model->meshCount], count * sizeof(DrawListItem));
+    list->count = count;
+    list->stats.meshesSubmitted += count;
+    list->stats.meshesCulled += model->meshCount - count;
+}
+
+void DrawList_endViews()
+{
+    // the models may change before the next views
+    _views.count = 0;
+    _views.modelCount = 0;
+}
+
+int DrawList_getCount()
+{
+    return _drawList.count;
+}
+
+const DrawListItem *DrawList_getItems()
+{
+    return _drawList.items;
+}
+
+DrawListStats DrawList_getStats()
+{
+    return _drawList.stats;
+}
+
+void DrawList_resetStats()
+{
+    _drawList.stats = (DrawListStats){0};
+}
+
+void DrawList_countDrawCall(int instances)
+{
+    _drawList.stats.drawCalls++;
+    if (instances > 1) _drawList.stats.instancesDrawn += instances;
+}
+
+void DrawList_countTriangles(int drawn, int full)
+{
+    _drawList.stats.trianglesDrawn += drawn;
+    _drawList.stats.trianglesSaved += full - drawn;
+}
+
+void DrawList_unload()
+{
+    MemFree(_drawList.items);
+    _drawList = (DrawList){0};
+    for (int i = 0; i < DRAWLIST_VIEW_MODELS; i++) MemFree(_views.models[i].items);
+    _views = (DrawListViews){0};
+}
@@ -0,0 +1,75 @@
+#ifndef __GAME_DRAWLIST_H__
+#define __GAME_DRAWLIST_H__
+
+#include "raylib.h"
+
+// Per-mesh visibility and ordering for the scene pass. Meshes outside of the camera
+// frustum are dropped, the rest are sorted front to back so the depth test rejects
+// hidden fragments before the (discarding) dither shader runs.
+//
+// Several views of one frame (see Viewport in main.h) are culled together: between
+// DrawList_beginViews and DrawList_endViews, the first DrawList_addModelForView of a
+// model transforms the bounds of its meshes once, tests them against the frustums of
+// all views and sorts the result of each; later views of the same model only copy
+// their queue.
+
+#define DRAWLIST_MAX_VIEWS 8
+// models culled for all views that are kept until DrawList_endViews
+#define DRAWLIST_VIEW_MODELS 4
+
+typedef struct Frustum {
+    Vector4 planes[6];      // xyz = normal pointing inside, w = distance
+} Frustum;
+
+typedef struct DrawListItem {
+    Model *model;
+    int meshIndex;
+    float distance;         // squared distance from the camera to the bounds center
+} DrawListItem;
+
+typedef struct DrawListStats {
+    int meshesSubmitted;
+    int meshesCulled;
+    int drawCalls;
+    // meshes drawn as part of an instanced draw call
+    int instancesDrawn;
+    int trianglesDrawn;
+    // triangles left out by drawing coarser levels of detail
+    int trianglesSaved;
+    // mesh bounds transformed for the views of DrawList_beginViews, once for all of them
+    int viewBoundsTransformed;
+} DrawListStats;
+
+// same projection as BeginMode3D for a framebuffer with the given aspect ratio
+Matrix Frustum_getProjection(Camera3D camera, float aspect);
+Frustum Frustum_fromCamera(Camera3D camera, float aspect);
+// planes of a view * projection matrix, e.g. one narrowed to a few pixels
+Frustum Frustum_fromMatrix(Matrix viewProjection);
+int Frustum_containsBox(const Frustum *frustum, BoundingBox box);
+// axis aligned bounds of the transformed box
+BoundingBox BoundingBox_transform(BoundingBox box, Matrix transform);
+
+void DrawList_begin(Camera3D camera, float aspect);
+// culls the model's meshes against the frustum and queues the visible ones;
+// meshBounds may be NULL, in which case nothing is culled
+void DrawList_addModel(Model *model, const BoundingBox *meshBounds);
+// sorts the queued meshes front to back
+void DrawList_end();
+int DrawList_getCount();
+const DrawListItem *DrawList_getItems();
+
+void DrawList_beginViews(const Camera3D *cameras, const float *aspects, int viewCount);
+// replaces DrawList_begin, DrawList_addModel and DrawList_end for one of the views
+void DrawList_addModelForView(int view, Model *model, const BoundingBox *meshBounds);
+void DrawList_endViews();
+
+// counters accumulated since the last reset, reset once per frame
+DrawListStats DrawList_getStats();
+void DrawList_resetStats();
+// counts draw calls issued for the queued meshes; instances: meshes drawn by the call
+void DrawList_countDrawCall(int instances);
+// counts the triangles of a drawn mesh and of its full level of detail
+void DrawList_countTriangles(int drawn, int full);
+void DrawList_unload();
+
+#endif
@@ -0,0 +1,276 @@
+#include "export.h"
+#include "readback.h"
+#include "jobs.h"
+#include "alloctrack.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// PNG frames are encoded on the worker pool, which cannot go through raylib's ExportImage: it checks
+// the extension with TextToLower/TextSplit, whose buffers are static, and allocates with RL_MALLOC.
+// A private copy of stb_image_write encodes to memory with the C allocator instead.
+#define STB_IMAGE_WRITE_STATIC
+#define STBI_WRITE_NO_STDIO
+#define STBIW_MALLOC(size) malloc(size)
+#define STBIW_REALLOC(block, size) realloc(block, size)
+#define STBIW_FREE(block) free(block)
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#include <external/stb_image_write.h>
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+typedef enum ExportFormat {
+    EXPORT_FORMAT_PNG,
+    EXPORT_FORMAT_Y4M,
+} ExportFormat;
+
+typedef struct ExportFrame {
+    // RGBA8, top row first
+    unsigned char *pixels;
+    // Y, U and V planes of a Y4M frame
+    unsigned char *yuv;
+    // encoded PNG file, written and freed on the main thread
+    unsigned char *png;
+    int pngSize;
+    int index;
+    int failed;
+} ExportFrame;
+
+typedef struct Export {
+    int isActive;
+    ExportFormat format;
+    char path[512];
+    int fps;
+    FILE *file;
+    // size of the first frame, 0 until it arrived
+    int width, height;
+    ExportFrame frames[EXPORT_BATCH_FRAMES];
+    int batchCount;
+    int requested;
+    int written;
+    int failed;
+    double startTime;
+    double encodeSeconds;
+} Export;
+
+static Export _export;
+
+static int GetYuvSize(int width, int height)
+{
+    return width*height + 2*((width + 1)/2)*((height + 1)/2);
+}
+
+// BT.601 limited range; chroma is the average of each 2x2 block
+static void ConvertToYuv(const unsigned char *rgba, int width, int height, unsigned char *yuv)
+{
+    int chromaWidth = (width + 1)/2;
+    int chromaHeight = (height + 1)/2;
+    unsigned char *planeY = yuv;
+    unsigned char *planeU = yuv + width*height;
+    unsigned char *planeV = planeU + chromaWidth*chromaHeight;
+    for (int i = 0; i < width*height; i++)
+    {
+        const unsigned char *p = rgba + i*4;
+        planeY[i] = (unsigned char)(((66*p[0] + 129*p[1] + 25*p[2] + 128) >> 8) + 16);
+    }
+    for (int cy = 0; cy < chromaHeight; cy++)
+    {
+        for (int cx = 0; cx < chromaWidth; cx++)
+        {
+            int r = 0, g = 0, b = 0, count = 0;
+            for (int y = cy*2; y < cy*2 + 2 && y < height; y++)
+            {
+                for (int x = cx*2; x < cx*2 + 2 && x < width; x++)
+                {
+                    const unsigned char *p = rgba + (y*width + x)*4;
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    count++;
+                }
+            }
+            r = (r + count/2)/count;
+            g = (g + count/2)/count;
+            b = (b + count/2)/count;
+            planeU[cy*chromaWidth + cx] = (unsigned char)(((-38*r - 74*g + 112*b + 128) >> 8) + 128);
+            planeV[cy*chromaWidth + cx] = (unsigned char)(((112*r - 94*g - 18*b + 128) >> 8) + 128);
+        }
+    }
+}
+
+// runs on the worker pool; must not call into raylib, only encode into the frame's own buffers
+static void EncodeFrame(int i, void *userData)
+{
+    (void)userData;
+    ExportFrame *frame = &_export.frames[i];
+    if (_export.format == EXPORT_FORMAT_Y4M)
+    {
+        ConvertToYuv(frame->pixels, _export.width, _export.height, frame->yuv);
+        return;
+    }
+    frame->png = stbi_write_png_to_mem(frame->pixels, _export.width*4, _export.width, _export.height, 4,
+        &frame->pngSize);
+}
+
+static int WritePng(const ExportFrame *frame)
+{
+    if (frame->png == NULL) return 0;
+    char fileName[sizeof(_export.path) + 32];
+    snprintf(fileName, sizeof(fileName), "%s/frame%05d.png", _export.path, frame->index);
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) return 0;
+    int isWritten = fwrite(frame->png, 1, frame->pngSize, file) == (size_t)frame->pngSize;
+    if (fclose(file) != 0) isWritten = 0;
+    return isWritten;
+}
+
+static void EncodeBatch()
+{
+    if (_export.batchCount == 0) return;
+    double start = GetTime();
+    Jobs_parallelFor(_export.batchCount, EncodeFrame, NULL);
+    int yuvSize = GetYuvSize(_export.width, _export.height);
+    for (int i = 0; i < _export.batchCount; i++)
+    {
+        ExportFrame *frame = &_export.frames[i];
+        if (_export.format == EXPORT_FORMAT_Y4M)
+        {
+            // the stream is written in frame order, only the conversion runs in parallel
+            fputs("FRAME\n", _export.file);
+            frame->failed = fwrite(frame->yuv, 1, yuvSize, _export.file) != (size_t)yuvSize;
+        }
+        else
+        {
+            // files are named and written here, in frame order, only the encoding runs in parallel
+            frame->failed = !WritePng(frame);
+            free(frame->png);
+            frame->png = NULL;
+        }
+        if (frame->failed) _export.failed++;
+        else _export.written++;
+    }
+    _export.batchCount = 0;
+    _export.encodeSeconds += GetTime() - start;
+}
+
+static void StartOutput(int width, int height)
+{
+    _export.width = width;
+    _export.height = height;
+    for (int i = 0; i < EXPORT_BATCH_FRAMES; i++)
+    {
+        _export.frames[i].pixels = MemAlloc(width*height*4);
+        if (_export.format == EXPORT_FORMAT_Y4M) _export.frames[i].yuv = MemAlloc(GetYuvSize(width, height));
+    }
+    if (_export.format == EXPORT_FORMAT_Y4M)
+    {
+        fprintf(_export.file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, _export.fps);
+    }
+}
+
+static void ReceiveFrame(Image image, void *userData)
+{
+    if (_export.width == 0) StartOutput(image.width, image.height);
+    if (image.width != _export.width || image.height != _export.height)
+    {
+        TraceLog(LOG_WARNING, "Export: frame %d is %dx%d instead of %dx%d, skipped", (int)(intptr_t)userData,
+            image.width, image.height, _export.width, _export.height);
+        _export.failed++;
+        return;
+    }
+    ExportFrame *frame = &_export.frames[_export.batchCount++];
+    memcpy(frame->pixels, image.data, image.width*image.height*4);
+    frame->index = (int)(intptr_t)userData;
+    frame->failed = 0;
+    if (_export.batchCount == EXPORT_BATCH_FRAMES) EncodeBatch();
+}
+
+int Export_begin(const char *path, int fps)
+{
+    if (_export.isActive) return 0;
+    _export = (Export){ .fps = fps > 0 ? fps : 30 };
+    _export.format = IsFileExtension(path, ".y4m") ? EXPORT_FORMAT_Y4M : EXPORT_FORMAT_PNG;
+    snprintf(_export.path, sizeof(_export.path), "%s", path);
+    if (_export.format == EXPORT_FORMAT_Y4M)
+    {
+        _export.file = fopen(path, "wb");
+        if (_export.file == NULL)
+        {
+            TraceLog(LOG_ERROR, "Export: could not create %s", path);
+            return 0;
+        }
+    }
+    else if (!DirectoryExists(path))
+    {
+        TraceLog(LOG_ERROR, "Export: directory %s does not exist", path);
+        return 0;
+    }
+    _export.isActive = 1;
+    _export.startTime = GetTime();
+    TraceLog(LOG_INFO, "Export: writing %s at %d fps", path, _export.fps);
+    return 1;
+}
+
+void Export_captureScreen()
+{
+    if (!_export.isActive) return;
+    void *index = (void*)(intptr_t)_export.requested++;
+    int dropped = Readback_getStats().dropped;
+    // a dropped request would be a missing frame, so wait for the oldest read instead
+    while (!Readback_requestScreen((Rectangle){0}, ReceiveFrame, index) && Readback_getStats().dropped > dropped)
+    {
+        dropped = Readback_getStats().dropped;
+        Readback_update();
+    }
+}
+
+void Export_addFrame(Image image)
+{
+    if (!_export.isActive) return;
+    void *index = (void*)(intptr_t)_export.requested++;
+    if (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+    {
+        TraceLog(LOG_WARNING, "Export: frame %d is not R8G8B8A8, skipped", (int)(intptr_t)index);
+        _export.failed++;
+        return;
+    }
+    ReceiveFrame(image, index);
+}
+
+void Export_end()
+{
+    if (!_export.isActive) return;
+    while (Readback_getPendingCount() > 0) Readback_update();
+    EncodeBatch();
+    if (_export.file) fclose(_export.file);
+
+    double seconds = GetTime() - _export.startTime;
+    double videoSeconds = (double)_export.written / _export.fps;
+    TraceLog(LOG_INFO, "Export: %d frames, %.1f s at %dx%d, in %.1f s (%.2fx real time), encoding %.1f s on %d threads",
+        _export.written, videoSeconds, _export.width, _export.height, seconds, seconds > 0.0 ? videoSeconds / seconds : 0.0,
+        _export.encodeSeconds, Jobs_getThreadCount());
+    if (_export.failed > 0) TraceLog(LOG_WARNING, "Export: %d frames could not be written", _export.failed);
+
+    for (int i = 0; i < EXPORT_BATCH_FRAMES; i++)
+    {
+        MemFree(_export.frames[i].pixels);
+        MemFree(_export.frames[i].yuv);
+    }
+    _export = (Export){0};
+}
+
+int Export_isActive()
+{
+    return _export.isActive;
+}
+
+float Export_getTimeStep()
+{
+    return 1.0f / (_export.fps > 0 ? _export.fps : 30);
+}
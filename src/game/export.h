@@ -0,0 +1,30 @@
+#ifndef __GAME_EXPORT_H__
+#define __GAME_EXPORT_H__
+
+#include "raylib.h"
+
+// Offline export of the rendered frames, for publishing a presentation as a video.
+// Frames are read back from the screen through the readback ring (see readback.h) and
+// collected in batches; a full batch is encoded on the worker pool (see jobs.h), one
+// frame per job. The output is either a directory of frameNNNNN.png files or, for a
+// path ending in .y4m, one uncompressed YUV4MPEG2 stream (4:2:0, BT.601 limited range)
+// that video encoders read directly, e.g. ffmpeg -i export.y4m export.mp4.
+
+// frames collected before they are encoded together
+#define EXPORT_BATCH_FRAMES 16
+
+// returns 0 if the output could not be opened; a PNG directory must exist
+int Export_begin(const char *path, int fps);
+// queues the read of the finished frame; call before EndDrawing. Every frame must have
+// the size of the first one.
+void Export_captureScreen();
+// adds a frame rendered on the CPU instead, R8G8B8A8 with the top row first; the image
+// is copied, so it can be reused for the next frame
+void Export_addFrame(Image image);
+// waits for the frames still in flight, encodes them and closes the output
+void Export_end();
+int Export_isActive();
+// game time per frame while exporting
+float Export_getTimeStep();
+
+#endif
@@ -0,0 +1,191 @@
+#include "framepacer.h"
+#include <math.h>
+
+#if defined(GAME_FRAME_CONTROL) && !defined(PLATFORM_WEB)
+#define FRAMEPACER_CONTROLS_FRAMES
+#if defined(_WIN32)
+// declared here as raylib does, windows.h clashes with raylib's names
+__declspec(dllimport) void __stdcall Sleep(unsigned long msTimeout);
+#else
+#include <time.h>
+#endif
+#endif
+
+// kept free after the estimated work of the frame, so that a slightly slower frame still
+// makes its present
+#define FRAMEPACER_SAFETY_SECONDS 0.001
+#define FRAMEPACER_MIN_SLEEP_MARGIN 0.00025
+#define FRAMEPACER_MAX_SLEEP_MARGIN 0.004
+
+typedef struct FramePacer {
+    int targetFps;
+    int isVsync;
+    double period;
+    // time the next swap should happen at
+    double nextPresent;
+    double lastPresent;
+    double pollTime;
+    // poll to the end of the frame's draws, rises at once and decays slowly
+    double workEstimate;
+    double sleepMargin;
+    double frameTime;
+    int hadInput;
+    FramePacerStats stats;
+} FramePacer;
+
+static FramePacer _pacer = { .sleepMargin = 0.001 };
+
+#if defined(FRAMEPACER_CONTROLS_FRAMES)
+static void SleepSeconds(double seconds)
+{
+#if defined(_WIN32)
+    // 1 ms resolution, raylib raises the timer resolution at init
+    Sleep((unsigned long)(seconds*1000.0));
+#else
+    struct timespec duration = { (time_t)seconds, (long)((seconds - (double)(time_t)seconds)*1e9) };
+    nanosleep(&duration, NULL);
+#endif
+}
+
+static void WaitUntil(double deadline)
+{
+    double start = GetTime();
+    double now = start;
+    // sleeps while the remaining time covers the worst overshoot seen lately
+    while (deadline - now > _pacer.sleepMargin)
+    {
+        double slice = deadline - now - _pacer.sleepMargin;
+        SleepSeconds(slice);
+        double end = GetTime();
+        double overshoot = end - now - slice;
+        if (overshoot > _pacer.sleepMargin) _pacer.sleepMargin = fmin(overshoot, FRAMEPACER_MAX_SLEEP_MARGIN);
+        else _pacer.sleepMargin = fmax(_pacer.sleepMargin + (overshoot - _pacer.sleepMargin)*0.01, FRAMEPACER_MIN_SLEEP_MARGIN);
+        now = end;
+    }
+    double spinStart = now;
+    while (now < deadline) now = GetTime();
+    _pacer.stats.lastSleepMs += (float)((spinStart - start)*1000.0);
+    _pacer.stats.lastSpinMs += (float)((now - spinStart)*1000.0);
+}
+#endif
+
+static void AddLatencySample(double seconds)
+{
+    FramePacerStats *stats = &_pacer.stats;
+    int bucket = (int)(seconds*1000.0);
+    if (bucket < 0) bucket = 0;
+    if (bucket >= FRAMEPACER_HISTOGRAM_BUCKETS) bucket = FRAMEPACER_HISTOGRAM_BUCKETS - 1;
+    stats->latencyHistogram[bucket]++;
+    stats->latencySamples++;
+    stats->lastLatencyMs = (float)(seconds*1000.0);
+}
+
+static void UpdateFrameStats(double frameTime)
+{
+    FramePacerStats *stats = &_pacer.stats;
+    _pacer.frameTime = frameTime;
+    stats->averageFrameMs += ((float)(frameTime*1000.0) - stats->averageFrameMs)*0.05f;
+    if (_pacer.period > 0.0)
+    {
+        stats->jitterMs += ((float)(fabs(frameTime - _pacer.period)*1000.0) - stats->jitterMs)*0.05f;
+    }
+}
+
+void FramePacer_setTargetFps(int fps)
+{
+    _pacer.targetFps = fps > 0 ? fps : 0;
+    _pacer.period = fps > 0 ? 1.0/fps : 0.0;
+    _pacer.nextPresent = 0.0;
+    _pacer.stats = (FramePacerStats){
+        .targetFps = _pacer.targetFps,
+        .isVsync = _pacer.isVsync,
+#if defined(FRAMEPACER_CONTROLS_FRAMES)
+        .isPacing = 1,
+#endif
+        .averageFrameMs = (float)(_pacer.period*1000.0),
+        .sleepMarginMs = (float)(_pacer.sleepMargin*1000.0),
+    };
+#if !defined(FRAMEPACER_CONTROLS_FRAMES)
+    SetTargetFPS(_pacer.targetFps);
+#endif
+}
+
+void FramePacer_setVsync(int enabled)
+{
+    _pacer.isVsync = enabled;
+    if (enabled) SetWindowState(FLAG_VSYNC_HINT);
+    else ClearWindowState(FLAG_VSYNC_HINT);
+    // a new histogram to compare against
+    FramePacer_setTargetFps(_pacer.targetFps);
+}
+
+void FramePacer_sampleInput()
+{
+#if defined(FRAMEPACER_CONTROLS_FRAMES)
+    _pacer.stats.lastSleepMs = _pacer.stats.lastSpinMs = 0.0f;
+    if (_pacer.period > 0.0 && _pacer.nextPresent > 0.0)
+    {
+        WaitUntil(_pacer.nextPresent - _pacer.workEstimate - FRAMEPACER_SAFETY_SECONDS);
+    }
+    _pacer.stats.sleepMarginMs = (float)(_pacer.sleepMargin*1000.0);
+    PollInputEvents();
+    _pacer.pollTime = GetTime();
+#endif
+    Vector2 delta = GetMouseDelta();
+    _pacer.hadInput = delta.x != 0.0f || delta.y != 0.0f || GetMouseWheelMove() != 0.0f ||
+        IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT);
+}
+
+void FramePacer_endFrame()
+{
+#if defined(FRAMEPACER_CONTROLS_FRAMES)
+    EndDrawing();
+    double work = GetTime() - _pacer.pollTime;
+    // without vsync the swap is held until its time, which keeps the frame times even
+    if (!_pacer.isVsync && _pacer.period > 0.0 && _pacer.nextPresent > 0.0) WaitUntil(_pacer.nextPresent);
+    SwapScreenBuffer();
+    double present = GetTime();
+    if (work > _pacer.workEstimate) _pacer.workEstimate = work;
+    else _pacer.workEstimate += (work - _pacer.workEstimate)*0.02;
+    if (_pacer.hadInput) AddLatencySample(present - _pacer.pollTime);
+    if (_pacer.lastPresent > 0.0) UpdateFrameStats(present - _pacer.lastPresent);
+    _pacer.lastPresent = present;
+
+    // with vsync the swap returns at the blank, which keeps the schedule in phase with it
+    if (_pacer.isVsync || _pacer.nextPresent == 0.0 || present > _pacer.nextPresent + _pacer.period)
+    {
+        _pacer.nextPresent = present + _pacer.period;
+    }
+    else _pacer.nextPresent += _pacer.period;
+#else
+    double swapStart = GetTime();
+    EndDrawing();
+    // raylib swapped, waited and polled: the next frame's input is from now
+    if (_pacer.hadInput && _pacer.pollTime > 0.0) AddLatencySample(swapStart - _pacer.pollTime);
+    _pacer.pollTime = GetTime();
+    UpdateFrameStats(GetFrameTime());
+#endif
+}
+
+float FramePacer_getFrameTime()
+{
+    return (float)_pacer.frameTime;
+}
+
+FramePacerStats FramePacer_getStats()
+{
+    return _pacer.stats;
+}
+
+float FramePacer_getLatencyPercentile(float fraction)
+{
+    const FramePacerStats *stats = &_pacer.stats;
+    int target = (int)ceilf(stats->latencySamples*fraction);
+    int count = 0;
+    for (int i = 0; i < FRAMEPACER_HISTOGRAM_BUCKETS; i++)
+    {
+        count += stats->latencyHistogram[i];
+        if (count >= target && count > 0) return (float)(i + 1);
+    }
+    return 0.0f;
+}
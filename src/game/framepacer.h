@@ -0,0 +1,62 @@
+#ifndef __GAME_FRAMEPACER_H__
+#define __GAME_FRAMEPACER_H__
+
+#include "raylib.h"
+
+// Frame pacing and input latency. raylib's EndDrawing swaps the buffers, sleeps until the
+// target frame time and polls the input, so the input of a frame is as old as the
+// frame's whole update and draw. With GAME_FRAME_CONTROL defined (make FRAME_CONTROL=TRUE,
+// which also passes it on to the hot reloaded game.dll), the pacer does those steps itself:
+// FramePacer_endFrame swaps, and FramePacer_sampleInput, called right before the input
+// is used, waits until the latest time at which the rest of the frame still makes its
+// present, then polls. Waits sleep while the remaining time covers the worst sleep
+// overshoot seen lately and spin for the rest. Presents follow a fixed schedule: without
+// vsync the swap is held until its time; with vsync (FramePacer_setVsync) the schedule is
+// realigned to the return of every swap, so the target should be the refresh rate or a
+// divisor of it.
+//
+// GAME_FRAME_CONTROL needs raylib rebuilt with SUPPORT_CUSTOM_FRAME_CONTROL (make
+// raylib_frame_control), which is off in raylib's config.h. Against a stock raylib the game
+// still builds, but EndDrawing swaps, waits and polls as well, so frames are presented twice.
+//
+// Without GAME_FRAME_CONTROL and on the web the frames are paced by raylib
+// (SetTargetFPS) and only the statistics are kept. Either way, frames whose input moved,
+// scrolled or clicked the mouse add the time from the poll to the swap to a latency
+// histogram. Key presses seen before FramePacer_sampleInput are those of the last
+// frame's poll, so every press is seen once by code before and once by code after it.
+
+// 1 ms buckets; the last one also counts everything slower
+#define FRAMEPACER_HISTOGRAM_BUCKETS 40
+
+typedef struct FramePacerStats {
+    int targetFps;
+    int isVsync;
+    int isPacing;
+    float averageFrameMs;
+    // average distance of the frame time from the target
+    float jitterMs;
+    // waits of the last frame, before the poll and before the swap
+    float lastSleepMs;
+    float lastSpinMs;
+    // time kept free for the OS sleep to overshoot
+    float sleepMarginMs;
+    // poll to swap, per frame with mouse input
+    int latencyHistogram[FRAMEPACER_HISTOGRAM_BUCKETS];
+    int latencySamples;
+    float lastLatencyMs;
+} FramePacerStats;
+
+// 0 runs unpaced; resets the statistics
+void FramePacer_setTargetFps(int fps);
+void FramePacer_setVsync(int enabled);
+// waits for the frame's deadline and polls the input; once per frame, before the input is read
+void FramePacer_sampleInput();
+// replaces EndDrawing
+void FramePacer_endFrame();
+// duration of the last frame, use instead of GetFrameTime which stays 0 with GAME_FRAME_CONTROL
+float FramePacer_getFrameTime();
+FramePacerStats FramePacer_getStats();
+// upper bound of the bucket that holds the given fraction of the latency samples, in ms
+float FramePacer_getLatencyPercentile(float fraction);
+
+#endif
@@ -0,0 +1,33 @@
+#include "glentry.h"
+
+#if !defined(GAME_BUILD_NAME) && defined(_WIN32)
+#define GLAD_GL_IMPLEMENTATION
+#include <stdint.h>
+#include <external/glad.h>
+
+// declared here since windows.h clashes with raylib.h
+__declspec(dllimport) void *__stdcall wglGetProcAddress(const char *name);
+__declspec(dllimport) void *__stdcall GetModuleHandleA(const char *name);
+__declspec(dllimport) void *__stdcall GetProcAddress(void *module, const char *name);
+
+static int _isLoaded;
+
+static GLADapiproc GetGlProcAddress(const char *name)
+{
+    void *proc = wglGetProcAddress(name);
+    // GL 1.1 functions only come from opengl32.dll, wglGetProcAddress fails with 0 to 3 or -1
+    if ((intptr_t)proc >= -1 && (intptr_t)proc <= 3) proc = GetProcAddress(GetModuleHandleA("opengl32.dll"), name);
+    return (GLADapiproc)proc;
+}
+
+void GlEntry_load()
+{
+    if (_isLoaded) return;
+    _isLoaded = 1;
+    gladLoadGL(GetGlProcAddress);
+}
+#else
+void GlEntry_load()
+{
+}
+#endif
@@ -0,0 +1,12 @@
+#ifndef __GAME_GLENTRY_H__
+#define __GAME_GLENTRY_H__
+
+// Entry points of the GL calls the game makes itself through external/glad.h, for the
+// readback ring (readback.h) and the GPU timers (shadervariant.h). The unity build shares
+// raylib's, which InitWindow has loaded. game.dll links raylib.dll, which keeps its loader
+// to itself, so the DLL has its own copy of the entry points and GlEntry_load fills them
+// from opengl32 on its first call. Callers check the functions they need afterwards: an
+// older context leaves some of them NULL.
+void GlEntry_load();
+
+#endif
@@ -0,0 +1,148 @@
+#include "jobs.h"
+#include "raylib.h"
+
+#if defined(PLATFORM_WEB)
+
+void Jobs_parallelFor(int count, JobFn fn, void *userData)
+{
+    for (int i = 0; i < count; i++) fn(i, userData);
+}
+
+int Jobs_getThreadCount()
+{
+    return 1;
+}
+
+void Jobs_shutdown()
+{
+}
+
+#else
+#include <pthread.h>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#define JOBS_MAX_THREADS 16
+
+typedef struct JobPool {
+    pthread_t threads[JOBS_MAX_THREADS];
+    int threadCount;
+    int isRunning;
+    int quit;
+    pthread_mutex_t mutex;
+    pthread_cond_t workAvailable;
+    pthread_cond_t workDone;
+    JobFn fn;
+    void *userData;
+    int count;
+    int next;
+    int remaining;
+} JobPool;
+
+static JobPool _jobPool;
+
+// takes and runs items until none are left; called with the mutex held, returns with it held
+static void JobPool_runItems(JobPool *pool)
+{
+    while (pool->next < pool->count)
+    {
+        int index = pool->next++;
+        JobFn fn = pool->fn;
+        void *userData = pool->userData;
+        pthread_mutex_unlock(&pool->mutex);
+        fn(index, userData);
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->remaining == 0) pthread_cond_broadcast(&pool->workDone);
+    }
+}
+
+static void *JobPool_worker(void *arg)
+{
+    JobPool *pool = arg;
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->quit)
+    {
+        if (pool->next < pool->count) JobPool_runItems(pool);
+        else pthread_cond_wait(&pool->workAvailable, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+static int GetCpuCount()
+{
+#if defined(_WIN32)
+    return pthread_num_processors_np();
+#else
+    return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+static void JobPool_start(JobPool *pool)
+{
+    pool->isRunning = 1;
+    pool->quit = 0;
+    pool->count = pool->next = pool->remaining = 0;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->workAvailable, NULL);
+    pthread_cond_init(&pool->workDone, NULL);
+
+    int workerCount = GetCpuCount() - 1;
+    if (workerCount > JOBS_MAX_THREADS) workerCount = JOBS_MAX_THREADS;
+    pool->threadCount = 0;
+    for (int i = 0; i < workerCount; i++)
+    {
+        if (pthread_create(&pool->threads[pool->threadCount], NULL, JobPool_worker, pool) == 0) pool->threadCount++;
+    }
+    TraceLog(LOG_INFO, "Jobs: started %d worker threads", pool->threadCount);
+}
+
+void Jobs_parallelFor(int count, JobFn fn, void *userData)
+{
+    JobPool *pool = &_jobPool;
+    if (!pool->isRunning) JobPool_start(pool);
+    if (count <= 0) return;
+    if (count == 1 || pool->threadCount == 0)
+    {
+        for (int i = 0; i < count; i++) fn(i, userData);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->fn = fn;
+    pool->userData = userData;
+    pool->count = count;
+    pool->next = 0;
+    pool->remaining = count;
+    pthread_cond_broadcast(&pool->workAvailable);
+    JobPool_runItems(pool);
+    while (pool->remaining > 0) pthread_cond_wait(&pool->workDone, &pool->mutex);
+    pool->count = pool->next = 0;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+int Jobs_getThreadCount()
+{
+    if (!_jobPool.isRunning) JobPool_start(&_jobPool);
+    return _jobPool.threadCount + 1;
+}
+
+void Jobs_shutdown()
+{
+    JobPool *pool = &_jobPool;
+    if (!pool->isRunning) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->workAvailable);
+    pthread_mutex_unlock(&pool->mutex);
+    for (int i = 0; i < pool->threadCount; i++) pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->workAvailable);
+    pthread_cond_destroy(&pool->workDone);
+    pthread_mutex_destroy(&pool->mutex);
+    *pool = (JobPool){0};
+}
+
+#endif
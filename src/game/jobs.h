@@ -0,0 +1,16 @@
+#ifndef __GAME_JOBS_H__
+#define __GAME_JOBS_H__
+
+// Small persistent worker pool for parallel loops. Worker threads are started on
+// first use and must be stopped with Jobs_shutdown before the game code is unloaded.
+// On the web build everything runs on the calling thread.
+
+typedef void (*JobFn)(int index, void *userData);
+
+// calls fn(i, userData) for i in [0, count) on all workers plus the calling thread
+// and returns when every call has finished
+void Jobs_parallelFor(int count, JobFn fn, void *userData);
+int Jobs_getThreadCount();
+void Jobs_shutdown();
+
+#endif
@@ -1,10 +1,29 @@
 #include "main.h"
 #include <math.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <external/glad.h>
 #include <memory.h>
+#include <stdlib.h>
+#include <string.h>
 #include <raymath.h>
 #include "scriptactions.h"
+#include "rendertarget.h"
+#include "modelimport.h"
+#include "shadervariant.h"
+#include "softraster.h"
+#include "jobs.h"
+#include "drawlist.h"
+#include "scriptfile.h"
+#include "bundle.h"
+#include "tween.h"
+#include "replay.h"
+#include "readback.h"
+#include "picking.h"
+#include "export.h"
+#include "alloctrack.h"
+#include "framepacer.h"
+#include "sdffont.h"
 
 typedef struct ConextData {
     int step;
@@ -16,14 +35,194 @@ static Model _sampleObjects;
 static Model _flatVectorScene;
 static Model _flatVectorSceneOutlines;
 
+// scripts refer to the scene models by name, object ids of picking by index
+#define SCENE_MODEL_COUNT 4
+// object id of mesh i of scene model k: k << PICK_ID_MESH_BITS | i
+#define PICK_ID_MESH_BITS 16
+
+static const char *_sceneModelNames[SCENE_MODEL_COUNT] = {
+    "polyobjects", "sampleObjects", "flatVectorScene", "flatVectorSceneOutlines"
+};
+static Model *_sceneModels[SCENE_MODEL_COUNT] = {
+    &_model, &_sampleObjects, &_flatVectorScene, &_flatVectorSceneOutlines
+};
+static const char *_sceneModelFiles[SCENE_MODEL_COUNT] = {
+    "resources/polyobjects.glb", "resources/sampleObjects.glb", "resources/flat-vector-scene.glb",
+    "resources/flat-vector-scene-outlines.glb"
+};
+// the texture each glb embeds, decoded on the CPU for the soft rasterizer
+static const char *_sceneTextureFiles[SCENE_MODEL_COUNT] = {
+    "resources/dawnbringers-8-color-8x.png", "resources/crate_tex.png", "resources/db8.png", "resources/db8.png"
+};
+static int _sceneModelIsBundled[SCENE_MODEL_COUNT];
+// per material R8G8B8A8 textures of the scene models for the soft rasterizer, loaded on first use
+static Image *_softRasterTextures[SCENE_MODEL_COUNT];
+// bit k is set when scene model k was drawn in this frame
+static int _drawnModelMask;
+
+#define DITHER_FEATURE_BAKED 1
+#define DITHER_FEATURE_INSTANCED 2
+#define DITHER_FEATURE_OBJECT_ID 4
+#define OUTLINE_FEATURE_DEPTH 1
+#define OUTLINE_FEATURE_UV 2
+
 static Shader _defaultShader;
-static Shader _shader;
-static Shader _outlineShader;
-static Shader *_postProcessorShader;
+static ShaderVariantSet _ditherShaders;
+static ShaderVariantSet _outlineShaders;
+static ShaderVariantSet _sdfTextShaders;
+static ShaderVariant *_postProcessor;
+static int _showDebugOverlay;
+// draw the 3D scene with the CPU rasterizer instead of the GPU
+static int _useSoftRaster;
+// draw distant meshes with their simplified levels of detail
+static int _useLods = 1;
+// capture requested for the end of this frame: 1 the screen, 2 the scene image only
+static int _captureRequest;
+// render the object id under the mouse for picking, see RenderPickIds
+static int _usePickIds;
+// 1x1 target of the id pass
+static RenderTexture2D _pickTarget = {0};
+// CPU time of the last id pass
+static float _pickIdMs;
 static RenderTexture2D _target = {0};
-
-static int _allocationPoolIndex;
-static char _allocationPool[2048];
+// post processed scene at the size of _target
+static RenderTexture2D _postTarget = {0};
+// final scene image of the frame: _postTarget, or _target when there is no post processing;
+// shown on screen and sampled by the magnifiers
+static Texture2D _sceneTexture = {0};
+// angles and distance of the orbit camera; driven by mouse input and script tweens
+typedef struct OrbitCamera {
+    Vector2 rotation;
+    Vector2 rotateVelocity;
+    float distance;
+    float distanceVelocity;
+} OrbitCamera;
+
+static OrbitCamera _orbit = {
+    .rotation = {1.0f, -2.5f},
+    .distance = 5.0f,
+};
+// opacity of the scene, faded in by script steps
+static float _sceneFade = 1.0f;
+
+// overlay UI of the script steps; drawn into a cached texture that is only redrawn
+// when it was invalidated and composited over the scene with a single quad
+typedef struct UiLayer {
+    RenderTexture2D target;
+    int isDirty;
+    int redrawCount;
+} UiLayer;
+
+static UiLayer _uiLayer = { .isDirty = 1 };
+
+// gap between the viewports in their shared targets, post processors that sample the
+// neighbor pixels see background there
+#define VIEWPORT_GUTTER 2
+
+// viewports of the current step and the targets all of them share, see Viewport in main.h
+typedef struct ViewportSet {
+    Viewport viewports[VIEWPORT_MAX];
+    int count;
+    RenderTexture2D target;
+    RenderTexture2D postTarget;
+    // area of each viewport in both targets, in pixels from the bottom left as GL counts
+    Rectangle slots[VIEWPORT_MAX];
+    ShaderVariant *postProcessors[VIEWPORT_MAX];
+    float renderMs;
+} ViewportSet;
+
+static ViewportSet _viewports;
+
+// camera and target size of the pass that is drawn: the main scene or a viewport
+typedef struct ScenePass {
+    Camera3D camera;
+    float width, height;
+    // index in _viewports, -1 for the main scene
+    int viewport;
+} ScenePass;
+
+static ScenePass _pass = { .viewport = -1 };
+
+// time that animations and the camera run on; see UpdateGameClock
+typedef struct GameClock {
+    double time;
+    float frameTime;
+} GameClock;
+
+static GameClock _clock;
+// frame rate outside of benchmarks and exports, see framepacer.h
+#define TARGET_FPS 60
+
+// replays the recorded camera path on every script step and collects the frame times
+#define STEP_BENCHMARK_FRAMES 120
+// the unity build of raylib_game.c names itself, see Game_startWalkthrough
+#if !defined(GAME_BUILD_NAME)
+#define GAME_BUILD_NAME "hot reload"
+// the script is read from its file even when the bundle has it, so that edits are
+// reloaded as in a build without the bundle; see IsScriptBundled
+#define SCRIPT_PREFERS_FILE
+#endif
+
+typedef struct StepBenchmark {
+    int isRunning;
+    int step;
+    int frame;
+    int framesPerStep;
+    // framesPerStep entries per step
+    float *frameTimes;
+    double frameStart;
+    // the results are also written here when not empty
+    char reportFileName[256];
+} StepBenchmark;
+
+static StepBenchmark _stepBenchmark;
+
+// renders every script step for a fixed number of frames into the export output,
+// see Game_startExport
+typedef struct ExportRun {
+    int isRunning;
+    int step;
+    int frame;
+    int framesPerStep;
+} ExportRun;
+
+static ExportRun _exportRun;
+
+// orbit camera, updated at the start of each frame in Game_update
+static Camera3D _camera = {
+    .fovy = 45.0f,
+    .target = {0.0f, 0.25f, 0.0f},
+    .up = {0.0f, 1.0f, 0.0f},
+    .position = {-4.0f, 2.5f, -3.0f},
+};
+
+// pixel size of _target relative to the screen, 1 = full resolution, 4 = quarter resolution
+static int _renderScale = 2;
+
+typedef struct DynamicResolution {
+    int enabled;
+    float targetFps;
+    float smoothedFrameTime;
+    double nextChangeTime;
+    // when a finer scale turned out to be too slow, it is blocked for an increasing duration
+    double blockedUntil[RENDER_SCALE_MAX + 1];
+    float blockDuration[RENDER_SCALE_MAX + 1];
+} DynamicResolution;
+
+static DynamicResolution _dynamicResolution = {
+    .targetFps = 60.0f,
+};
+
+#define SCRIPT_FILE "resources/tutorial.script"
+#define SCRIPT_BINARY_FILE "resources/tutorial.scriptbin"
+// seconds between checks of the script file's modification time
+#define SCRIPT_RELOAD_INTERVAL 0.25
+
+static const char *_scriptFileName;
+static long _scriptModTime;
+static double _scriptNextReloadCheck;
+// arena that pool_alloc allocates from, the one of the script that is being built
+static Arena *_allocationArena = &_script.arena;
 
 Font _fntMono = {0};
 Font _fntMedium = {0};
@@ -41,513 +240,1700 @@ void SetSceneDrawingFunction(void (*fn)(void*), void *drawSceneData)
 
 void* pool_alloc(int size, void *data)
 {
-    void *ptr = &_allocationPool[_allocationPoolIndex];
-    //ensure alignment
-    size = (size + 0xf) & ~0xf;
-    _allocationPoolIndex += size;
+    void *ptr = Arena_alloc(_allocationArena, size);
     memcpy(ptr, data, size);
     return ptr;
 }
 
 
-void Script_init()
+void Script_free(Script *script)
+{
+    MemFree(script->actions);
+    MemFree(script->labels);
+    Arena_free(&script->arena);
+    script->actions = NULL;
+    script->actionCount = script->actionCapacity = 0;
+    script->stepCount = 0;
+    script->steps = NULL;
+    script->stepActions = NULL;
+    script->labels = NULL;
+    script->labelCount = script->labelCapacity = 0;
+}
+
+void Script_appendAction(Script *script, ScriptAction action)
+{
+    if (script->actionCount == script->actionCapacity)
+    {
+        script->actionCapacity = script->actionCapacity ? script->actionCapacity * 2 : 64;
+        script->actions = MemRealloc(script->actions, script->actionCapacity * sizeof(ScriptAction));
+    }
+
+    // default init, if no end, assume length 1
+    if (action.actionIdEnd < action.actionIdStart)
+    {
+        action.actionIdEnd = action.actionIdStart;
+    }
+
+    script->actions[script->actionCount++] = action;
+}
+
+
+void Script_addLabel(Script *script, const char *name, int step)
+{
+    if (script->labelCount == script->labelCapacity)
+    {
+        script->labelCapacity = script->labelCapacity ? script->labelCapacity * 2 : 16;
+        script->labels = MemRealloc(script->labels, script->labelCapacity * sizeof(ScriptLabel));
+    }
+    script->labels[script->labelCount++] = (ScriptLabel){
+        .name = Arena_strdup(&script->arena, name, (int)strlen(name)),
+        .step = step,
+    };
+}
+
+static int CompareLabels(const void *a, const void *b)
+{
+    return strcmp(((const ScriptLabel*)a)->name, ((const ScriptLabel*)b)->name);
+}
+
+void Script_buildSteps(Script *script)
+{
+    int stepCount = script->stepCount;
+    script->steps = Arena_alloc(&script->arena, stepCount * sizeof(ScriptStep));
+
+    // scenes are applied in action order, so a later scene action wins like it did when
+    // all actions were evaluated; overlay actions are counted per step first
+    int overlayCount = 0;
+    for (int i = 0; i < script->actionCount; i++)
+    {
+        ScriptAction *action = &script->actions[i];
+        int start = action->actionIdStart < 0 ? 0 : action->actionIdStart;
+        int end = action->actionIdEnd >= stepCount ? stepCount - 1 : action->actionIdEnd;
+        void (*drawFn)(void*);
+        void *drawData;
+        int isScene = ScriptAction_getDrawScene(action, &drawFn, &drawData);
+        for (int step = start; step <= end; step++)
+        {
+            if (isScene)
+            {
+                script->steps[step].drawSceneFn = drawFn;
+                script->steps[step].drawSceneData = drawData;
+            }
+            else
+            {
+                script->steps[step].actionCount++;
+                overlayCount++;
+            }
+        }
+    }
+
+    script->stepActions = Arena_alloc(&script->arena, (overlayCount > 0 ? overlayCount : 1) * sizeof(int));
+    int first = 0;
+    for (int step = 0; step < stepCount; step++)
+    {
+        ScriptStep *state = &script->steps[step];
+        // a scene stays active until another one is set
+        if (state->drawSceneFn == NULL && step > 0)
+        {
+            state->drawSceneFn = script->steps[step - 1].drawSceneFn;
+            state->drawSceneData = script->steps[step - 1].drawSceneData;
+        }
+        state->firstAction = first;
+        first += state->actionCount;
+        state->actionCount = 0;
+    }
+
+    for (int i = 0; i < script->actionCount; i++)
+    {
+        ScriptAction *action = &script->actions[i];
+        if (action->action == ScriptAction_setDrawScene) continue;
+        int start = action->actionIdStart < 0 ? 0 : action->actionIdStart;
+        int end = action->actionIdEnd >= stepCount ? stepCount - 1 : action->actionIdEnd;
+        for (int step = start; step <= end; step++)
+        {
+            ScriptStep *state = &script->steps[step];
+            script->stepActions[state->firstAction + state->actionCount++] = i;
+        }
+    }
+
+    if (script->labelCount > 1) qsort(script->labels, script->labelCount, sizeof(ScriptLabel), CompareLabels);
+    for (int i = 1; i < script->labelCount; i++)
+    {
+        if (strcmp(script->labels[i - 1].name, script->labels[i].name) == 0)
+        {
+            TraceLog(LOG_WARNING, "Script: label '%s' is defined more than once", script->labels[i].name);
+        }
+    }
+}
+
+int Script_findLabel(const Script *script, const char *name)
+{
+    if (script->labelCount == 0) return -1;
+    ScriptLabel key = { .name = name };
+    const ScriptLabel *label = bsearch(&key, script->labels, script->labelCount, sizeof(ScriptLabel), CompareLabels);
+    return label ? label->step : -1;
+}
+
+void Script_seek(int step)
+{
+    if (step >= _script.stepCount) step = _script.stepCount - 1;
+    if (step < 0) step = 0;
+    _script.currentActionId = _script.nextActionId = step;
+    _script.stepStartTime = GetGameTime();
+    _contextData->step = step;
+    // animations of the previous step jump to their end, the new step starts its own
+    Tween_stopAll(1);
+    _uiLayer.isDirty = 1;
+    if (_script.steps == NULL || step >= _script.stepCount)
+    {
+        ClearViewports();
+        return;
+    }
+
+    ScriptStep *state = &_script.steps[step];
+    if (state->drawSceneFn) SetSceneDrawingFunction(state->drawSceneFn, state->drawSceneData);
+    ClearViewports();
+    for (int i = 0; i < state->actionCount; i++)
+    {
+        ScriptAction *action = &_script.actions[_script.stepActions[state->firstAction + i]];
+        if (action->enter) action->enter(&_script, action);
+    }
+}
+
+double GetGameTime()
+{
+    return _clock.time;
+}
+
+float GetGameFrameTime()
+{
+    return _clock.frameTime;
+}
+
+// recordings and replays run on a fixed time step so camera paths can be reproduced
+static void UpdateGameClock()
+{
+    int fixedStep = Replay_isRecording() || Replay_isPlaying() || _stepBenchmark.isRunning;
+    if (Export_isActive()) _clock.frameTime = Export_getTimeStep();
+    else _clock.frameTime = fixedStep ? REPLAY_TIME_STEP : FramePacer_getFrameTime();
+    _clock.time += _clock.frameTime;
+}
+
+void Script_invalidateUi()
+{
+    _uiLayer.isDirty = 1;
+}
+
+static void DrawUiLayer(ScriptStep *step)
+{
+    int width = GetScreenWidth();
+    int height = GetScreenHeight();
+    if (_uiLayer.target.texture.width != width || _uiLayer.target.texture.height != height)
+    {
+        RenderTargetPool_release(_uiLayer.target);
+        _uiLayer.target = RenderTargetPool_acquire(width, height);
+        _uiLayer.isDirty = 1;
+    }
+
+    if (_uiLayer.isDirty)
+    {
+        _uiLayer.isDirty = 0;
+        _uiLayer.redrawCount++;
+        BeginTextureMode(_uiLayer.target);
+        ClearBackground(BLANK);
+        for (int i = 0; step && i < step->actionCount; i++)
+        {
+            ScriptAction *action = &_script.actions[_script.stepActions[step->firstAction + i]];
+            if (action->drawUi) action->drawUi(&_script, action);
+        }
+        EndTextureMode();
+    }
+
+    DrawTextureRec(_uiLayer.target.texture, (Rectangle){0.0f, 0.0f, (float)width, (float)-height}, (Vector2){0.0f, 0.0f}, WHITE);
+}
+
+float Script_getStepTime()
+{
+    return (float)(GetGameTime() - _script.stepStartTime);
+}
+
+void SetCameraOrbit(float pitch, float yaw, float distance, float duration)
+{
+    _orbit.rotateVelocity = (Vector2){0.0f, 0.0f};
+    _orbit.distanceVelocity = 0.0f;
+    // turn the short way around
+    float yawFrom = _orbit.rotation.y;
+    yaw = yawFrom + remainderf(yaw - yawFrom, 2.0f * PI);
+    Tween_add(&_orbit.rotation.x, _orbit.rotation.x, pitch, duration, TWEEN_EASE_IN_OUT);
+    Tween_add(&_orbit.rotation.y, yawFrom, yaw, duration, TWEEN_EASE_IN_OUT);
+    Tween_add(&_orbit.distance, _orbit.distance, distance, duration, TWEEN_EASE_IN_OUT);
+}
+
+void FadeInScene(float duration)
+{
+    Tween_add(&_sceneFade, 0.0f, 1.0f, duration, TWEEN_LINEAR);
+}
+
+int Script_seekLabel(const char *name)
+{
+    int step = Script_findLabel(&_script, name);
+    if (step < 0)
+    {
+        TraceLog(LOG_WARNING, "Script: unknown label '%s'", name);
+        return 0;
+    }
+    Script_seek(step);
+    return 1;
+}
+
+void Script_update()
+{
+    _script.nextActionId = _script.currentActionId;
+    ScriptStep *step = NULL;
+    if (_script.steps && _script.currentActionId >= 0 && _script.currentActionId < _script.stepCount)
+    {
+        step = &_script.steps[_script.currentActionId];
+        for (int i = 0; i < step->actionCount; i++)
+        {
+            ScriptAction *action = &_script.actions[_script.stepActions[step->firstAction + i]];
+            if (action->action) action->action(&_script, action);
+        }
+    }
+    DrawUiLayer(step);
+    if (_script.nextActionId != _script.currentActionId)
+    {
+        Script_seek(_script.nextActionId);
+    }
+}
+
+void SetRenderScale(int pixelSize)
+{
+    if (pixelSize < RENDER_SCALE_MIN) pixelSize = RENDER_SCALE_MIN;
+    if (pixelSize > RENDER_SCALE_MAX) pixelSize = RENDER_SCALE_MAX;
+    _renderScale = pixelSize;
+}
+
+int GetRenderScale()
+{
+    return _renderScale;
+}
+
+void SetDynamicResolution(int enabled, float targetFps)
+{
+    _dynamicResolution.enabled = enabled;
+    _dynamicResolution.targetFps = targetFps > 0.0f ? targetFps : 60.0f;
+    _dynamicResolution.smoothedFrameTime = 1.0f / _dynamicResolution.targetFps;
+    _dynamicResolution.nextChangeTime = GetTime() + 1.0;
+    for (int i = 0; i <= RENDER_SCALE_MAX; i++)
+    {
+        _dynamicResolution.blockedUntil[i] = 0.0;
+        _dynamicResolution.blockDuration[i] = 2.0f;
+    }
+}
+
+int IsDynamicResolutionEnabled()
+{
+    return _dynamicResolution.enabled;
+}
+
+static void UpdateDynamicResolution()
+{
+    DynamicResolution *dr = &_dynamicResolution;
+    if (!dr->enabled) return;
+
+    float targetFrameTime = 1.0f / dr->targetFps;
+    dr->smoothedFrameTime += (FramePacer_getFrameTime() - dr->smoothedFrameTime) * 0.1f;
+    double now = GetTime();
+    if (now < dr->nextChangeTime) return;
+
+    if (dr->smoothedFrameTime > targetFrameTime * 1.1f && _renderScale < RENDER_SCALE_MAX)
+    {
+        // too slow: block the current scale for a while, doubling the time on each failure
+        dr->blockedUntil[_renderScale] = now + dr->blockDuration[_renderScale];
+        dr->blockDuration[_renderScale] = fminf(dr->blockDuration[_renderScale] * 2.0f, 60.0f);
+        _renderScale++;
+        dr->smoothedFrameTime = targetFrameTime;
+        dr->nextChangeTime = now + 0.5;
+        TraceLog(LOG_INFO, "dynamic resolution: render scale 1/%d", _renderScale);
+    }
+    else if (dr->smoothedFrameTime < targetFrameTime * 1.02f && _renderScale > RENDER_SCALE_MIN
+        && now >= dr->blockedUntil[_renderScale - 1])
+    {
+        _renderScale--;
+        dr->nextChangeTime = now + 1.0;
+        TraceLog(LOG_INFO, "dynamic resolution: render scale 1/%d", _renderScale);
+    }
+}
+
+void UpdateRenderTexture()
+{
+    UpdateDynamicResolution();
+
+    int width = GetScreenWidth() / _renderScale;
+    int height = GetScreenHeight() / _renderScale;
+    if (width < 1) width = 1;
+    if (height < 1) height = 1;
+    if (width != _target.texture.width || height != _target.texture.height)
+    {
+        AllocTrack_allowFrame("render target resize");
+        RenderTargetPool_release(_target);
+        RenderTargetPool_release(_postTarget);
+        _target = RenderTargetPool_acquire(width, height);
+        _postTarget = RenderTargetPool_acquire(width, height);
+        _sceneTexture = _target.texture;
+    }
+    RenderTargetPool_update();
+}
+
+
+// models whose dither blocks were baked at import use the leaner shader variant
+static Shader GetDitherShader(Model *model)
+{
+    ModelImportInfo *info = ModelImport_getInfo(model);
+    return ShaderVariantSet_get(&_ditherShaders, info && info->ditherBaked ? DITHER_FEATURE_BAKED : 0)->shader;
+}
+
+// the instanced variants take the model matrix from the instanceTransform attribute
+static void SetupInstancedDitherShaders()
+{
+    for (int mask = 0; mask < (1 << _ditherShaders.featureCount); mask++)
+    {
+        if ((mask & DITHER_FEATURE_INSTANCED) == 0) continue;
+        Shader shader = ShaderVariantSet_get(&_ditherShaders, mask)->shader;
+        shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+    }
+}
+
+// pixels of the render target covered by one world unit at the given distance from the camera
+static float GetPixelsPerUnit(float distance)
+{
+    float height = _pass.height;
+    if (_pass.camera.projection == CAMERA_ORTHOGRAPHIC) return height / _pass.camera.fovy;
+    return height / (2.0f * distance * tanf(_pass.camera.fovy * 0.5f * DEG2RAD));
+}
+
+static float GetMaxScale(Matrix m)
+{
+    return fmaxf(Vector3Length((Vector3){ m.m0, m.m1, m.m2 }),
+        fmaxf(Vector3Length((Vector3){ m.m4, m.m5, m.m6 }), Vector3Length((Vector3){ m.m8, m.m9, m.m10 })));
+}
+
+// level of detail of a queued mesh, from the size of its simplification error on screen;
+// copies use the levels of their instance source, whose error is in the source's units
+static int SelectMeshLod(Model *model, ModelImportInfo *info, const DrawListItem *item)
+{
+    if (!_useLods || info == NULL) return 0;
+    int i = item->meshIndex;
+    int source = info->instanceSource[i] >= 0 ? info->instanceSource[i] : i;
+    float scale = GetMaxScale(model->transform);
+    float sourceScale = source == i ? scale : GetMaxScale(MatrixMultiply(info->instanceTransform[i], model->transform));
+    BoundingBox bounds = info->meshBounds[i];
+    float radius = 0.5f * Vector3Distance(bounds.min, bounds.max) * scale;
+    // measured at the point of the bounding sphere nearest to the camera
+    float distance = fmaxf(sqrtf(item->distance) - radius, 0.1f);
+    return ModelImport_selectLod(info, source, GetPixelsPerUnit(distance) * sourceScale);
+}
+
+// instance transforms of the meshes drawn with one vertex array
+typedef struct InstanceBuffer {
+    unsigned int vaoId;
+    unsigned int vboId;
+    int capacity;
+} InstanceBuffer;
+
+typedef struct InstanceBatch {
+    // per mesh of the model: number of visible instances, their offset in transforms
+    // and the level of detail of the nearest one, which is used for all of them
+    int *counts;
+    int *offsets;
+    int *levels;
+    int meshCapacity;
+    Matrix *transforms;
+    // transforms in the column order of the instanceTransform attribute
+    float16 *instanceData;
+    int transformCapacity;
+    InstanceBuffer *buffers;
+    int bufferCount;
+    int bufferCapacity;
+} InstanceBatch;
+
+static InstanceBatch _instanceBatch;
+
+// the buffer of the vertex array, grown to hold count transforms
+static InstanceBuffer *GetInstanceBuffer(unsigned int vaoId, int count)
+{
+    InstanceBatch *batch = &_instanceBatch;
+    InstanceBuffer *buffer = NULL;
+    for (int i = 0; i < batch->bufferCount; i++)
+    {
+        if (batch->buffers[i].vaoId == vaoId) buffer = &batch->buffers[i];
+    }
+    if (buffer == NULL)
+    {
+        if (batch->bufferCount == batch->bufferCapacity)
+        {
+            batch->bufferCapacity = batch->bufferCapacity ? batch->bufferCapacity * 2 : 16;
+            batch->buffers = MemRealloc(batch->buffers, batch->bufferCapacity * sizeof(InstanceBuffer));
+        }
+        buffer = &batch->buffers[batch->bufferCount++];
+        *buffer = (InstanceBuffer){ .vaoId = vaoId };
+    }
+    if (count > buffer->capacity)
+    {
+        if (buffer->vboId != 0) rlUnloadVertexBuffer(buffer->vboId);
+        buffer->capacity = buffer->capacity ? buffer->capacity : 16;
+        while (buffer->capacity < count) buffer->capacity *= 2;
+        buffer->vboId = rlLoadVertexBuffer(NULL, buffer->capacity * sizeof(float16), true);
+    }
+    return buffer;
+}
+
+static void UnloadInstanceBuffers()
+{
+    InstanceBatch *batch = &_instanceBatch;
+    for (int i = 0; i < batch->bufferCount; i++) rlUnloadVertexBuffer(batch->buffers[i].vboId);
+    MemFree(batch->buffers);
+    batch->buffers = NULL;
+    batch->bufferCount = batch->bufferCapacity = 0;
+}
+
+// DrawMeshInstanced without its per call work: raylib allocates the transform array and
+// creates and deletes a vertex buffer on every call, which fails the steady state check
+// of alloctrack.h, here the transforms are written into a buffer kept per vertex array.
+// Needs a vertex array and the instanceTransform attribute, see CanDrawInstances. Only
+// the diffuse map is bound, the dither shaders sample nothing else.
+static int CanDrawInstances(Mesh mesh, Shader shader)
+{
+    return mesh.vaoId != 0 && shader.locs[SHADER_LOC_MATRIX_MODEL] >= 0;
+}
+
+static void DrawMeshInstances(Mesh mesh, Material material, const Matrix *transforms, int count)
+{
+    int location = material.shader.locs[SHADER_LOC_MATRIX_MODEL];
+    float16 *instanceData = _instanceBatch.instanceData;
+    for (int i = 0; i < count; i++) instanceData[i] = MatrixToFloatV(transforms[i]);
+    InstanceBuffer *buffer = GetInstanceBuffer(mesh.vaoId, count);
+    rlUpdateVertexBuffer(buffer->vboId, instanceData, count * sizeof(float16), 0);
+
+    int *locs = material.shader.locs;
+    rlEnableShader(material.shader.id);
+    if (locs[SHADER_LOC_COLOR_DIFFUSE] != -1)
+    {
+        Color color = material.maps[MATERIAL_MAP_DIFFUSE].color;
+        float values[4] = { color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f };
+        rlSetUniform(locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+    }
+    // as in DrawMeshInstanced, the model matrix comes from the instances and mvp is the rest
+    Matrix view = rlGetMatrixModelview();
+    Matrix projection = rlGetMatrixProjection();
+    if (locs[SHADER_LOC_MATRIX_VIEW] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_VIEW], view);
+    if (locs[SHADER_LOC_MATRIX_PROJECTION] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_PROJECTION], projection);
+    if (locs[SHADER_LOC_MATRIX_NORMAL] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_NORMAL], MatrixIdentity());
+    rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(MatrixMultiply(rlGetMatrixTransform(), view), projection));
+
+    Texture2D texture = material.maps[MATERIAL_MAP_DIFFUSE].texture;
+    if (texture.id > 0)
+    {
+        int slot = 0;
+        rlActiveTextureSlot(slot);
+        rlEnableTexture(texture.id);
+        rlSetUniform(locs[SHADER_LOC_MAP_DIFFUSE], &slot, SHADER_UNIFORM_INT, 1);
+    }
+
+    rlEnableVertexArray(mesh.vaoId);
+    rlEnableVertexBuffer(buffer->vboId);
+    for (int i = 0; i < 4; i++)
+    {
+        rlEnableVertexAttribute(location + i);
+        rlSetVertexAttribute(location + i, 4, RL_FLOAT, false, sizeof(float16), (void*)(i * sizeof(Vector4)));
+        rlSetVertexAttributeDivisor(location + i, 1);
+    }
+    if (mesh.indices != NULL) rlDrawVertexArrayElementsInstanced(0, mesh.triangleCount * 3, 0, count);
+    else rlDrawVertexArrayInstanced(0, mesh.vertexCount, count);
+    // the vertex array is also drawn without instances
+    for (int i = 0; i < 4; i++) rlDisableVertexAttribute(location + i);
+
+    if (texture.id > 0)
+    {
+        rlActiveTextureSlot(0);
+        rlDisableTexture();
+    }
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableVertexBufferElement();
+    rlDisableShader();
+}
+
+// draws the visible copies of each repeated mesh with one instanced call; the draw
+// order of the groups follows their first visible copy
+static void DrawInstancedMeshes(Model *model, ModelImportInfo *info, const DrawListItem *items, int itemCount)
+{
+    InstanceBatch *batch = &_instanceBatch;
+    if (model->meshCount > batch->meshCapacity)
+    {
+        batch->meshCapacity = model->meshCount;
+        batch->counts = MemRealloc(batch->counts, batch->meshCapacity * sizeof(int));
+        batch->offsets = MemRealloc(batch->offsets, batch->meshCapacity * sizeof(int));
+        batch->levels = MemRealloc(batch->levels, batch->meshCapacity * sizeof(int));
+    }
+    if (itemCount > batch->transformCapacity)
+    {
+        batch->transformCapacity = itemCount;
+        batch->transforms = MemRealloc(batch->transforms, batch->transformCapacity * sizeof(Matrix));
+        batch->instanceData = MemRealloc(batch->instanceData, batch->transformCapacity * sizeof(float16));
+    }
+
+    memset(batch->counts, 0, model->meshCount * sizeof(int));
+    for (int n = 0; n < itemCount; n++)
+    {
+        int source = info->instanceSource[items[n].meshIndex];
+        if (source < 0) continue;
+        // items are sorted front to back
+        if (batch->counts[source]++ == 0) batch->levels[source] = SelectMeshLod(model, info, &items[n]);
+    }
+    int offset = 0;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        batch->offsets[i] = offset;
+        offset += batch->counts[i];
+        batch->counts[i] = 0;
+    }
+    for (int n = 0; n < itemCount; n++)
+    {
+        int i = items[n].meshIndex;
+        int source = info->instanceSource[i];
+        if (source < 0) continue;
+        Matrix dequantize;
+        ModelImport_getLodMesh(info, source, batch->levels[source], &dequantize);
+        Matrix transform = MatrixMultiply(info->instanceTransform[i], model->transform);
+        batch->transforms[batch->offsets[source] + batch->counts[source]++] = MatrixMultiply(dequantize, transform);
+    }
+
+    for (int n = 0; n < itemCount; n++)
+    {
+        int source = info->instanceSource[items[n].meshIndex];
+        if (source < 0 || batch->counts[source] == 0) continue;
+        Material material = model->materials[model->meshMaterial[source]];
+        int count = batch->counts[source];
+        Matrix *transforms = &batch->transforms[batch->offsets[source]];
+        batch->counts[source] = 0;
+        Matrix dequantize;
+        Mesh mesh = ModelImport_getLodMesh(info, source, batch->levels[source], &dequantize);
+        DrawList_countTriangles(mesh.triangleCount * count, model->meshes[source].triangleCount * count);
+        Shader instancedShader = { 0 };
+        if (count > 1 && material.shader.id != _defaultShader.id)
+        {
+            int features = DITHER_FEATURE_INSTANCED | (info->ditherBaked ? DITHER_FEATURE_BAKED : 0);
+            instancedShader = ShaderVariantSet_get(&_ditherShaders, features)->shader;
+        }
+        if (instancedShader.id == 0 || !CanDrawInstances(mesh, instancedShader))
+        {
+            // raylib's default shader has no instancing support; without vertex arrays the
+            // copies are drawn one by one rather than through the allocating DrawMeshInstanced
+            for (int k = 0; k < count; k++)
+            {
+                DrawMesh(mesh, material, transforms[k]);
+                DrawList_countDrawCall(1);
+            }
+            continue;
+        }
+        material.shader = instancedShader;
+        DrawMeshInstances(mesh, material, transforms, count);
+        DrawList_countDrawCall(count);
+    }
+}
+
+static Image LoadSoftRasterTexture(int slot, int material)
+{
+    if (_sceneModelIsBundled[slot]) return Bundle_loadMaterialImage(_sceneModelFiles[slot], material);
+    // raylib's default texture samples as white without any data
+    Texture2D texture = _sceneModels[slot]->materials[material].maps[MATERIAL_MAP_DIFFUSE].texture;
+    if (texture.id == rlGetTextureIdDefault()) return (Image){0};
+    Image image = LoadImage(_sceneTextureFiles[slot]);
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    return image;
+}
+
+static Image GetSoftRasterTexture(const Model *model, int material)
+{
+    int slot = 0;
+    while (slot < SCENE_MODEL_COUNT && _sceneModels[slot] != model) slot++;
+    if (slot == SCENE_MODEL_COUNT) return (Image){0};
+    if (_softRasterTextures[slot] == NULL)
+    {
+        AllocTrack_allowFrame("soft raster textures");
+        _softRasterTextures[slot] = MemAlloc(model->materialCount * sizeof(Image));
+        for (int i = 0; i < model->materialCount; i++) _softRasterTextures[slot][i] = LoadSoftRasterTexture(slot, i);
+    }
+    return _softRasterTextures[slot][material];
+}
+
+static void FreeSoftRasterTextures()
+{
+    for (int k = 0; k < SCENE_MODEL_COUNT; k++)
+    {
+        if (_softRasterTextures[k] == NULL) continue;
+        for (int i = 0; i < _sceneModels[k]->materialCount; i++) UnloadImage(_softRasterTextures[k][i]);
+        MemFree(_softRasterTextures[k]);
+        _softRasterTextures[k] = NULL;
+    }
+}
+
+// draws the meshes of the model that are inside the camera frustum front to back,
+// with the GPU or, in soft raster mode, with the fragment hook matching the shader
+// assigned to each material
+static void DrawSceneModel(Model *model)
+{
+    ModelImportInfo *info = ModelImport_getInfo(model);
+    if (_pass.viewport >= 0)
+    {
+        // culled for all viewports at once
+        DrawList_addModelForView(_pass.viewport, model, info ? info->meshBounds : NULL);
+    }
+    else
+    {
+        // picking only looks at the main scene
+        for (int k = 0; k < SCENE_MODEL_COUNT; k++)
+        {
+            if (_sceneModels[k] == model) _drawnModelMask |= 1 << k;
+        }
+        DrawList_begin(_pass.camera, _pass.width / _pass.height);
+        DrawList_addModel(model, info ? info->meshBounds : NULL);
+        DrawList_end();
+    }
+
+    const DrawListItem *items = DrawList_getItems();
+    int instanced = !_useSoftRaster && info && info->instanceGroupCount > 0;
+    for (int n = 0; n < DrawList_getCount(); n++)
+    {
+        int i = items[n].meshIndex;
+        Material *material = &model->materials[model->meshMaterial[i]];
+        if (instanced && info->instanceSource[i] >= 0) continue;
+        Mesh mesh = model->meshes[i];
+        Matrix dequantize = MatrixIdentity();
+        if (info) mesh = ModelImport_getLodMesh(info, i, SelectMeshLod(model, info, &items[n]), &dequantize);
+        DrawList_countTriangles(mesh.triangleCount, model->meshes[i].triangleCount);
+        if (!_useSoftRaster)
+        {
+            // the GPU copy of the mesh stores quantized positions, see MeshOpt_uploadCompact
+            DrawMesh(mesh, *material, MatrixMultiply(dequantize, model->transform));
+            DrawList_countDrawCall(1);
+            continue;
+        }
+
+        int isDefaultShader = material->shader.id == _defaultShader.id;
+        SoftRasterMaterial softMaterial = {
+            .fragment = isDefaultShader ? SoftRaster_unlitFragment : SoftRaster_ditherFragment,
+            .texture = GetSoftRasterTexture(model, model->meshMaterial[i]),
+            .diffuse = material->maps[MATERIAL_MAP_DIFFUSE].color,
+            .time = isDefaultShader ? 0.0f : (float)GetGameTime(),
+            .ditherBaked = !isDefaultShader && info && info->ditherBaked,
+        };
+        // the CPU arrays are not quantized
+        SoftRaster_drawMesh(mesh, &softMaterial, model->transform);
+    }
+    if (instanced) DrawInstancedMeshes(model, info, items, DrawList_getCount());
+}
+
+void DrawDitheredScene(void *data)
+{
+    float clockTime = GetGameTime();
+    ShaderVariantSet_setValue(&_ditherShaders, "time", &clockTime, SHADER_UNIFORM_FLOAT);
+
+    DrawSceneModel(&_model);
+    _postProcessor = ShaderVariantSet_get(&_outlineShaders, OUTLINE_FEATURE_DEPTH | OUTLINE_FEATURE_UV);
+}
+
+typedef struct OutlineSceneConfig {
+    Model *model;
+    int drawDepthOutlineMode;
+    int drawUvOutlineMode;
+} OutlineSceneConfig;
+
+void DrawOutlinedScene(void *data)
+{
+    OutlineSceneConfig *config = (OutlineSceneConfig*)data;
+    Model *model = config->model;
+    // blinking starts in phase with the step
+    int blink = fmodf(Script_getStepTime(), 1.0f) > 0.5f;
+    // blinking switches between variants instead of toggling uniforms
+    int features = 0;
+    if ((blink && config->drawDepthOutlineMode == 1) || config->drawDepthOutlineMode > 1) features |= OUTLINE_FEATURE_DEPTH;
+    if ((blink && config->drawUvOutlineMode == 1) || config->drawUvOutlineMode > 1) features |= OUTLINE_FEATURE_UV;
+
+    model->materials[1].shader = GetDitherShader(model);
+    DrawSceneModel(model);
+    _postProcessor = ShaderVariantSet_get(&_outlineShaders, features);
+}
+
+void DrawSimpleScene(void *data)
+{
+    Model *model = (Model*)data;
+    model->materials[1].shader = _defaultShader;
+    DrawSceneModel(model);
+    _postProcessor = NULL;
+}
+
+static void *NewOutlineSceneData(Model *model, int drawDepthOutlineMode, int drawUvOutlineMode)
+{
+    return pool_alloc(sizeof(OutlineSceneConfig), &(OutlineSceneConfig){
+        .model = model,
+        .drawDepthOutlineMode = drawDepthOutlineMode,
+        .drawUvOutlineMode = drawUvOutlineMode,
+    });
+}
+
+static const ScriptSceneBinding _sceneBindings[] = {
+    { "dithered", DrawDitheredScene, NULL },
+    { "simple", DrawSimpleScene, NULL },
+    { "outlined", DrawOutlinedScene, NewOutlineSceneData },
+};
+
+// a script from the bundle is a deployed one and is not reloaded; only the hot reload
+// build reads the file instead while it exists
+static int IsScriptBundled(const char *fileName)
+{
+#if defined(SCRIPT_PREFERS_FILE)
+    if (FileExists(fileName)) return 0;
+#endif
+    return Bundle_contains(fileName);
+}
+
+// builds the script from a file; on failure the current script is kept
+static int LoadScript(const char *fileName)
+{
+    double start = GetTime();
+    Script script = { .currentActionId = _script.currentActionId };
+    ScriptProgram *program = ScriptFile_load(&script.arena, fileName, IsScriptBundled(fileName));
+    if (program == NULL)
+    {
+        Script_free(&script);
+        return 0;
+    }
+
+    ScriptBindings bindings = {
+        .scenes = _sceneBindings,
+        .sceneCount = sizeof(_sceneBindings) / sizeof(_sceneBindings[0]),
+        .modelNames = _sceneModelNames,
+        .models = _sceneModels,
+        .modelCount = SCENE_MODEL_COUNT,
+        .textureNames = (const char*[]){ "sceneTexture" },
+        .textures = (Texture2D*[]){ &_sceneTexture },
+        .textureCount = 1,
+    };
+    _allocationArena = &script.arena;
+    int linked = ScriptFile_link(&script, program, &bindings);
+    _allocationArena = &_script.arena;
+    if (!linked)
+    {
+        Script_free(&script);
+        return 0;
+    }
+
+    Script_buildSteps(&script);
+    // step changes only draw the placed glyphs
+    ScriptActions_layoutTextRects(&script);
+    // tweens of panels write into the old script's arena, they end before it is freed
+    Tween_stopAll(1);
+    Script_free(&_script);
+    _script = script;
+    Script_seek(_script.currentActionId);
+    _scriptFileName = fileName;
+    _scriptModTime = GetFileModTime(fileName);
+    TraceLog(LOG_INFO, "Script: loaded %s: %d steps, %d actions, %.1f KB in %.2f ms", fileName, _script.stepCount,
+        _script.actionCount, _script.arena.used / 1024.0, (GetTime() - start) * 1000.0);
+    return 1;
+}
+
+static void UpdateScriptReload()
+{
+    if (_scriptFileName == NULL || IsScriptBundled(_scriptFileName) || GetTime() < _scriptNextReloadCheck) return;
+    _scriptNextReloadCheck = GetTime() + SCRIPT_RELOAD_INTERVAL;
+    long modTime = GetFileModTime(_scriptFileName);
+    if (modTime != _scriptModTime)
+    {
+        _scriptModTime = modTime;
+        AllocTrack_allowFrame("script reload");
+        LoadScript(_scriptFileName);
+    }
+}
+
+// resources come from the bundle when it has them, otherwise from the individual files;
+// a corrupt bundle entry loads as empty and falls back to the file. Returns 1 for the bundle.
+static int LoadSceneModel(Model *model, const char *fileName)
+{
+    if (Bundle_contains(fileName))
+    {
+        int ditherBaked = 0;
+        *model = Bundle_loadModel(fileName, &ditherBaked);
+        if (model->meshCount > 0)
+        {
+            ModelImport_register(model, GetFileName(fileName), ditherBaked);
+            return 1;
+        }
+    }
+    *model = LoadModel(fileName);
+    ModelImport_process(model, GetFileName(fileName));
+    return 0;
+}
+
+static Font LoadGameFont(const char *fileName)
+{
+    Font font = Bundle_contains(fileName) ? Bundle_loadFont(fileName) : (Font){0};
+    return font.glyphCount > 0 ? font : LoadFont(fileName);
+}
+
+static void LoadShaderVariants(ShaderVariantSet *set, const char *name, const char *vsFileName, const char *fsFileName,
+    const char **features, int featureCount)
+{
+    const char *vsCode = vsFileName ? Bundle_getText(vsFileName) : NULL;
+    const char *fsCode = Bundle_getText(fsFileName);
+    if (fsCode && (vsFileName == NULL || vsCode))
+    {
+        ShaderVariantSet_loadFromMemory(set, name, vsCode, fsCode, features, featureCount);
+    }
+    else
+    {
+        ShaderVariantSet_load(set, name, vsFileName, fsFileName, features, featureCount);
+    }
+}
+
+void Game_init(void** contextData)
+{
+    if (*contextData == NULL)
+    {
+        *contextData = MemAlloc(sizeof(ContextData));
+    }
+    _contextData = *contextData;
+    FramePacer_setTargetFps(TARGET_FPS);
+#if defined(GAME_ALLOC_STEADY_FRAMES)
+    AllocTrack_setSteadyState(GAME_ALLOC_STEADY_FRAMES);
+#endif
+
+    printf("Game_init\n");
+    
+    double loadStart = GetTime();
+    Bundle_open(BUNDLE_FILE);
+    for (int k = 0; k < SCENE_MODEL_COUNT; k++)
+    {
+        _sceneModelIsBundled[k] = LoadSceneModel(_sceneModels[k], _sceneModelFiles[k]);
+    }
+
+    LoadShaderVariants(&_ditherShaders, "dither", "resources/dither.vs", "resources/dither.fs",
+        (const char*[]){"DITHER_BAKED", "DITHER_INSTANCED", "DITHER_OBJECT_ID"}, 3);
+    LoadShaderVariants(&_outlineShaders, "outline", NULL, "resources/outline.fs",
+        (const char*[]){"OUTLINE_DEPTH", "OUTLINE_UV"}, 2);
+    ShaderVariantSet_precompile(&_ditherShaders);
+    ShaderVariantSet_precompile(&_outlineShaders);
+    LoadShaderVariants(&_sdfTextShaders, "sdf text", NULL, "resources/sdf_text.fs", NULL, 0);
+    SdfFont_setShader(ShaderVariantSet_get(&_sdfTextShaders, 0)->shader);
+    SetupInstancedDitherShaders();
+    _defaultShader = _model.materials[0].shader;
+    _model.materials[0].shader = GetDitherShader(&_model);
+    _model.materials[1].shader = GetDitherShader(&_model);
+
+    // one atlas for the text at every scale, see SetTextBoxScale
+    Font fntMedium = LoadGameFont("resources/fnt_medium.png");
+    _fntMedium = SdfFont_generate(fntMedium);
+    if (SdfFont_isSdf(_fntMedium)) UnloadFont(fntMedium);
+    _fntMono = LoadGameFont("resources/fnt_mymono.png");
+
+    UpdateRenderTexture();
+    Picking_reset();
+
+    SetTextLineSpacingEx(-6);
+
+    // the text form is used when available so edits show up without a rebuild
+    _script.currentActionId = _contextData->step;
+    if (!LoadScript(Bundle_contains(SCRIPT_FILE) || FileExists(SCRIPT_FILE) ? SCRIPT_FILE : SCRIPT_BINARY_FILE))
+    {
+        TraceLog(LOG_ERROR, "Game_init: no tutorial script could be loaded");
+    }
+    // cold start cost of the resources, compare with and without resources/game.bundle
+    TraceLog(LOG_INFO, "Game_init: resources ready in %.2f ms (%s)", (GetTime() - loadStart) * 1000.0,
+        Bundle_isOpen() ? "bundle" : "files");
+}
+
+void Game_deinit()
+{
+    printf("Game_deinit\n");
+    FreeSoftRasterTextures();
+    Bundle_unloadModel(_model);
+    Bundle_unloadModel(_sampleObjects);
+    Bundle_unloadModel(_flatVectorScene);
+    Bundle_unloadModel(_flatVectorSceneOutlines);
+    ShaderVariantSet_logStats(&_outlineShaders);
+    ShaderVariantSet_unload(&_ditherShaders);
+    ShaderVariantSet_unload(&_outlineShaders);
+    SdfFont_setShader((Shader){0});
+    ShaderVariantSet_unload(&_sdfTextShaders);
+    _postProcessor = NULL;
+    ModelImport_clear();
+    Script_free(&_script);
+    _scriptFileName = NULL;
+    SoftRaster_shutdown();
+    DrawList_unload();
+    Jobs_shutdown();
+    Tween_unload();
+    Replay_unload();
+    // a reload in the middle of an export keeps what was rendered so far
+    Export_end();
+    _exportRun = (ExportRun){0};
+    Readback_unload();
+    Picking_reset();
+    AllocTrack_logSites();
+    RenderTargetPool_release(_pickTarget);
+    _pickTarget = (RenderTexture2D){0};
+    MemFree(_instanceBatch.counts);
+    MemFree(_instanceBatch.offsets);
+    MemFree(_instanceBatch.levels);
+    MemFree(_instanceBatch.transforms);
+    MemFree(_instanceBatch.instanceData);
+    UnloadInstanceBuffers();
+    _instanceBatch = (InstanceBatch){0};
+    MemFree(_stepBenchmark.frameTimes);
+    _stepBenchmark = (StepBenchmark){0};
+    RenderTargetPool_release(_target);
+    RenderTargetPool_release(_postTarget);
+    _postTarget = (RenderTexture2D){0};
+    _sceneTexture = (Texture2D){0};
+    RenderTargetPool_release(_uiLayer.target);
+    _uiLayer = (UiLayer){ .isDirty = 1 };
+    RenderTargetPool_release(_viewports.target);
+    RenderTargetPool_release(_viewports.postTarget);
+    _viewports = (ViewportSet){0};
+    RenderTargetPool_unloadAll();
+    _target = (RenderTexture2D){0};
+    SdfFont_unload(_fntMedium);
+    UnloadFont(_fntMono);
+    Bundle_close();
+}
+
+void DrawScene()
+{
+    if (_DrawSceneFn)
+    {
+        _DrawSceneFn(_drawSceneData);
+    }
+}
+
+int AddViewport(Viewport viewport)
+{
+    if (_viewports.count == VIEWPORT_MAX) return 0;
+    _viewports.viewports[_viewports.count++] = viewport;
+    return 1;
+}
+
+void ClearViewports()
+{
+    _viewports.count = 0;
+}
+
+static Camera3D GetViewportCamera(const Viewport *viewport)
+{
+    if (!viewport->followsOrbit) return viewport->camera;
+    // turned about the vertical axis like the orbit's yaw
+    Camera3D camera = _camera;
+    Vector3 offset = Vector3Subtract(camera.position, camera.target);
+    float c = cosf(viewport->orbitYaw), s = sinf(viewport->orbitYaw);
+    camera.position = Vector3Add(camera.target, (Vector3){ offset.x * c + offset.z * s, offset.y, offset.z * c - offset.x * s });
+    return camera;
+}
+
+// slots at the render scale of each viewport in shelves as wide as the screen; returns
+// the size of the targets
+static Vector2 PackViewports()
+{
+    int rowWidth = GetScreenWidth();
+    int x = 0, y = 0, shelfHeight = 0, width = 1;
+    for (int i = 0; i < _viewports.count; i++)
+    {
+        const Viewport *viewport = &_viewports.viewports[i];
+        int scale = viewport->renderScale > 0 ? viewport->renderScale : _renderScale;
+        int w = (int)viewport->rect.width / scale;
+        int h = (int)viewport->rect.height / scale;
+        if (w < 1) w = 1;
+        if (h < 1) h = 1;
+        if (x > 0 && x + w > rowWidth)
+        {
+            x = 0;
+            y += shelfHeight + VIEWPORT_GUTTER;
+            shelfHeight = 0;
+        }
+        _viewports.slots[i] = (Rectangle){ (float)x, (float)y, (float)w, (float)h };
+        if (x + w > width) width = x + w;
+        if (h > shelfHeight) shelfHeight = h;
+        x += w + VIEWPORT_GUTTER;
+    }
+    return (Vector2){ (float)width, (float)(y + shelfHeight) };
+}
+
+static int IsSameViewportScene(int a, int b)
+{
+    const Viewport *viewportA = &_viewports.viewports[a];
+    const Viewport *viewportB = &_viewports.viewports[b];
+    return viewportA->drawSceneFn == viewportB->drawSceneFn && viewportA->drawSceneData == viewportB->drawSceneData;
+}
+
+static int IsSameViewportPostProcessor(int a, int b)
+{
+    return _viewports.postProcessors[a] == _viewports.postProcessors[b];
+}
+
+// viewport indices with the equal ones next to each other, in the order of their first
+static void GroupViewports(int *order, int (*isSame)(int a, int b))
+{
+    int count = 0;
+    int isPlaced[VIEWPORT_MAX] = { 0 };
+    for (int i = 0; i < _viewports.count; i++)
+    {
+        if (isPlaced[i]) continue;
+        for (int j = i; j < _viewports.count; j++)
+        {
+            if (isPlaced[j] || (j != i && !isSame(i, j))) continue;
+            isPlaced[j] = 1;
+            order[count++] = j;
+        }
+    }
+}
+
+// Draws the scenes of all viewports into the slots of one target, with one clear and
+// the viewports of the same scene one after the other, then post processes the slots
+// into the second target in one batch per post processor.
+static void RenderViewports()
+{
+    if (_viewports.count == 0 || _useSoftRaster) return;
+    double start = GetTime();
+    Vector2 size = PackViewports();
+    int width = (int)size.x, height = (int)size.y;
+    if (width != _viewports.target.texture.width || height != _viewports.target.texture.height)
+    {
+        AllocTrack_allowFrame("viewport target resize");
+        RenderTargetPool_release(_viewports.target);
+        RenderTargetPool_release(_viewports.postTarget);
+        _viewports.target = RenderTargetPool_acquire(width, height);
+        _viewports.postTarget = RenderTargetPool_acquire(width, height);
+    }
+
+    Camera3D cameras[VIEWPORT_MAX];
+    float aspects[VIEWPORT_MAX];
+    for (int i = 0; i < _viewports.count; i++)
+    {
+        cameras[i] = GetViewportCamera(&_viewports.viewports[i]);
+        aspects[i] = _viewports.slots[i].width / _viewports.slots[i].height;
+    }
+    ScenePass mainPass = _pass;
+    ShaderVariant *mainPostProcessor = _postProcessor;
+    int order[VIEWPORT_MAX];
+    GroupViewports(order, IsSameViewportScene);
+
+    BeginTextureMode(_viewports.target);
+    ClearBackground(WHITE);
+    rlDisableColorBlend();
+    DrawList_beginViews(cameras, aspects, _viewports.count);
+    for (int n = 0; n < _viewports.count; n++)
+    {
+        int i = order[n];
+        const Viewport *viewport = &_viewports.viewports[i];
+        Rectangle slot = _viewports.slots[i];
+        _pass = (ScenePass){ cameras[i], slot.width, slot.height, i };
+        _postProcessor = NULL;
+        BeginMode3D(cameras[i]);
+        // BeginMode3D takes the aspect of the whole target
+        rlMatrixMode(RL_PROJECTION);
+        rlLoadIdentity();
+        rlMultMatrixf(MatrixToFloat(Frustum_getProjection(cameras[i], aspects[i])));
+        rlMatrixMode(RL_MODELVIEW);
+        rlViewport((int)slot.x, (int)slot.y, (int)slot.width, (int)slot.height);
+        if (viewport->drawSceneFn) viewport->drawSceneFn(viewport->drawSceneData);
+        EndMode3D();
+        _viewports.postProcessors[i] = _postProcessor;
+    }
+    DrawList_endViews();
+    EndTextureMode();
+
+    // raylib batches the quads of consecutive slots with the same shader into one draw call
+    GroupViewports(order, IsSameViewportPostProcessor);
+    BeginTextureMode(_viewports.postTarget);
+    rlDisableColorBlend();
+    for (int n = 0; n < _viewports.count; n++)
+    {
+        int i = order[n];
+        ShaderVariant *postProcessor = _viewports.postProcessors[i];
+        int isFirst = n == 0 || !IsSameViewportPostProcessor(order[n - 1], i);
+        if (isFirst && postProcessor)
+        {
+            SetShaderValue(postProcessor->shader, GetShaderLocation(postProcessor->shader, "resolution"),
+                (float[2]){ (float)width, (float)height }, SHADER_UNIFORM_VEC2);
+            BeginShaderMode(postProcessor->shader);
+        }
+        Rectangle slot = _viewports.slots[i];
+        DrawTexturePro(_viewports.target.texture, (Rectangle){ slot.x, slot.y, slot.width, -slot.height },
+            (Rectangle){ slot.x, height - slot.y - slot.height, slot.width, slot.height }, (Vector2){ 0.0f, 0.0f }, 0.0f,
+            WHITE);
+        int isLast = n == _viewports.count - 1 || !IsSameViewportPostProcessor(order[n + 1], i);
+        if (isLast && postProcessor) EndShaderMode();
+    }
+    EndTextureMode();
+    rlEnableColorBlend();
+
+    _pass = mainPass;
+    _postProcessor = mainPostProcessor;
+    _viewports.renderMs = (float)((GetTime() - start) * 1000.0);
+}
+
+// composites the viewports onto the screen, all slots with one draw call
+static void DrawViewports()
+{
+    if (_viewports.count == 0 || _useSoftRaster || _viewports.postTarget.id == 0) return;
+    for (int i = 0; i < _viewports.count; i++)
+    {
+        Rectangle slot = _viewports.slots[i];
+        DrawTexturePro(_viewports.postTarget.texture, (Rectangle){ slot.x, slot.y, slot.width, -slot.height },
+            _viewports.viewports[i].rect, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+    }
+    // the frames after all quads, so that those stay in one batch
+    for (int i = 0; i < _viewports.count; i++) DrawRectangleLinesEx(_viewports.viewports[i].rect, 1.0f, BLACK);
+}
+
+#define DEBUG_OVERLAY_MAX_LINES 16
+#define LATENCY_HISTOGRAM_HEIGHT 32
+
+// one bar per millisecond of input latency, scaled to the fullest bucket, above the overlay at bottom
+static void DrawLatencyHistogram(const FramePacerStats *stats, int x, int bottom)
 {
-    _script.actionCount = 0;
-    _script.currentActionId = 0;
+    if (stats->latencySamples == 0) return;
+    int maxCount = 1;
+    for (int i = 0; i < FRAMEPACER_HISTOGRAM_BUCKETS; i++)
+    {
+        if (stats->latencyHistogram[i] > maxCount) maxCount = stats->latencyHistogram[i];
+    }
+    int barWidth = 360 / FRAMEPACER_HISTOGRAM_BUCKETS;
+    DrawRectangle(x, bottom - LATENCY_HISTOGRAM_HEIGHT - 4, 360, LATENCY_HISTOGRAM_HEIGHT + 4, Fade(WHITE, 0.85f));
+    for (int i = 0; i < FRAMEPACER_HISTOGRAM_BUCKETS; i++)
+    {
+        int height = stats->latencyHistogram[i] * LATENCY_HISTOGRAM_HEIGHT / maxCount;
+        if (stats->latencyHistogram[i] > 0 && height == 0) height = 1;
+        // a bar every 10 ms is darker to read the scale off
+        DrawRectangle(x + i * barWidth + 1, bottom - height, barWidth - 1, height, (i % 10) == 9 ? DARKGRAY : GRAY);
+    }
 }
 
-void Script_addAction(ScriptAction action)
+static void DrawDebugOverlay()
 {
-    if (SCRIPT_MAX_ACTIONS == _script.actionCount)
+    char lines[DEBUG_OVERLAY_MAX_LINES][96];
+    int lineCount = 0;
+    FramePacerStats pacerStats = FramePacer_getStats();
+    snprintf(lines[lineCount++], sizeof(lines[0]), "fps %d, frame %.2f ms, average %.2f ms",
+        pacerStats.averageFrameMs > 0.0f ? (int)(1000.0f / pacerStats.averageFrameMs + 0.5f) : 0,
+        FramePacer_getFrameTime() * 1000.0f, pacerStats.averageFrameMs);
+    if (pacerStats.isPacing) snprintf(lines[lineCount++], sizeof(lines[0]),
+        "pacing %d%s: jitter %.2f ms, sleep %.2f + spin %.2f ms", pacerStats.targetFps, pacerStats.isVsync ? " vsync" : "",
+        pacerStats.jitterMs, pacerStats.lastSleepMs, pacerStats.lastSpinMs);
+    else snprintf(lines[lineCount++], sizeof(lines[0]), "pacing %d%s by raylib: jitter %.2f ms", pacerStats.targetFps,
+        pacerStats.isVsync ? " vsync" : "", pacerStats.jitterMs);
+    snprintf(lines[lineCount++], sizeof(lines[0]), "input latency %.1f ms, p50 %.0f, p95 %.0f, p99 %.0f ms",
+        pacerStats.lastLatencyMs, FramePacer_getLatencyPercentile(0.5f), FramePacer_getLatencyPercentile(0.95f),
+        FramePacer_getLatencyPercentile(0.99f));
+    snprintf(lines[lineCount++], sizeof(lines[0]), "render scale 1/%d%s, target %dx%d, pooled %d", GetRenderScale(),
+        IsDynamicResolutionEnabled() ? " (dynamic)" : "", _target.texture.width, _target.texture.height,
+        RenderTargetPool_getLoadedCount());
+    snprintf(lines[lineCount++], sizeof(lines[0]), "ui layer: %d redraws", _uiLayer.redrawCount);
+    if (_postProcessor)
     {
-        TraceLog(LOG_ERROR, "Script_addAction: script action count exceeded");
-        return;
+        snprintf(lines[lineCount++], sizeof(lines[0]), "post: outline [%s] %.3f ms %s",
+            ShaderVariantSet_getVariantName(&_outlineShaders, _postProcessor->featureMask), _postProcessor->timingLastMs,
+            _postProcessor->timingIsGpu ? "GPU" : "CPU submit");
+    }
+    else
+    {
+        snprintf(lines[lineCount++], sizeof(lines[0]), "post: none");
     }
 
-    // default init, if no end, assume length 1
-    if (action.actionIdEnd < action.actionIdStart)
+    DrawListStats drawStats = DrawList_getStats();
+    snprintf(lines[lineCount++], sizeof(lines[0]), "meshes: %d submitted, %d culled", drawStats.meshesSubmitted,
+        drawStats.meshesCulled);
+    snprintf(lines[lineCount++], sizeof(lines[0]), "draw calls: %d, %d meshes instanced", drawStats.drawCalls,
+        drawStats.instancesDrawn);
+    snprintf(lines[lineCount++], sizeof(lines[0]), "triangles: %d, %d saved by LOD%s", drawStats.trianglesDrawn,
+        drawStats.trianglesSaved, _useLods ? "" : " (off, F4)");
+    ReadbackStats readbackStats = Readback_getStats();
+    if (readbackStats.requests > 0)
     {
-        action.actionIdEnd = action.actionIdStart;
+        snprintf(lines[lineCount++], sizeof(lines[0]), "readback (%s): stall %.3f ms, max %.3f ms, %d frames",
+            Readback_isAsync() ? "async" : "sync", readbackStats.lastStallMs, readbackStats.maxStallMs,
+            readbackStats.lastLatencyFrames);
+    }
+    PickingStats pickStats = Picking_getStats();
+    if (pickStats.requests > 0)
+    {
+        PickResult hover = Picking_getHover();
+        int meshIndex = 0;
+        Model *model = GetPickedMesh(hover.objectId, &meshIndex);
+        if (!hover.hit) snprintf(lines[lineCount++], sizeof(lines[0]), "pick: background");
+        else if (model) snprintf(lines[lineCount++], sizeof(lines[0]), "pick: %s mesh %d, depth %.2f, uv.y %.3f%s",
+            ModelImport_getInfo(model) ? ModelImport_getInfo(model)->name : "?", meshIndex, hover.depth, hover.uvY,
+            hover.isFx ? " (fx)" : "");
+        else snprintf(lines[lineCount++], sizeof(lines[0]), "pick: depth %.2f, uv.y %.3f%s%s", hover.depth, hover.uvY,
+            hover.isFx ? " (fx)" : "", _usePickIds ? "" : ", ids off (F1)");
+        snprintf(lines[lineCount++], sizeof(lines[0]), "  cost %.3f ms, max %.3f ms, id pass %.3f ms",
+            pickStats.lastCostMs, pickStats.maxCostMs, _usePickIds ? _pickIdMs : 0.0f);
+    }
+    if (AllocTrack_isEnabled())
+    {
+        AllocTrackStats allocStats = AllocTrack_getStats();
+        snprintf(lines[lineCount++], sizeof(lines[0]), "alloc: %d last frame, %.1f KB, %d arena; %d of %d frames",
+            allocStats.lastFrameAllocations, allocStats.lastFrameBytes / 1024.0, allocStats.lastFrameArenaAllocations,
+            allocStats.allocatingFrames, allocStats.frame);
+    }
+    if (_useSoftRaster)
+    {
+        SoftRasterStats stats = SoftRaster_getStats();
+        snprintf(lines[lineCount++], sizeof(lines[0]), "soft raster: %d/%d tris, %d px, %d threads",
+            stats.trianglesRasterized, stats.trianglesSubmitted, stats.pixelsShaded, Jobs_getThreadCount());
+        snprintf(lines[lineCount++], sizeof(lines[0]), "  setup %.2f ms, raster %.2f ms (%d tiles), outline %.2f ms",
+            stats.setupMs, stats.rasterMs, stats.tileCount, stats.outlineMs);
+    }
+    else if (_viewports.count > 0)
+    {
+        snprintf(lines[lineCount++], sizeof(lines[0]), "viewports: %d in %.2f ms, target %dx%d, %d bounds culled",
+            _viewports.count, _viewports.renderMs, _viewports.target.texture.width, _viewports.target.texture.height,
+            drawStats.viewBoundsTransformed);
     }
 
-    _script.actions[_script.actionCount++] = action;
+    float fontSize = _fntMono.baseSize;
+    int lineHeight = (int)fontSize + 2;
+    int y = GetScreenHeight() - 8 - lineCount * lineHeight;
+    DrawRectangle(4, y - 4, 360, lineCount * lineHeight + 8, Fade(WHITE, 0.85f));
+    for (int i = 0; i < lineCount; i++)
+    {
+        DrawTextEx(_fntMono, lines[i], (Vector2){8, y + i * lineHeight}, fontSize, 0.0f, BLACK);
+    }
+    DrawLatencyHistogram(&pacerStats, 4, y - 4);
 }
 
-// actions
-
-
+static void RenderSoftScene()
+{
+    SoftRaster_begin(_target.texture.width, _target.texture.height, WHITE);
+    SoftRaster_setCamera(_camera);
+    DrawScene();
+    SoftRaster_end();
+}
 
-void Script_update()
+// renders the current scene repeatedly with the CPU rasterizer and logs its throughput
+static void RunSoftRasterBenchmark()
 {
-    _script.nextActionId = _script.currentActionId;
-    for (int i = 0; i < _script.actionCount; i++) 
+    const int frameCount = 30;
+    int useSoftRaster = _useSoftRaster;
+    _useSoftRaster = 1;
+    double triangles = 0.0;
+    double pixels = 0.0;
+    double start = GetTime();
+    for (int i = 0; i < frameCount; i++)
     {
-        ScriptAction *action = &_script.actions[i];
-        if (_script.currentActionId >= action->actionIdStart && _script.currentActionId <= action->actionIdEnd)
-        {
-            action->action(&_script, action);
-        }
+        RenderSoftScene();
+        SoftRasterStats stats = SoftRaster_getStats();
+        triangles += stats.trianglesSubmitted;
+        pixels += stats.pixelsShaded;
     }
-    _script.currentActionId = _script.nextActionId;
-    _contextData->step = _script.currentActionId;
+    double seconds = GetTime() - start;
+    _useSoftRaster = useSoftRaster;
+    TraceLog(LOG_INFO, "soft raster benchmark: %dx%d, %d threads, %d frames in %.3f s", _target.texture.width,
+        _target.texture.height, Jobs_getThreadCount(), frameCount, seconds);
+    TraceLog(LOG_INFO, "    %.2f Mtriangles/s, %.2f Mpixels/s, %.2f ms/frame", triangles / seconds / 1e6,
+        pixels / seconds / 1e6, seconds * 1000.0 / frameCount);
 }
 
-void UpdateRenderTexture()
+static ReplayInput ReadCameraInput()
 {
-    int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
-    if ((screenWidth >> 1) != _target.texture.width || (screenHeight >> 1) != _target.texture.height)
+    ReplayInput input = {0};
+    // the export only runs the scripted camera moves
+    if (_exportRun.isRunning) return input;
+    if (Replay_isPlaying())
     {
-        UnloadRenderTexture(_target);
-        _target = LoadRenderTexture(screenWidth>>1, screenHeight>>1);
-        SetTextureFilter(_target.texture, TEXTURE_FILTER_POINT);
-        SetTextureWrap(_target.texture, TEXTURE_WRAP_CLAMP);
+        if (!Replay_next(&input) && !_stepBenchmark.isRunning) TraceLog(LOG_INFO, "Replay: finished");
+        return input;
     }
+    input = (ReplayInput){
+        .mouseDelta = GetMouseDelta(),
+        .wheel = GetMouseWheelMove(),
+        .leftDown = IsMouseButtonDown(MOUSE_LEFT_BUTTON),
+    };
+    Replay_record(input);
+    return input;
 }
 
-
-void DrawDitheredScene(void *data)
+static void ResetOrbitCamera()
 {
-    float clockTime = GetTime();
-    SetShaderValue(_shader, GetShaderLocation(_shader, "time"), &clockTime, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(_outlineShader, GetShaderLocation(_outlineShader, "depthOutlineEnabled"), (float[]){1.0f}, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(_outlineShader, GetShaderLocation(_outlineShader, "uvOutlineEnabled"), (float[]){1.0f}, SHADER_UNIFORM_FLOAT);
-
-    DrawModel(_model, (Vector3){0.0f, 0.0f, 0.0f}, 1.0f, WHITE);
-    _postProcessorShader = &_outlineShader;
+    Tween_stopAll(0);
+    _orbit = (OrbitCamera){ .rotation = {1.0f, -2.5f}, .distance = 5.0f };
 }
 
-typedef struct OutlineSceneConfig {
-    Model *model;
-    int drawDepthOutlineMode;
-    int drawUvOutlineMode;
-} OutlineSceneConfig;
-
-void DrawOutlinedScene(void *data)
+static void StartStepBenchmark()
 {
-    OutlineSceneConfig *config = (OutlineSceneConfig*)data;
-    Model *model = config->model;
-    float clockTime = GetTime();
-    int blink = fmodf(clockTime,1.0f) > 0.5f;
-    SetShaderValue(_outlineShader, GetShaderLocation(_outlineShader, "depthOutlineEnabled"), 
-        (float[]){blink && config->drawDepthOutlineMode == 1 || config->drawDepthOutlineMode > 1 ? 1.0f : 0.0f}, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(_outlineShader, GetShaderLocation(_outlineShader, "uvOutlineEnabled"), 
-        (float[]){blink && config->drawUvOutlineMode == 1 || config->drawUvOutlineMode > 1 ? 1.0f : 0.0f}, SHADER_UNIFORM_FLOAT);
+    if (_stepBenchmark.isRunning || _exportRun.isRunning || _script.stepCount == 0) return;
+    int framesPerStep = STEP_BENCHMARK_FRAMES;
+    if (Replay_play(REPLAY_FILE) && Replay_getFrameCount() > 0) framesPerStep = Replay_getFrameCount();
+    else TraceLog(LOG_INFO, "Step benchmark: no camera path in %s, using a still camera", REPLAY_FILE);
+    Replay_stop();
+
+    _stepBenchmark = (StepBenchmark){
+        .isRunning = 1,
+        .step = -1,
+        .framesPerStep = framesPerStep,
+        .frameTimes = MemRealloc(_stepBenchmark.frameTimes, _script.stepCount * framesPerStep * sizeof(float)),
+    };
+    // frame pacing would hide the cost of the frames
+    FramePacer_setTargetFps(0);
+}
 
-    model->materials[1].shader = _shader;
-    DrawModel(*model, (Vector3){0.0f, 0.0f, 0.0f}, 1.0f, WHITE);
-    _postProcessorShader = &_outlineShader;
+static int CompareFloats(const void *a, const void *b)
+{
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
 }
 
-void DrawSimpleScene(void *data)
+// logs a line of the results and adds it to the report file, if there is one
+static void ReportStepBenchmark(FILE *report, const char *format, ...)
 {
-    Model *model = (Model*)data;
-    model->materials[1].shader = _defaultShader;
-    DrawModel(*model, (Vector3){0.0f, 0.0f, 0.0f}, 1.0f, WHITE);
-    _postProcessorShader = NULL;
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    TraceLog(LOG_INFO, "%s", line);
+    if (report) fprintf(report, "%s\n", line);
 }
 
-void Game_init(void** contextData)
+static void LogStepBenchmark()
 {
-    if (*contextData == NULL)
+    int count = _stepBenchmark.framesPerStep;
+    AllocTrack_allowFrame("step benchmark report");
+    float *sorted = MemAlloc(count * sizeof(float));
+    double total = 0.0;
+    FILE *report = NULL;
+    if (_stepBenchmark.reportFileName[0])
     {
-        *contextData = MemAlloc(sizeof(ContextData));
+        report = fopen(_stepBenchmark.reportFileName, "w");
+        if (report == NULL) TraceLog(LOG_WARNING, "Step benchmark: could not write %s", _stepBenchmark.reportFileName);
     }
-    _contextData = *contextData;
-
-    printf("Game_init\n");
-    
-    
-    _model = LoadModel("resources/polyobjects.glb");
-    _sampleObjects = LoadModel("resources/sampleObjects.glb");
-    _flatVectorScene = LoadModel("resources/flat-vector-scene.glb");
-    _flatVectorSceneOutlines = LoadModel("resources/flat-vector-scene-outlines.glb");
-
-
-    _shader = LoadShader("resources/dither.vs", "resources/dither.fs");
-    _outlineShader = LoadShader(0, "resources/outline.fs");
-    SetShaderValue(_outlineShader, GetShaderLocation(_outlineShader, "depthOutlineEnabled"), (float[]){1.0f}, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(_outlineShader, GetShaderLocation(_outlineShader, "uvOutlineEnabled"), (float[]){1.0f}, SHADER_UNIFORM_FLOAT);
-    _defaultShader = _model.materials[0].shader;
-    _model.materials[0].shader = _shader;
-    _model.materials[1].shader = _shader;
-
-    _fntMedium = LoadFont("resources/fnt_medium.png");
-    _fntMono = LoadFont("resources/fnt_mymono.png");
-
-    UpdateRenderTexture();
-
-    Script_init();
-    SetTextLineSpacingEx(-6);
-    int step = 0;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Dithering & Outlining howto",
-            "This is a tutorial on how dithering and outline rendering can be implemented.\n"
-            "The goal is to show how the principles works - not to provide a production ready efficient implementation.\n"
-            , (Rectangle){20, 20, 280, 200})
-    });
-
-    step += 1;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Dithering & Outlining howto",
-            "Furthermore, this tutorial describes only ONE way to do this.\n"
-            "There are countless other approaches.\n"
-            , (Rectangle){20, 20, 280, 200})
-    });
-
-    step += 1;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Dithering", 
-            "Dithering refers to using a few colors and coloring pixels in a way to emulate more colors.\n"
-            , 
-            (Rectangle){20, 20, 200, 200})
-    });
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .actionIdEnd = step + 1,
-        .action = ScriptAction_drawMagnifiedTexture,
-        .actionData = ScriptAction_DrawMagnifiedTextureData_new(
-            (Rectangle){180, 140, 16, 16},
-            (Rectangle){20, 240, 200, 200},
-            &_target.texture, _outlineShader)
-    });
-
-    step += 1;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Dithering", 
-            "Adapted from print media, it was used when computers were only able to draw images using a limited amount of colors."
-            , 
-            (Rectangle){20, 20, 200, 200})
-    });
-    
-    step += 1;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Dithering", 
-            "In this case, the reproduction of this style was aimed to work with fairly simple "
-            "tricks."
-            , 
-            (Rectangle){20, 20, 200, 200})
-    });
-
-    
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = 0,
-        .actionIdEnd = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawDitheredScene, NULL)
-    });
-
-    step += 1;
-    int simpleSceneStartStep = step;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Pixel art textures", 
-            "Let's start with a simple 3d scene, using a regular textures.\n"
-            "When using a perspective camera, texture scales will vary a lot."
-            , 
-            (Rectangle){20, 20, 200, 220})
-    });
-
-    step += 1;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Pixel art textures", 
-            "This is causing a lot of aliasing when the object is far away,"
-            " and big pixels when the object is closer than it was designed for."
-            , 
-            (Rectangle){20, 20, 200, 200})
-    });
-
-    step += 1;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Pixel art textures", 
-            "This could be tackled using an orthographic camera and carefuly,"
-            "choosing the right texture sizes, but this limits the freedom of the camera."
-            , 
-            (Rectangle){20, 20, 200, 220})
-    });
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = simpleSceneStartStep,
-        .actionIdEnd = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawSimpleScene, &_sampleObjects)
-    });
-
-    step += 1;
-
-    int vectorSceneChapterStart = step;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Flat colored meshes", 
-            "Another approach is to use flat colored meshes.\n"
-            "Each triangle is colored with a single color, producing a style "
-            "that resembles a vector draw style."
-            , 
-            (Rectangle){20, 20, 200, 220})
-    });
-
-    step += 1;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Flat colored meshes", 
-            "This approach uses more is more complex to model.\n"
-            "It scales nicely, but there's still aliasing."
-            , 
-            (Rectangle){20, 20, 200, 220})
-    });
-
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = vectorSceneChapterStart,
-        .actionIdEnd = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawSimpleScene, &_flatVectorScene)
-    });
-
-    step += 1;
-
-    int vectorSceneWithOutlines = step;
+    ReportStepBenchmark(report, "Step benchmark (%s build): %d steps, %d frames each, %dx%d", GAME_BUILD_NAME,
+        _script.stepCount, count, _target.texture.width, _target.texture.height);
+    ReportStepBenchmark(report, "    step     avg      p50      p95      max (ms)");
+    for (int step = 0; step < _script.stepCount; step++)
+    {
+        memcpy(sorted, _stepBenchmark.frameTimes + step * count, count * sizeof(float));
+        qsort(sorted, count, sizeof(float), CompareFloats);
+        double sum = 0.0;
+        for (int i = 0; i < count; i++) sum += sorted[i];
+        total += sum;
+        ReportStepBenchmark(report, "    %4d %8.3f %8.3f %8.3f %8.3f", step, sum / count * 1000.0,
+            sorted[count / 2] * 1000.0f, sorted[(count * 95) / 100] * 1000.0f, sorted[count - 1] * 1000.0f);
+    }
+    ReportStepBenchmark(report, "    all  %8.3f  %s", total / (count * _script.stepCount) * 1000.0, GAME_BUILD_NAME);
+    if (report) fclose(report);
+    MemFree(sorted);
+}
 
-    
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Outlines", 
-            "We need proper outlines that are 1-2 pixel wide.\n"
-            "For that, we need post processing."
-            , 
-            (Rectangle){20, 20, 200, 220})
-    });
+// called at the start of each frame: stores the time of the previous frame and moves
+// on to the next step once the camera path was played through
+static void UpdateStepBenchmark()
+{
+    StepBenchmark *bench = &_stepBenchmark;
+    if (!bench->isRunning) return;
 
-    
-    static OutlineSceneConfig noBlinkingOutlineFlatV = {
-        0
-    };
-    noBlinkingOutlineFlatV.model = &_flatVectorScene;
-    
-    Script_addAction((ScriptAction){
-        .actionIdStart = vectorSceneWithOutlines,
-        .actionIdEnd = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawOutlinedScene, &noBlinkingOutlineFlatV)
-    });
+    double now = GetTime();
+    // the first frame of a step warms up caches and variants and is not counted
+    if (bench->step >= 0 && bench->frame > 0)
+    {
+        bench->frameTimes[bench->step * bench->framesPerStep + bench->frame - 1] = (float)(now - bench->frameStart);
+    }
+    bench->frameStart = now;
 
-    step += 1;
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Outlines", 
-            "In a first step, we create outlines by depth:\n"
-            "When a pixel is sufficiently far distanced from the surrounding pixels, we draw an outline."
-            , 
-            (Rectangle){20, 20, 200, 220})
-    });
+    if (bench->step < 0 || bench->frame++ == bench->framesPerStep)
+    {
+        bench->step++;
+        bench->frame = 0;
+        if (bench->step == _script.stepCount)
+        {
+            bench->isRunning = 0;
+            Replay_stop();
+            FramePacer_setTargetFps(TARGET_FPS);
+            LogStepBenchmark();
+            return;
+        }
+        ResetOrbitCamera();
+        Script_seek(bench->step);
+        Replay_rewind();
+    }
+    // keep the step even if it would advance on its own
+    else if (_script.currentActionId != bench->step)
+    {
+        Script_seek(bench->step);
+    }
+}
 
-    static OutlineSceneConfig blinkingDepthOutlineFlatV = {
-        0
+// Called by the host for --export: steps through the whole script, stepSeconds of game
+// time per step at fps frames per second, without frame pacing, and writes every frame
+// to path (see export.h). The camera only follows the script's camera moves.
+void Game_startExport(const char *path, int fps, float stepSeconds)
+{
+    if (_exportRun.isRunning || _stepBenchmark.isRunning || _script.stepCount == 0) return;
+    Replay_stop();
+    if (Replay_isRecording()) Replay_stopRecording(REPLAY_FILE);
+    if (!Export_begin(path, fps)) return;
+    int framesPerStep = (int)(stepSeconds * fps + 0.5f);
+    _exportRun = (ExportRun){
+        .isRunning = 1,
+        .step = -1,
+        .framesPerStep = framesPerStep > 0 ? framesPerStep : 1,
     };
-    blinkingDepthOutlineFlatV.model = &_flatVectorScene;
-    blinkingDepthOutlineFlatV.drawDepthOutlineMode = 1;
-    blinkingDepthOutlineFlatV.drawUvOutlineMode = 0;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawOutlinedScene, &blinkingDepthOutlineFlatV)
-    });
-
-    step += 1;
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Outlines", 
-            "The object boundaries are now clear. The far distant objects don't have an outline "
-            "because our depth buffer range runs out - but at that point, we don't want too many outlines anyway."
-            , 
-            (Rectangle){20, 20, 200, 290})
-    });
+    ResetOrbitCamera();
+    FramePacer_setTargetFps(0);
+}
 
-    static OutlineSceneConfig enabledDepthOutlineFlatV = {
-        0
-    };
-    enabledDepthOutlineFlatV.model = &_flatVectorScene;
-    enabledDepthOutlineFlatV.drawDepthOutlineMode = 2;
-    enabledDepthOutlineFlatV.drawUvOutlineMode = 0;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawOutlinedScene, &enabledDepthOutlineFlatV)
-    });
+// Called by the host for --walkthrough: runs the step benchmark (see StartStepBenchmark)
+// and writes its results to reportFileName, if not NULL. The Makefile's pgo target uses
+// it as the training run and its benchmark target to compare the builds.
+void Game_startWalkthrough(const char *reportFileName)
+{
+    StartStepBenchmark();
+    if (_stepBenchmark.isRunning && reportFileName)
+    {
+        snprintf(_stepBenchmark.reportFileName, sizeof(_stepBenchmark.reportFileName), "%s", reportFileName);
+    }
+}
 
-    step += 1;
-    
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Outlines", 
-            "However, we want more outlines. We can use the UV coordinates as outline indicators as well!"
-            , 
-            (Rectangle){20, 20, 200, 290})
-    });
+// 0 once an export or walkthrough is done, the host then exits
+int Game_isBatchRunning()
+{
+    return _exportRun.isRunning || _stepBenchmark.isRunning;
+}
 
-    static OutlineSceneConfig blinkingUvOutlineFlatV = {
-        0
+// Called by the host for --softraster, instead of Game_init and without a window: renders
+// frameCount frames of the dithered scene at fps with the CPU rasterizer and the CPU outline
+// pass, orbiting once around it, and writes them to path (see export.h). Nothing touches GL,
+// so the model comes from resources/game.bundle ("make bundle"); raylib's glb loader uploads
+// while it loads. Returns 0 if nothing could be written.
+int Game_renderSoftRaster(const char *path, int width, int height, int fps, int frameCount)
+{
+    if (!Bundle_open(BUNDLE_FILE))
+    {
+        TraceLog(LOG_ERROR, "Game_renderSoftRaster: %s is needed, run make bundle", BUNDLE_FILE);
+        return 0;
+    }
+    if (fps <= 0) fps = 30;
+    int ditherBaked = 0;
+    _model = Bundle_loadModelCpu(_sceneModelFiles[0], &ditherBaked);
+    _sceneModelIsBundled[0] = 1;
+    int isOk = _model.meshCount > 0 && Export_begin(path, fps);
+    Image frame = {
+        .data = isOk ? MemAlloc(width * height * 4) : NULL,
+        .width = width,
+        .height = height,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
     };
-    blinkingUvOutlineFlatV.model = &_flatVectorScene;
-    blinkingUvOutlineFlatV.drawDepthOutlineMode = 2;
-    blinkingUvOutlineFlatV.drawUvOutlineMode = 1;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawOutlinedScene, &blinkingUvOutlineFlatV)
-    });
-
-    step += 1;
-    
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Outlines", 
-            "Other outline indicators could be used as well, such as normals or other vertex attributes.\n"
-            "The overall result still doesn't look great."
-            , 
-            (Rectangle){20, 20, 200, 220})
-    });
 
-    static OutlineSceneConfig fulloutlinesFlatV = {
-        0
-    };
-    fulloutlinesFlatV.model = &_flatVectorScene;
-    fulloutlinesFlatV.drawDepthOutlineMode = 2;
-    fulloutlinesFlatV.drawUvOutlineMode = 2;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawOutlinedScene, &fulloutlinesFlatV)
-    });
+    for (int f = 0; isOk && f < frameCount; f++)
+    {
+        Vector2 rotation = { _orbit.rotation.x, _orbit.rotation.y + 2.0f * PI * f / frameCount };
+        float rad = sinf(rotation.x) * _orbit.distance;
+        Camera3D camera = _camera;
+        camera.position = (Vector3){ sinf(rotation.y) * rad, cosf(rotation.x) * _orbit.distance, cosf(rotation.y) * rad };
+
+        SoftRaster_begin(width, height, WHITE);
+        SoftRaster_setCamera(camera);
+        for (int i = 0; i < _model.meshCount; i++)
+        {
+            SoftRasterMaterial material = {
+                .fragment = SoftRaster_ditherFragment,
+                .texture = GetSoftRasterTexture(&_model, _model.meshMaterial[i]),
+                .diffuse = _model.materials[_model.meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE].color,
+                .time = (float)f / fps,
+                .ditherBaked = ditherBaked,
+            };
+            SoftRaster_drawMesh(_model.meshes[i], &material, _model.transform);
+        }
+        SoftRaster_end();
 
-    step += 1;
-    
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_drawTextRect,
-        .actionData =  ScriptAction_DrawTextRectData_new(
-            "Outlines", 
-            "Using the UV coordinates to outline the objects is simple and "
-            "the result is looking much more like pixel art than using "
-            "pixel art textures directly."
-            , 
-            (Rectangle){20, 20, 200, 220})
-    });
+        // the buffers start with the bottom row, exported frames with the top one
+        const Color *pixels = SoftRaster_outline(1, 1);
+        for (int y = 0; y < height; y++)
+        {
+            memcpy((Color*)frame.data + y * width, pixels + (height - 1 - y) * width, width * sizeof(Color));
+        }
+        Export_addFrame(frame);
+    }
+    if (isOk)
+    {
+        SoftRasterStats stats = SoftRaster_getStats();
+        TraceLog(LOG_INFO, "Game_renderSoftRaster: %d frames at %dx%d, last one %d/%d tris, %d px", frameCount,
+            width, height, stats.trianglesRasterized, stats.trianglesSubmitted, stats.pixelsShaded);
+    }
 
-    static OutlineSceneConfig fulloutlines2FlatV = {
-        0
-    };
-    fulloutlines2FlatV.model = &_flatVectorSceneOutlines;
-    fulloutlines2FlatV.drawDepthOutlineMode = 2;
-    fulloutlines2FlatV.drawUvOutlineMode = 2;
-
-    Script_addAction((ScriptAction){
-        .actionIdStart = step,
-        .action = ScriptAction_setDrawScene,
-        .actionData = ScriptAction_SetDrawSceneData_new(DrawOutlinedScene, &fulloutlines2FlatV)
-    });
+    Export_end();
+    MemFree(frame.data);
+    FreeSoftRasterTextures();
+    SoftRaster_shutdown();
+    Jobs_shutdown();
+    Bundle_unloadModel(_model);
+    _model = (Model){0};
+    Bundle_close();
+    return isOk;
+}
 
-    step += 1;
+// called at the start of each frame, like UpdateStepBenchmark; the frame is captured
+// at the end of Game_update
+static void UpdateExportRun()
+{
+    ExportRun *run = &_exportRun;
+    if (!run->isRunning) return;
+    if (run->step >= 0 && run->frame < run->framesPerStep)
+    {
+        run->frame++;
+        // keep the step even if it would advance on its own
+        if (_script.currentActionId != run->step) Script_seek(run->step);
+        return;
+    }
+    run->step++;
+    run->frame = 1;
+    if (run->step == _script.stepCount)
+    {
+        run->isRunning = 0;
+        Export_end();
+        FramePacer_setTargetFps(TARGET_FPS);
+        return;
+    }
+    Script_seek(run->step);
+}
 
-    // static Camera3D camera = {
-    //     .fovy = 60,
-    //     .target = {0.0f, 0.0f, 0.0f},
-    //     .up = {0.0f, 1.0f, 0.0f},
-    //     .position = {-4.0f, 2.5f, -3.0f},
-    //     .projection = CAMERA_PERSPECTIVE,
-    // };
-    
-    // Script_addAction((ScriptAction){
-    //     .actionIdStart = step,
-    //     .action = ScriptAction_drawMesh,
-    //     .actionData = ScriptAction_DrawMeshData_new(
-    //         &_sampleObjects.meshes[0],
-    //         _shader,
-    //         &_sampleObjects.materials[1],
-    //         MatrixIdentity(),
-    //         &camera
-    //     ),
-    // });
+// saves a captured image next to the executable, like raylib's F12 screenshots but
+// without waiting for the GPU
+static void SaveCapture(Image image, void *userData)
+{
+    static int captureCounter;
+    AllocTrack_allowFrame("capture");
+    const char *fileName;
+    do fileName = TextFormat("capture%03d.png", captureCounter++);
+    while (FileExists(fileName));
+    double start = GetTime();
+    ExportImage(image, fileName);
+    TraceLog(LOG_INFO, "Capture: %s %dx%d, %d frames after the request, stall %.3f ms, encoded in %.1f ms", fileName,
+        image.width, image.height, Readback_getStats().lastLatencyFrames, Readback_getStats().lastStallMs,
+        (GetTime() - start) * 1000.0);
+}
 
-    _script.currentActionId = _contextData->step;
+Model *GetPickedMesh(int objectId, int *meshIndex)
+{
+    if (objectId < 0) return NULL;
+    int slot = objectId >> PICK_ID_MESH_BITS;
+    int mesh = objectId & ((1 << PICK_ID_MESH_BITS) - 1);
+    if (slot >= SCENE_MODEL_COUNT || mesh >= _sceneModels[slot]->meshCount) return NULL;
+    if (meshIndex) *meshIndex = mesh;
+    return _sceneModels[slot];
+}
 
-    Script_addAction((ScriptAction){
-        .actionIdStart = 0, .actionIdEnd = step, .action = ScriptAction_jumpStep, .actionData = ScriptAction_JumpStepData_new(-1, 1, 1),
-    });
+// Draws the ids of the meshes of this frame's scene models that cover one pixel of
+// _target into the 1x1 pick target: the projection is narrowed to that pixel, which
+// also culls all meshes that are not under it. The DITHER_OBJECT_ID variant discards
+// the same fragments as the scene pass; models drawn with raylib's default shader
+// are picked through it too.
+static void RenderPickIds(Vector2 pixel)
+{
+    if (_pickTarget.id == 0) _pickTarget = RenderTargetPool_acquire(1, 1);
+    float width = (float)_target.texture.width;
+    float height = (float)_target.texture.height;
+    int pixelX = (int)pixel.x;
+    int pixelY = (int)pixel.y;
+    // scales the pixel's square of normalized device coordinates up to the whole target
+    Matrix narrow = MatrixIdentity();
+    narrow.m0 = width;
+    narrow.m5 = height;
+    narrow.m12 = width - 1.0f - 2.0f*pixelX;
+    narrow.m13 = 2.0f*pixelY + 1.0f - height;
+    Matrix projection = MatrixMultiply(Frustum_getProjection(_camera, width / height), narrow);
+    Matrix view = MatrixLookAt(_camera.position, _camera.target, _camera.up);
+    Frustum frustum = Frustum_fromMatrix(MatrixMultiply(view, projection));
+    // GL rows start at the bottom
+    ShaderVariantSet_setValue(&_ditherShaders, "pickOrigin", (float[2]){ (float)pixelX, height - 1.0f - pixelY },
+        SHADER_UNIFORM_VEC2);
+
+    BeginTextureMode(_pickTarget);
+    ClearBackground(BLANK);
+    rlDisableColorBlend();
+    BeginMode3D(_camera);
+    rlMatrixMode(RL_PROJECTION);
+    rlLoadIdentity();
+    rlMultMatrixf(MatrixToFloat(projection));
+    rlMatrixMode(RL_MODELVIEW);
+    for (int k = 0; k < SCENE_MODEL_COUNT; k++)
+    {
+        if ((_drawnModelMask & (1 << k)) == 0) continue;
+        Model *model = _sceneModels[k];
+        ModelImportInfo *info = ModelImport_getInfo(model);
+        for (int i = 0; i < model->meshCount; i++)
+        {
+            if (info && !Frustum_containsBox(&frustum, BoundingBox_transform(info->meshBounds[i], model->transform))) continue;
+            // every copy of an instanced mesh has its own id
+            int source = info && info->instanceGroupCount > 0 && info->instanceSource[i] >= 0 ? info->instanceSource[i] : i;
+            Matrix transform = model->transform;
+            Mesh mesh = model->meshes[i];
+            Matrix dequantize = MatrixIdentity();
+            if (info)
+            {
+                if (source != i) transform = MatrixMultiply(info->instanceTransform[i], transform);
+                mesh = ModelImport_getLodMesh(info, source, 0, &dequantize);
+            }
+            Material material = model->materials[model->meshMaterial[source]];
+            int features = DITHER_FEATURE_OBJECT_ID | (info && info->ditherBaked ? DITHER_FEATURE_BAKED : 0);
+            material.shader = ShaderVariantSet_get(&_ditherShaders, features)->shader;
+            // the maps are shared with the model
+            Color diffuse = material.maps[MATERIAL_MAP_DIFFUSE].color;
+            material.maps[MATERIAL_MAP_DIFFUSE].color = Picking_getIdColor(k << PICK_ID_MESH_BITS | i);
+            DrawMesh(mesh, material, MatrixMultiply(dequantize, transform));
+            material.maps[MATERIAL_MAP_DIFFUSE].color = diffuse;
+        }
+    }
+    EndMode3D();
+    EndTextureMode();
 }
 
-void Game_deinit()
+// Requests the surface under the mouse from this frame's scene target, see picking.h.
+// With the PBO ring hover and clicks are small asynchronous reads; without it every read
+// waits for the GPU and takes the whole target, so then only clicks are picked.
+static void UpdatePicking()
 {
-    printf("Game_deinit\n");
-    UnloadModel(_model);
-    UnloadModel(_sampleObjects);
-    UnloadModel(_flatVectorScene);
-    UnloadModel(_flatVectorSceneOutlines);
-    UnloadShader(_shader);
-    UnloadShader(_outlineShader);
-    UnloadRenderTexture(_target);
-    UnloadFont(_fntMedium);
-    UnloadFont(_fntMono);
+    int isClick = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    if (!isClick && !Readback_isAsync()) return;
+    Vector2 mouse = GetMousePosition();
+    Vector2 pixel = {
+        floorf(mouse.x * _target.texture.width / GetScreenWidth()),
+        floorf(mouse.y * _target.texture.height / GetScreenHeight()),
+    };
+    if (pixel.x < 0.0f || pixel.y < 0.0f || pixel.x >= _target.texture.width || pixel.y >= _target.texture.height) return;
+    if (_usePickIds && !_useSoftRaster)
+    {
+        double start = GetTime();
+        RenderPickIds(pixel);
+        _pickIdMs = (float)((GetTime() - start) * 1000.0);
+        Picking_requestObjectId(_pickTarget);
+    }
+    Picking_request(_target, pixel, _camera, isClick);
 }
 
-void DrawScene()
+// debug keys, recordings and exports allocate on purpose, see AllocTrack_allowFrame; the
+// frames of a step benchmark or a walkthrough are checked like any other
+static void AllowDebugAllocations()
 {
-    if (_DrawSceneFn)
+    static const int keys[] = { KEY_F1, KEY_F2, KEY_F6, KEY_F7, KEY_F8, KEY_F9, KEY_F10, KEY_F11, KEY_F12,
+        KEY_PRINT_SCREEN };
+    for (int i = 0; i < (int)(sizeof(keys)/sizeof(keys[0])); i++)
     {
-        _DrawSceneFn(_drawSceneData);
+        if (IsKeyPressed(keys[i])) AllocTrack_allowFrame("debug key");
     }
+    if (Replay_isRecording()) AllocTrack_allowFrame("replay recording");
+    if (_exportRun.isRunning) AllocTrack_allowFrame("export");
 }
 
 void Game_update()
@@ -556,31 +1942,124 @@ void Game_update()
     int screenWidth = GetScreenWidth();
     int screenHeight = GetScreenHeight();
 
+    AllocTrack_beginFrame();
+    AllowDebugAllocations();
+    Readback_update();
+    Picking_update();
+
+    for (int key = KEY_ONE; key <= KEY_FOUR; key++)
+    {
+        if (IsKeyPressed(key))
+        {
+            SetDynamicResolution(0, 0.0f);
+            SetRenderScale(key - KEY_ONE + 1);
+        }
+    }
+    if (IsKeyPressed(KEY_ZERO))
+    {
+        SetDynamicResolution(!IsDynamicResolutionEnabled(), 60.0f);
+    }
+    if (IsKeyPressed(KEY_F3)) _showDebugOverlay = !_showDebugOverlay;
+    if (IsKeyPressed(KEY_F5)) ShaderVariantSet_logStats(&_outlineShaders), AllocTrack_logSites();
+    if (IsKeyPressed(KEY_F2)) _useSoftRaster = !_useSoftRaster;
+    if (IsKeyPressed(KEY_F4)) _useLods = !_useLods;
+    if (IsKeyPressed(KEY_F1)) _usePickIds = !_usePickIds;
+    if (IsKeyPressed(KEY_V)) FramePacer_setVsync(!FramePacer_getStats().isVsync);
+    // F12 is taken by raylib's synchronous TakeScreenshot
+    if (IsKeyPressed(KEY_PRINT_SCREEN))
+    {
+        if (IsKeyDown(KEY_LEFT_SHIFT)) Readback_measureStall(_target);
+        else _captureRequest = IsKeyDown(KEY_LEFT_CONTROL) ? 2 : 1;
+    }
+    if (IsKeyPressed(KEY_F9))
+    {
+        if (Replay_isRecording()) Replay_stopRecording(REPLAY_FILE);
+        else if (!_stepBenchmark.isRunning) ResetOrbitCamera(), Replay_startRecording();
+    }
+    if (IsKeyPressed(KEY_F10) && !_stepBenchmark.isRunning && !Replay_isRecording())
+    {
+        if (Replay_isPlaying()) Replay_stop();
+        else if (Replay_play(REPLAY_FILE)) ResetOrbitCamera();
+    }
+    if (IsKeyPressed(KEY_F11) && !Replay_isRecording()) StartStepBenchmark();
+    UpdateStepBenchmark();
+    UpdateExportRun();
+    UpdateGameClock();
+    if (IsKeyPressed(KEY_F7))
+    {
+        if (IsKeyDown(KEY_LEFT_SHIFT)) BenchmarkTextLayout(_fntMedium);
+        else if (IsKeyDown(KEY_LEFT_CONTROL))
+        {
+            SetTextWrapMode(GetTextWrapMode() == TEXT_WRAP_GREEDY ? TEXT_WRAP_OPTIMAL : TEXT_WRAP_GREEDY);
+            TraceLog(LOG_INFO, "text wrap: %s", GetTextWrapMode() == TEXT_WRAP_GREEDY ? "greedy" : "optimal");
+            Script_invalidateUi();
+        }
+        else ScriptFile_benchmark(50000);
+    }
+    // text box scale in quarter steps, crisp at every step with the SDF font
+    if (IsKeyDown(KEY_LEFT_CONTROL) && (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_MINUS)))
+    {
+        float scale = GetTextBoxScale() + (IsKeyPressed(KEY_EQUAL) ? 0.25f : -0.25f);
+        SetTextBoxScale(scale < 1.0f ? 1.0f : scale > 4.0f ? 4.0f : scale);
+        TraceLog(LOG_INFO, "text box scale: %.2f", GetTextBoxScale());
+        Script_invalidateUi();
+    }
+    if (IsKeyPressed(KEY_F8))
+    {
+        Arena arena = {0};
+        ScriptProgram *program = ScriptFile_load(&arena, SCRIPT_FILE, IsScriptBundled(SCRIPT_FILE));
+        if (program) ScriptFile_saveBinary(program, SCRIPT_BINARY_FILE);
+        Arena_free(&arena);
+    }
+    UpdateScriptReload();
+
     UpdateRenderTexture();
 
-    BeginTextureMode(_target);
-    ClearBackground(WHITE);
+    Tween_update(GetGameTime());
+
     // float time = sinf(GetTime() * 0.5f) * 0.0f + PI * 1.25f;
-    static Vector2 rotation = {1.0f, -2.5f};
-    static Vector2 rotateVelocity = {0.0f, 0.0f};
-    static float distance = 5.0f;
-    static float distanceVelocity = 0.0f;
+    Vector2 rotation = _orbit.rotation;
+    Vector2 rotateVelocity = _orbit.rotateVelocity;
+    float distance = _orbit.distance;
+    float distanceVelocity = _orbit.distanceVelocity;
     const float MaxDistance = 10.0f;
+    float frameTime = GetGameFrameTime();
     const float MinDistance = 2.5f;
 
-    if (rotation.x > 1.6f) rotateVelocity.x -= 20.1f * GetFrameTime();
-    if (rotation.x < 0.8f) rotateVelocity.x += 20.1f * GetFrameTime();
-    if (distance < MinDistance + 1.0f) distanceVelocity += (MinDistance - distance + 1.0f) * GetFrameTime();
-    if (distance > MaxDistance - 1.0f) distanceVelocity -= (distance - MaxDistance + 1.0f) * GetFrameTime();
+    // the input is polled as late as possible and moves the camera of this frame, so the
+    // latency histogram of framepacer.h measures the input up to the present that shows it
+    static int wasDown = 0;
+    FramePacer_sampleInput();
+    ReplayInput input = ReadCameraInput();
+    if (input.leftDown)
+    {
+        if (wasDown)
+        {
+            rotateVelocity.x -= input.mouseDelta.y * 0.015f;
+            rotateVelocity.y -= input.mouseDelta.x * 0.015f;
+        }
+        wasDown = 1;
+    }
+    else {
+        wasDown = 0;
+    }
+    distanceVelocity -= input.wheel * 0.1f;
+    // a scripted camera move has the camera until it is done
+    if (Tween_isAnimating(&_orbit.distance)) rotateVelocity = (Vector2){0.0f, 0.0f}, distanceVelocity = 0.0f;
+
+    if (rotation.x > 1.6f) rotateVelocity.x -= 20.1f * frameTime;
+    if (rotation.x < 0.8f) rotateVelocity.x += 20.1f * frameTime;
+    if (distance < MinDistance + 1.0f) distanceVelocity += (MinDistance - distance + 1.0f) * frameTime;
+    if (distance > MaxDistance - 1.0f) distanceVelocity -= (distance - MaxDistance + 1.0f) * frameTime;
     distance += distanceVelocity;
-    rotation.x += rotateVelocity.x * GetFrameTime();
-    rotation.y += rotateVelocity.y * GetFrameTime();
+    rotation.x += rotateVelocity.x * frameTime;
+    rotation.y += rotateVelocity.y * frameTime;
     if (rotation.x > 1.7f) rotation.x = 1.7f;
     if (rotation.x < 0.4f) rotation.x = 0.4f;
     if (distance < MinDistance) distance = MinDistance, distanceVelocity = 0.0f;
     if (distance > MaxDistance) distance = MaxDistance, distanceVelocity = 0.0f;
 
-    float decay = 1.0f - GetFrameTime() * distance;
+    float decay = 1.0f - frameTime * distance;
     rotateVelocity.x *= decay;
     rotateVelocity.y *= decay;
     distanceVelocity *= decay;
@@ -589,57 +2068,82 @@ void Game_update()
     float camy = cosf(rotation.x) * distance;
     float camx = sinf(rotation.y) * rad;
     float camz = cosf(rotation.y) * rad;
-    static Camera3D camera = {
-        .fovy = 45.0f,
-        .target = {0.0f, 0.25f, 0.0f},
-        .up = {0.0f, 1.0f, 0.0f},
-        .position = {-4.0f, 2.5f, -3.0f},
-    };
-    camera.position.x = camx;
-    camera.position.y = camy;
-    camera.position.z = camz;
-    static int wasDown = 0;
-    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON))
+    _camera.position.x = camx;
+    _camera.position.y = camy;
+    _camera.position.z = camz;
+    _orbit = (OrbitCamera){ rotation, rotateVelocity, distance, distanceVelocity };
+
+
+    if (IsKeyPressed(KEY_F6)) RunSoftRasterBenchmark();
+
+    DrawList_resetStats();
+    _drawnModelMask = 0;
+    _pass = (ScenePass){ _camera, (float)_target.texture.width, (float)_target.texture.height, -1 };
+    if (_useSoftRaster)
     {
-        if (wasDown)
-        {
-            rotateVelocity.x -= GetMouseDelta().y * 0.015f;
-            rotateVelocity.y -= GetMouseDelta().x * 0.015f;
-        }
-        wasDown = 1;
-    }
-    else {
-        wasDown = 0;
+        RenderSoftScene();
+        UpdateTexture(_target.texture, SoftRaster_getPixels());
     }
-    distanceVelocity -= GetMouseWheelMove() * 0.1f;
-
+    else
+    {
+        BeginTextureMode(_target);
+        ClearBackground(WHITE);
+        // UpdateCamera(&camera, CAMERA_THIRD_PERSON);
+        rlDisableColorBlend();
 
-    // UpdateCamera(&camera, CAMERA_THIRD_PERSON);
-    rlDisableColorBlend();
+        // rlSetBlendMode(RL_BLEND_CUSTOM);
+        // rlSetBlendFactors(GL_ONE, GL_ZERO, GL_FUNC_ADD);
+        BeginMode3D(_camera);
 
-    // rlSetBlendMode(RL_BLEND_CUSTOM);
-    // rlSetBlendFactors(GL_ONE, GL_ZERO, GL_FUNC_ADD);
-    BeginMode3D(camera);
+        DrawScene();
 
-    DrawScene();
+        EndMode3D();
+        EndTextureMode();
+    }
+    UpdatePicking();
 
-    EndMode3D();
-    EndTextureMode();
+    // post processing runs once per target pixel into _postTarget; the screen and the
+    // magnifiers then only scale that image up
+    ShaderVariant *postProcessor = (mode & 1) == 0 ? _postProcessor : NULL;
+    _sceneTexture = _target.texture;
+    if (postProcessor && _useSoftRaster)
+    {
+        // the same pass on the CPU, see SoftRaster_outline
+        int features = postProcessor->featureMask;
+        UpdateTexture(_postTarget.texture,
+            SoftRaster_outline(features & OUTLINE_FEATURE_DEPTH, features & OUTLINE_FEATURE_UV));
+        _sceneTexture = _postTarget.texture;
+    }
+    else if (postProcessor)
+    {
+        BeginTextureMode(_postTarget);
+        rlDisableColorBlend();
+        ShaderVariant_beginTiming(postProcessor);
+        SetShaderValue(postProcessor->shader, GetShaderLocation(postProcessor->shader, "resolution"), (float[2]){(float)_target.texture.width, (float)_target.texture.height}, SHADER_UNIFORM_VEC2);
+        BeginShaderMode(postProcessor->shader);
+        DrawTexturePro(_target.texture, 
+            (Rectangle){0.0f, 0.0f, (float)_target.texture.width, (float)-_target.texture.height}, 
+            (Rectangle){0.0f, 0.0f, (float)_postTarget.texture.width, (float)_postTarget.texture.height}, 
+            (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
+        EndShaderMode();
+        ShaderVariant_endTiming(postProcessor);
+        EndTextureMode();
+        _sceneTexture = _postTarget.texture;
+    }
+    if (_captureRequest == 2)
+    {
+        Readback_requestTexture(postProcessor ? _postTarget : _target, (Rectangle){0}, SaveCapture, NULL);
+        _captureRequest = 0;
+    }
+    RenderViewports();
 
     rlEnableColorBlend();
     // rlSetBlendMode(RL_BLEND_ALPHA);
     BeginDrawing();
-    if ((mode & 1) == 0 && _postProcessorShader)
-    {
-        BeginShaderMode(*_postProcessorShader);
-   }
-    SetShaderValue(_outlineShader, GetShaderLocation(_outlineShader, "resolution"), (float[2]){(float)_target.texture.width, (float)_target.texture.height}, SHADER_UNIFORM_VEC2);
-    DrawTexturePro(_target.texture, 
-        (Rectangle){0.0f, 0.0f, (float)_target.texture.width, (float)-_target.texture.height}, 
+    DrawTexturePro(_sceneTexture, 
+        (Rectangle){0.0f, 0.0f, (float)_sceneTexture.width, (float)-_sceneTexture.height}, 
         (Rectangle){0.0f, 0.0f, (float)screenWidth, (float)screenHeight}, 
         (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
-    if ((mode & 1) == 0 && _postProcessorShader)
-        EndShaderMode();
 
 
     // int mouseX = GetMouseX();
@@ -666,11 +2170,22 @@ void Game_update()
     // DrawRectangle(55, 5, 20, 20, hoverC ? RED : WHITE);
     rlEnableColorBlend();
 
+    DrawViewports();
+    if (_sceneFade < 1.0f) DrawRectangle(0, 0, screenWidth, screenHeight, Fade(WHITE, 1.0f - _sceneFade));
     Script_update();
 
+    if (_showDebugOverlay) DrawDebugOverlay();
+
     // DrawRectangle(20, 20, 200, 200, WHITE);
     // DrawRectangleLines(21, 21, 198, 198, BLACK);
     // DrawRectangleLines(20, 20, 200, 200, BLACK);
     // DrawTextEx(fntMedium, "Dithering & outlining\n", (Vector2){26, 24}, fntMedium.baseSize * 2.0f, -2.0f, WHITE);
-    EndDrawing();
+    if (_captureRequest == 1)
+    {
+        Readback_requestScreen((Rectangle){0}, SaveCapture, NULL);
+        _captureRequest = 0;
+    }
+    if (_exportRun.isRunning) Export_captureScreen();
+    FramePacer_endFrame();
+    AllocTrack_endFrame();
 }
\ No newline at end of file
@@ -4,33 +4,128 @@
 #include "raylib.h"
 #include "rlgl.h"
 #include "util.h"
+#include "arena.h"
 
 typedef struct Script Script;
 typedef struct ScriptAction ScriptAction;
 
 typedef struct ScriptAction {
     int actionIdStart, actionIdEnd;
+    // called every frame while the step is active, may be NULL
     void (*action)(Script *script, ScriptAction *action);
+    // called when a step of the action is entered, may be NULL; used to start tweens
+    void (*enter)(Script *script, ScriptAction *action);
+    // draws the static part of the action into the cached UI layer, may be NULL;
+    // only called when the layer was invalidated, see Script_invalidateUi
+    void (*drawUi)(Script *script, ScriptAction *action);
     union {
         int actionInt;
         void *actionData;
     };
 } ScriptAction;
 
-#define SCRIPT_MAX_ACTIONS 128
+// state of one step, compiled by Script_buildSteps so that any step can be entered
+// without evaluating the actions before it
+typedef struct ScriptStep {
+    // scene that is drawn on this step, carried over from earlier steps; NULL before the first scene
+    void (*drawSceneFn)(void*);
+    void *drawSceneData;
+    // overlay and timed actions (text, magnifier, navigation, camera, ...) of this step, indices in Script.stepActions
+    int firstAction;
+    int actionCount;
+} ScriptStep;
+
+typedef struct ScriptLabel {
+    const char *name;
+    int step;
+} ScriptLabel;
 
 typedef struct Script {
     int actionCount;
-    ScriptAction actions[SCRIPT_MAX_ACTIONS];
+    int actionCapacity;
+    ScriptAction *actions;
     int currentActionId;
     int nextActionId;
+    int stepCount;
+    // time at which the current step was entered
+    double stepStartTime;
+    // per step state, stepCount entries; built after all actions were added
+    ScriptStep *steps;
+    int *stepActions;
+    // sorted by name
+    int labelCount;
+    int labelCapacity;
+    ScriptLabel *labels;
+    // action data, strings and the step table, see pool_alloc
+    Arena arena;
 } Script;
 
 extern Script _script;
 extern Font _fntMono;
 extern Font _fntMedium;
 
+// copies data into the arena of the script that is being built
 void* pool_alloc(int size, void *data);
+void Script_appendAction(Script *script, ScriptAction action);
+void Script_free(Script *script);
+void Script_addLabel(Script *script, const char *name, int step);
+// compiles the per step state table from the actions and sorts the labels
+void Script_buildSteps(Script *script);
+// returns the step of the label or -1
+int Script_findLabel(const Script *script, const char *name);
+// enters a step of the running script directly, clamped to the valid range
+void Script_seek(int step);
+// returns 0 if the label does not exist
+int Script_seekLabel(const char *name);
+// game time in seconds; runs on a fixed time step while a camera path is recorded or replayed
+double GetGameTime();
+float GetGameFrameTime();
+// redraws the UI layer in the next Script_update; called for changes that are not
+// covered by step changes and window resizes, e.g. hover state or animations
+void Script_invalidateUi();
+// seconds since the current step was entered
+float Script_getStepTime();
+// moves the orbit camera to the given angles and distance over the duration
+void SetCameraOrbit(float pitch, float yaw, float distance, float duration);
+void FadeInScene(float duration);
 void SetSceneDrawingFunction(void (*fn)(void*), void* drawSceneData);
 
+#define VIEWPORT_MAX 8
+
+// A view of a scene drawn over the main scene into a rectangle of the screen, with its
+// own camera, scene function and render scale; the scene function picks the post
+// processor as it does for the main scene. All viewports of a frame are drawn into one
+// pooled target with a single clear, culled together (see DrawList_beginViews) and post
+// processed into a second pooled target with one batch per post processor, so the
+// screen composites them with one draw call. Viewports belong to the step: Script_seek
+// clears them before the step's actions are entered. Not drawn by the CPU rasterizer.
+typedef struct Viewport {
+    // screen pixels
+    Rectangle rect;
+    Camera3D camera;
+    // the camera is the orbit camera turned by orbitYaw radians about its target
+    int followsOrbit;
+    float orbitYaw;
+    void (*drawSceneFn)(void*);
+    void *drawSceneData;
+    // pixel size as for SetRenderScale, 0 uses the main scene's
+    int renderScale;
+} Viewport;
+
+// returns 0 when VIEWPORT_MAX viewports are set
+int AddViewport(Viewport viewport);
+void ClearViewports();
+// scene model and mesh of an object id of picking (see picking.h); script actions read
+// what the mouse points at from Picking_getHover and Picking_getClick. NULL for
+// PICKING_NO_OBJECT or an id that is not a mesh of a scene model.
+Model *GetPickedMesh(int objectId, int *meshIndex);
+
+#define RENDER_SCALE_MIN 1
+#define RENDER_SCALE_MAX 4
+
+void SetRenderScale(int pixelSize);
+int GetRenderScale();
+void SetDynamicResolution(int enabled, float targetFps);
+int IsDynamicResolutionEnabled();
+
 #endif
\ No newline at end of file
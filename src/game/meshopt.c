@@ -0,0 +1,978 @@
+#include "meshopt.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include "alloctrack.h"
+#include <math.h>
+#include <float.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+// merged meshes keep 16 bit indices
+#define MESHOPT_MAX_VERTICES 65535
+// length of Mesh.vboId, MAX_MESH_VERTEX_BUFFERS in raylib's config.h
+#define MESHOPT_VERTEX_BUFFERS 7
+// slots in Mesh.vboId, same layout as raylib's UploadMesh
+#define MESHOPT_VBO_VERTICES 0
+#define MESHOPT_VBO_INDICES 6
+// GL types rlgl has no names for
+#define MESHOPT_GL_UNSIGNED_SHORT 0x1403
+#define MESHOPT_GL_HALF_FLOAT 0x140B
+// cache size the Forsyth scores are tuned for
+#define MESHOPT_CACHE_SIZE 32
+
+// half float vertex attributes need GL 3 / GLES 3, WebGL 1 and GLES 2 keep float texcoords
+#if defined(PLATFORM_WEB) || defined(PLATFORM_ANDROID)
+    #define MESHOPT_HALF_TEXCOORDS 0
+#else
+    #define MESHOPT_HALF_TEXCOORDS 1
+#endif
+
+static int IsStaticMesh(const Mesh *mesh)
+{
+    return mesh->vertices != NULL && mesh->animVertices == NULL && mesh->boneIds == NULL;
+}
+
+static int SameLayout(const Mesh *a, const Mesh *b)
+{
+    return (a->texcoords == NULL) == (b->texcoords == NULL)
+        && (a->texcoords2 == NULL) == (b->texcoords2 == NULL)
+        && (a->normals == NULL) == (b->normals == NULL)
+        && (a->tangents == NULL) == (b->tangents == NULL)
+        && (a->colors == NULL) == (b->colors == NULL);
+}
+
+static void *AllocLike(const void *array, int size)
+{
+    return array ? MemAlloc(size) : NULL;
+}
+
+static void CopyVertexArray(void *dst, const void *src, int offset, int count, int elementSize)
+{
+    if (dst && src) memcpy((char*)dst + offset*elementSize, src, count*elementSize);
+}
+
+static Mesh MergeMeshes(const Mesh *meshes, const int *members, int memberCount)
+{
+    const Mesh *first = &meshes[members[0]];
+    Mesh merged = {0};
+    for (int k = 0; k < memberCount; k++)
+    {
+        merged.vertexCount += meshes[members[k]].vertexCount;
+        merged.triangleCount += meshes[members[k]].triangleCount;
+    }
+
+    int vertexCount = merged.vertexCount;
+    merged.vertices = MemAlloc(vertexCount*3*sizeof(float));
+    merged.texcoords = AllocLike(first->texcoords, vertexCount*2*sizeof(float));
+    merged.texcoords2 = AllocLike(first->texcoords2, vertexCount*2*sizeof(float));
+    merged.normals = AllocLike(first->normals, vertexCount*3*sizeof(float));
+    merged.tangents = AllocLike(first->tangents, vertexCount*4*sizeof(float));
+    merged.colors = AllocLike(first->colors, vertexCount*4);
+    merged.indices = MemAlloc(merged.triangleCount*3*sizeof(unsigned short));
+
+    int vertexOffset = 0;
+    int indexOffset = 0;
+    for (int k = 0; k < memberCount; k++)
+    {
+        const Mesh *mesh = &meshes[members[k]];
+        CopyVertexArray(merged.vertices, mesh->vertices, vertexOffset, mesh->vertexCount, 3*sizeof(float));
+        CopyVertexArray(merged.texcoords, mesh->texcoords, vertexOffset, mesh->vertexCount, 2*sizeof(float));
+        CopyVertexArray(merged.texcoords2, mesh->texcoords2, vertexOffset, mesh->vertexCount, 2*sizeof(float));
+        CopyVertexArray(merged.normals, mesh->normals, vertexOffset, mesh->vertexCount, 3*sizeof(float));
+        CopyVertexArray(merged.tangents, mesh->tangents, vertexOffset, mesh->vertexCount, 4*sizeof(float));
+        CopyVertexArray(merged.colors, mesh->colors, vertexOffset, mesh->vertexCount, 4);
+        for (int i = 0; i < mesh->triangleCount*3; i++)
+        {
+            int index = mesh->indices ? mesh->indices[i] : i;
+            merged.indices[indexOffset++] = (unsigned short)(vertexOffset + index);
+        }
+        vertexOffset += mesh->vertexCount;
+    }
+    return merged;
+}
+
+//----------------------------------------------------------------------------------
+// Vertex cache optimization, after Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+//----------------------------------------------------------------------------------
+
+static float VertexScore(int cachePosition, int remainingTriangles)
+{
+    if (remainingTriangles == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // the last triangle's vertices get a fixed score so that its neighbors don't
+        // win just because they reuse a vertex that was used a moment ago
+        if (cachePosition < 3) score = 0.75f;
+        else score = powf(1.0f - (float)(cachePosition - 3) / (MESHOPT_CACHE_SIZE - 3), 1.5f);
+    }
+    // prefer vertices with few triangles left, so that they can leave the cache for good
+    score += 2.0f * powf((float)remainingTriangles, -0.5f);
+    return score;
+}
+
+static void OptimizeVertexCache(unsigned short *indices, int triangleCount, int vertexCount)
+{
+    int *remaining = MemAlloc(vertexCount*sizeof(int));
+    int *adjacencyStart = MemAlloc((vertexCount + 1)*sizeof(int));
+    int *adjacency = MemAlloc(triangleCount*3*sizeof(int));
+    int *cachePosition = MemAlloc(vertexCount*sizeof(int));
+    float *vertexScore = MemAlloc(vertexCount*sizeof(float));
+    float *triangleScore = MemAlloc(triangleCount*sizeof(float));
+    unsigned char *emitted = MemAlloc(triangleCount);
+    unsigned short *output = MemAlloc(triangleCount*3*sizeof(unsigned short));
+
+    for (int i = 0; i < triangleCount*3; i++) remaining[indices[i]]++;
+    for (int v = 0; v < vertexCount; v++)
+    {
+        adjacencyStart[v + 1] = adjacencyStart[v] + remaining[v];
+        remaining[v] = 0;
+        cachePosition[v] = -1;
+    }
+    for (int t = 0; t < triangleCount; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            int v = indices[t*3 + k];
+            adjacency[adjacencyStart[v] + remaining[v]++] = t;
+        }
+    }
+    for (int v = 0; v < vertexCount; v++) vertexScore[v] = VertexScore(-1, remaining[v]);
+    for (int t = 0; t < triangleCount; t++)
+    {
+        triangleScore[t] = vertexScore[indices[t*3]] + vertexScore[indices[t*3 + 1]] + vertexScore[indices[t*3 + 2]];
+    }
+
+    // three extra slots hold the vertices that are pushed out by the newest triangle
+    int cache[MESHOPT_CACHE_SIZE + 3];
+    int cacheCount = 0;
+    int bestTriangle = -1;
+    int scanStart = 0;
+    for (int outputCount = 0; outputCount < triangleCount; outputCount++)
+    {
+        if (bestTriangle < 0)
+        {
+            // nothing in the cache is connected to an unused triangle, start somewhere new
+            float bestScore = -1.0f;
+            while (emitted[scanStart]) scanStart++;
+            for (int t = scanStart; t < triangleCount; t++)
+            {
+                if (!emitted[t] && triangleScore[t] > bestScore) bestScore = triangleScore[t], bestTriangle = t;
+            }
+        }
+
+        int t = bestTriangle;
+        emitted[t] = 1;
+        int newCache[MESHOPT_CACHE_SIZE + 3];
+        int newCount = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            int v = indices[t*3 + k];
+            output[outputCount*3 + k] = (unsigned short)v;
+            newCache[newCount++] = v;
+            // drop the triangle from the vertex's list of remaining triangles
+            int *list = &adjacency[adjacencyStart[v]];
+            for (int n = 0; n < remaining[v]; n++)
+            {
+                if (list[n] != t) continue;
+                list[n] = list[--remaining[v]];
+                break;
+            }
+        }
+        for (int n = 0; n < cacheCount; n++)
+        {
+            int v = cache[n];
+            if (v != newCache[0] && v != newCache[1] && v != newCache[2]) newCache[newCount++] = v;
+        }
+
+        for (int n = 0; n < newCount; n++)
+        {
+            int v = newCache[n];
+            cachePosition[v] = n < MESHOPT_CACHE_SIZE ? n : -1;
+            vertexScore[v] = VertexScore(cachePosition[v], remaining[v]);
+        }
+
+        // only triangles touching the cache changed their score
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (int n = 0; n < newCount; n++)
+        {
+            int v = newCache[n];
+            const int *list = &adjacency[adjacencyStart[v]];
+            for (int a = 0; a < remaining[v]; a++)
+            {
+                int other = list[a];
+                float score = vertexScore[indices[other*3]] + vertexScore[indices[other*3 + 1]] + vertexScore[indices[other*3 + 2]];
+                triangleScore[other] = score;
+                if (score > bestScore) bestScore = score, bestTriangle = other;
+            }
+        }
+
+        cacheCount = newCount < MESHOPT_CACHE_SIZE ? newCount : MESHOPT_CACHE_SIZE;
+        memcpy(cache, newCache, cacheCount*sizeof(int));
+    }
+
+    memcpy(indices, output, triangleCount*3*sizeof(unsigned short));
+    MemFree(output);
+    MemFree(emitted);
+    MemFree(triangleScore);
+    MemFree(vertexScore);
+    MemFree(cachePosition);
+    MemFree(adjacency);
+    MemFree(adjacencyStart);
+    MemFree(remaining);
+}
+
+static void PermuteArray(void **array, const int *remap, int vertexCount, int elementSize)
+{
+    if (*array == NULL) return;
+    char *permuted = MemAlloc(vertexCount*elementSize);
+    for (int v = 0; v < vertexCount; v++)
+    {
+        memcpy(permuted + remap[v]*elementSize, (char*)*array + v*elementSize, elementSize);
+    }
+    MemFree(*array);
+    *array = permuted;
+}
+
+// renumbers the vertices in the order the triangles first use them
+static void OptimizeVertexFetch(Mesh *mesh)
+{
+    int *remap = MemAlloc(mesh->vertexCount*sizeof(int));
+    for (int v = 0; v < mesh->vertexCount; v++) remap[v] = -1;
+    int next = 0;
+    for (int i = 0; i < mesh->triangleCount*3; i++)
+    {
+        int v = mesh->indices[i];
+        if (remap[v] < 0) remap[v] = next++;
+        mesh->indices[i] = (unsigned short)remap[v];
+    }
+    // unused vertices go to the end
+    for (int v = 0; v < mesh->vertexCount; v++)
+    {
+        if (remap[v] < 0) remap[v] = next++;
+    }
+
+    PermuteArray((void**)&mesh->vertices, remap, mesh->vertexCount, 3*sizeof(float));
+    PermuteArray((void**)&mesh->texcoords, remap, mesh->vertexCount, 2*sizeof(float));
+    PermuteArray((void**)&mesh->texcoords2, remap, mesh->vertexCount, 2*sizeof(float));
+    PermuteArray((void**)&mesh->normals, remap, mesh->vertexCount, 3*sizeof(float));
+    PermuteArray((void**)&mesh->tangents, remap, mesh->vertexCount, 4*sizeof(float));
+    PermuteArray((void**)&mesh->colors, remap, mesh->vertexCount, 4);
+    MemFree(remap);
+}
+
+float MeshOpt_getAcmr(const Mesh *mesh)
+{
+    if (mesh->triangleCount == 0) return 0.0f;
+    if (mesh->indices == NULL) return 3.0f;
+
+    // a vertex is in the FIFO while fewer than MESHOPT_FIFO_SIZE misses happened since it was added
+    int *addedAt = MemAlloc(mesh->vertexCount*sizeof(int));
+    for (int v = 0; v < mesh->vertexCount; v++) addedAt[v] = -MESHOPT_FIFO_SIZE;
+    int misses = 0;
+    for (int i = 0; i < mesh->triangleCount*3; i++)
+    {
+        int v = mesh->indices[i];
+        if (misses - addedAt[v] < MESHOPT_FIFO_SIZE) continue;
+        addedAt[v] = misses++;
+    }
+    MemFree(addedAt);
+    return (float)misses / mesh->triangleCount;
+}
+
+static void OptimizeMesh(Mesh *mesh)
+{
+    if (IsStaticMesh(mesh) && mesh->indices != NULL)
+    {
+        OptimizeVertexCache(mesh->indices, mesh->triangleCount, mesh->vertexCount);
+        OptimizeVertexFetch(mesh);
+    }
+}
+
+MeshOptStats MeshOpt_mergeModel(Model *model, const int *cluster, int *mergedInto)
+{
+    MeshOptStats stats = { .meshesBefore = model->meshCount };
+    float missesBefore = 0.0f;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        stats.triangleCount += model->meshes[i].triangleCount;
+        missesBefore += MeshOpt_getAcmr(&model->meshes[i]) * model->meshes[i].triangleCount;
+    }
+
+    Mesh *meshes = MemAlloc(model->meshCount*sizeof(Mesh));
+    int *meshMaterial = MemAlloc(model->meshCount*sizeof(int));
+    int *members = MemAlloc(model->meshCount*sizeof(int));
+    unsigned char *done = MemAlloc(model->meshCount);
+    int meshCount = 0;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        if (done[i]) continue;
+        const Mesh *first = &model->meshes[i];
+        int memberCount = 0;
+        int vertexCount = 0;
+        members[memberCount++] = i;
+        vertexCount += first->vertexCount;
+        int mergeable = IsStaticMesh(first) && !(cluster && cluster[i] < 0);
+        for (int j = i + 1; j < model->meshCount && mergeable; j++)
+        {
+            const Mesh *mesh = &model->meshes[j];
+            if (done[j] || (cluster && cluster[j] != cluster[i]) || !IsStaticMesh(mesh)) continue;
+            if (model->meshMaterial[j] != model->meshMaterial[i] || !SameLayout(first, mesh)) continue;
+            if (vertexCount + mesh->vertexCount > MESHOPT_MAX_VERTICES) continue;
+            members[memberCount++] = j;
+            vertexCount += mesh->vertexCount;
+            done[j] = 1;
+        }
+
+        meshMaterial[meshCount] = model->meshMaterial[i];
+        for (int k = 0; k < memberCount && mergedInto; k++) mergedInto[members[k]] = meshCount;
+        if (memberCount == 1)
+        {
+            meshes[meshCount++] = *first;
+            continue;
+        }
+        meshes[meshCount++] = MergeMeshes(model->meshes, members, memberCount);
+        for (int k = 0; k < memberCount; k++) UnloadMesh(model->meshes[members[k]]);
+    }
+
+    float missesAfter = 0.0f;
+    for (int i = 0; i < meshCount; i++)
+    {
+        Mesh *mesh = &meshes[i];
+        OptimizeMesh(mesh);
+        missesAfter += MeshOpt_getAcmr(mesh) * mesh->triangleCount;
+    }
+
+    MemFree(done);
+    MemFree(members);
+    MemFree(model->meshes);
+    MemFree(model->meshMaterial);
+    model->meshes = meshes;
+    model->meshMaterial = meshMaterial;
+    model->meshCount = meshCount;
+
+    stats.meshesAfter = meshCount;
+    if (stats.triangleCount > 0)
+    {
+        stats.acmrBefore = missesBefore / stats.triangleCount;
+        stats.acmrAfter = missesAfter / stats.triangleCount;
+    }
+    return stats;
+}
+
+Mesh MeshOpt_mergeMeshes(const Mesh *meshes, int meshCount)
+{
+    int *members = MemAlloc(meshCount*sizeof(int));
+    for (int k = 0; k < meshCount; k++) members[k] = k;
+    Mesh merged = MergeMeshes(meshes, members, meshCount);
+    MemFree(members);
+    MemFree(merged.tangents);
+    merged.tangents = NULL;
+    OptimizeMesh(&merged);
+    return merged;
+}
+
+//----------------------------------------------------------------------------------
+// Simplification: edge collapses onto existing vertices, ordered by quadric error
+// (Garland & Heckbert). Vertices are never moved or created, so the texcoords of the
+// remaining vertices are exact.
+//----------------------------------------------------------------------------------
+
+typedef struct Quadric {
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+} Quadric;
+
+typedef struct Collapse {
+    float cost;
+    int vertex;
+} Collapse;
+
+static void QuadricAddPlane(Quadric *q, double a, double b, double c, double d)
+{
+    q->a2 += a*a; q->ab += a*b; q->ac += a*c; q->ad += a*d;
+    q->b2 += b*b; q->bc += b*c; q->bd += b*d;
+    q->c2 += c*c; q->cd += c*d;
+    q->d2 += d*d;
+}
+
+static void QuadricAdd(Quadric *q, const Quadric *other)
+{
+    q->a2 += other->a2; q->ab += other->ab; q->ac += other->ac; q->ad += other->ad;
+    q->b2 += other->b2; q->bc += other->bc; q->bd += other->bd;
+    q->c2 += other->c2; q->cd += other->cd;
+    q->d2 += other->d2;
+}
+
+// sum of the squared distances of p to the planes of the quadric
+static double QuadricError(const Quadric *q, const float *p)
+{
+    double x = p[0], y = p[1], z = p[2];
+    double error = q->a2*x*x + 2.0*q->ab*x*y + 2.0*q->ac*x*z + 2.0*q->ad*x
+        + q->b2*y*y + 2.0*q->bc*y*z + 2.0*q->bd*y
+        + q->c2*z*z + 2.0*q->cd*z
+        + q->d2;
+    return error > 0.0 ? error : 0.0;
+}
+
+static Vector3 TriangleNormal(const float *vertices, int a, int b, int c)
+{
+    Vector3 pa = { vertices[a*3], vertices[a*3 + 1], vertices[a*3 + 2] };
+    Vector3 pb = { vertices[b*3], vertices[b*3 + 1], vertices[b*3 + 2] };
+    Vector3 pc = { vertices[c*3], vertices[c*3 + 1], vertices[c*3 + 2] };
+    return Vector3CrossProduct(Vector3Subtract(pb, pa), Vector3Subtract(pc, pa));
+}
+
+static void BuildAdjacency(const int *indices, int triangleCount, int vertexCount, int *adjacencyStart, int *adjacency)
+{
+    memset(adjacencyStart, 0, (vertexCount + 1)*sizeof(int));
+    for (int i = 0; i < triangleCount*3; i++) adjacencyStart[indices[i] + 1]++;
+    for (int v = 0; v < vertexCount; v++) adjacencyStart[v + 1] += adjacencyStart[v];
+    for (int t = 0; t < triangleCount; t++)
+    {
+        for (int k = 0; k < 3; k++) adjacency[adjacencyStart[indices[t*3 + k]]++] = t;
+    }
+    // the starts were used as cursors and now hold the start of the next vertex
+    for (int v = vertexCount; v > 0; v--) adjacencyStart[v] = adjacencyStart[v - 1];
+    adjacencyStart[0] = 0;
+}
+
+static unsigned int HashPosition(const float *p)
+{
+    unsigned int bits[3];
+    memcpy(bits, p, sizeof(bits));
+    return (bits[0]*73856093u) ^ (bits[1]*19349663u) ^ (bits[2]*83492791u);
+}
+
+// Vertices with the same position are the wedges of one corner, split by a UV seam or a
+// hard edge; the game's models split almost every vertex this way. Collapses move whole
+// corners, so they are made on the welded mesh: welded maps every vertex to the first
+// wedge of its corner and nextWedge links the wedges of a corner in a ring.
+typedef struct WeldedMesh {
+    const Mesh *mesh;
+    int *indices;
+    int *adjacencyStart;
+    int *adjacency;
+    int *welded;
+    int *nextWedge;
+} WeldedMesh;
+
+static void WeldVertices(WeldedMesh *w)
+{
+    const Mesh *mesh = w->mesh;
+    int tableSize = 1;
+    while (tableSize < mesh->vertexCount*2) tableSize *= 2;
+    int *table = MemAlloc(tableSize*sizeof(int));
+    for (int i = 0; i < tableSize; i++) table[i] = -1;
+    for (int v = 0; v < mesh->vertexCount; v++)
+    {
+        const float *p = &mesh->vertices[v*3];
+        w->welded[v] = v;
+        w->nextWedge[v] = v;
+        for (unsigned int slot = HashPosition(p) & (tableSize - 1);; slot = (slot + 1) & (tableSize - 1))
+        {
+            int other = table[slot];
+            if (other < 0)
+            {
+                table[slot] = v;
+                break;
+            }
+            if (memcmp(&mesh->vertices[other*3], p, 3*sizeof(float)) == 0)
+            {
+                w->welded[v] = other;
+                w->nextWedge[v] = w->nextWedge[other];
+                w->nextWedge[other] = v;
+                break;
+            }
+        }
+    }
+    MemFree(table);
+}
+
+static int TriangleHasCorner(const WeldedMesh *w, int t, int corner)
+{
+    const int *tri = &w->indices[t*3];
+    return w->welded[tri[0]] == corner || w->welded[tri[1]] == corner || w->welded[tri[2]] == corner;
+}
+
+// Number of triangles that share the edge between two corners, up to 3. Triangles
+// over the same three corners count once: some models repeat every triangle, e.g.
+// flat-vector-scene-outlines.glb.
+static int CountEdgeTriangles(const WeldedMesh *w, int a, int b)
+{
+    int thirdCorners[3];
+    int count = 0;
+    int wedge = a;
+    do
+    {
+        for (int n = w->adjacencyStart[wedge]; n < w->adjacencyStart[wedge + 1] && count < 3; n++)
+        {
+            const int *tri = &w->indices[w->adjacency[n]*3];
+            if (!TriangleHasCorner(w, w->adjacency[n], b)) continue;
+            int third = -1;
+            for (int k = 0; k < 3; k++)
+            {
+                int corner = w->welded[tri[k]];
+                if (corner != a && corner != b) third = corner;
+            }
+            int seen = 0;
+            for (int i = 0; i < count; i++) seen |= thirdCorners[i] == third;
+            if (!seen) thirdCorners[count++] = third;
+        }
+        wedge = w->nextWedge[wedge];
+    } while (wedge != a && count < 3);
+    return count;
+}
+
+// Corners on a border or non-manifold edge of the welded mesh stay in place, the
+// outline of open meshes like the ground planes would shrink otherwise.
+static unsigned char *FindLockedCorners(const WeldedMesh *w)
+{
+    unsigned char *locked = MemAlloc(w->mesh->vertexCount);
+    for (int t = 0; t < w->mesh->triangleCount; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            int a = w->welded[w->indices[t*3 + k]];
+            int b = w->welded[w->indices[t*3 + (k + 1)%3]];
+            if (CountEdgeTriangles(w, a, b) != 2) locked[a] = locked[b] = 1;
+        }
+    }
+    return locked;
+}
+
+static float TexcoordDistanceSqr(const Mesh *mesh, int a, int b)
+{
+    if (mesh->texcoords == NULL) return 0.0f;
+    float du = mesh->texcoords[a*2] - mesh->texcoords[b*2];
+    float dv = mesh->texcoords[a*2 + 1] - mesh->texcoords[b*2 + 1];
+    return du*du + dv*dv;
+}
+
+// The wedge of corner v that a wedge of another corner moves to: the one with the nearest
+// texcoords, normals are not compared since no shader of the game reads them. Wedges
+// without triangles were collapsed before and are skipped; -1 if v has none left.
+static int FindWedgeTarget(const WeldedMesh *w, int wedge, int v)
+{
+    int target = -1;
+    float nearest = FLT_MAX;
+    int candidate = v;
+    do
+    {
+        float distance = TexcoordDistanceSqr(w->mesh, wedge, candidate);
+        if (w->adjacencyStart[candidate] < w->adjacencyStart[candidate + 1] && distance < nearest)
+        {
+            nearest = distance;
+            target = candidate;
+        }
+        candidate = w->nextWedge[candidate];
+    } while (candidate != v);
+    return target;
+}
+
+// Largest squared texcoord change of the wedges of corner u when it collapses onto corner
+// v. Across a UV seam this is the jump between the two sides, so the texcoord cost keeps
+// the seams, which outline.fs draws as outlines, while a seam can still shorten along itself.
+static float WedgeTexcoordChange(const WeldedMesh *w, int u, int v)
+{
+    float change = 0.0f;
+    int wedge = u;
+    do
+    {
+        if (w->adjacencyStart[wedge] < w->adjacencyStart[wedge + 1])
+        {
+            int target = FindWedgeTarget(w, wedge, v);
+            if (target < 0) return -1.0f;
+            float distance = TexcoordDistanceSqr(w->mesh, wedge, target);
+            if (distance > change) change = distance;
+        }
+        wedge = w->nextWedge[wedge];
+    } while (wedge != u);
+    return change;
+}
+
+// rejects collapses that turn a triangle of corner u over or into a sliver
+static int CollapseFlips(const WeldedMesh *w, int u, int v)
+{
+    const float *vertices = w->mesh->vertices;
+    int wedge = u;
+    do
+    {
+        for (int n = w->adjacencyStart[wedge]; n < w->adjacencyStart[wedge + 1]; n++)
+        {
+            int t = w->adjacency[n];
+            if (TriangleHasCorner(w, t, v)) continue;
+            const int *tri = &w->indices[t*3];
+            int moved[3];
+            for (int k = 0; k < 3; k++) moved[k] = tri[k] == wedge ? v : tri[k];
+            Vector3 before = TriangleNormal(vertices, tri[0], tri[1], tri[2]);
+            Vector3 after = TriangleNormal(vertices, moved[0], moved[1], moved[2]);
+            float lengths = Vector3Length(before)*Vector3Length(after);
+            if (lengths == 0.0f || Vector3DotProduct(before, after) < 0.2f*lengths) return 1;
+        }
+        wedge = w->nextWedge[wedge];
+    } while (wedge != u);
+    return 0;
+}
+
+static int CompareCollapses(const void *a, const void *b)
+{
+    const Collapse *collapseA = a;
+    const Collapse *collapseB = b;
+    if (collapseA->cost != collapseB->cost) return collapseA->cost < collapseB->cost ? -1 : 1;
+    return collapseA->vertex - collapseB->vertex;
+}
+
+// new mesh with the used vertices of the source in the order of their first use
+static Mesh CopyUsedVertices(const Mesh *source, const unsigned short *indices, int triangleCount)
+{
+    int *remap = MemAlloc(source->vertexCount*sizeof(int));
+    for (int v = 0; v < source->vertexCount; v++) remap[v] = -1;
+    Mesh mesh = { .triangleCount = triangleCount };
+    mesh.indices = MemAlloc(triangleCount*3*sizeof(unsigned short));
+    for (int i = 0; i < triangleCount*3; i++)
+    {
+        if (remap[indices[i]] < 0) remap[indices[i]] = mesh.vertexCount++;
+        mesh.indices[i] = (unsigned short)remap[indices[i]];
+    }
+
+    mesh.vertices = MemAlloc(mesh.vertexCount*3*sizeof(float));
+    mesh.texcoords = AllocLike(source->texcoords, mesh.vertexCount*2*sizeof(float));
+    mesh.texcoords2 = AllocLike(source->texcoords2, mesh.vertexCount*2*sizeof(float));
+    mesh.normals = AllocLike(source->normals, mesh.vertexCount*3*sizeof(float));
+    mesh.colors = AllocLike(source->colors, mesh.vertexCount*4);
+    for (int v = 0; v < source->vertexCount; v++)
+    {
+        int to = remap[v];
+        if (to < 0) continue;
+        CopyVertexArray(mesh.vertices, &source->vertices[v*3], to, 1, 3*sizeof(float));
+        if (source->texcoords) CopyVertexArray(mesh.texcoords, &source->texcoords[v*2], to, 1, 2*sizeof(float));
+        if (source->texcoords2) CopyVertexArray(mesh.texcoords2, &source->texcoords2[v*2], to, 1, 2*sizeof(float));
+        if (source->normals) CopyVertexArray(mesh.normals, &source->normals[v*3], to, 1, 3*sizeof(float));
+        if (source->colors) CopyVertexArray(mesh.colors, &source->colors[v*4], to, 1, 4);
+    }
+    MemFree(remap);
+    return mesh;
+}
+
+Mesh MeshOpt_simplify(const Mesh *mesh, int targetTriangles, float maxError, float *resultError)
+{
+    *resultError = 0.0f;
+    if (!IsStaticMesh(mesh) || mesh->indices == NULL || mesh->vertexCount <= 0 || mesh->triangleCount <= targetTriangles) return (Mesh){0};
+
+    int vertexCount = mesh->vertexCount;
+    int triangleCount = mesh->triangleCount;
+    WeldedMesh w = { .mesh = mesh };
+    w.indices = MemAlloc(triangleCount*3*sizeof(int));
+    for (int i = 0; i < triangleCount*3; i++) w.indices[i] = mesh->indices[i];
+    w.adjacencyStart = MemAlloc((vertexCount + 1)*sizeof(int));
+    w.adjacency = MemAlloc(triangleCount*3*sizeof(int));
+    w.welded = MemAlloc(vertexCount*sizeof(int));
+    w.nextWedge = MemAlloc(vertexCount*sizeof(int));
+    BuildAdjacency(w.indices, triangleCount, vertexCount, w.adjacencyStart, w.adjacency);
+    WeldVertices(&w);
+    unsigned char *locked = FindLockedCorners(&w);
+
+    // one quadric per corner, with the planes of the triangles of all its wedges
+    Quadric *quadrics = MemAlloc(vertexCount*sizeof(Quadric));
+    for (int t = 0; t < triangleCount; t++)
+    {
+        const int *tri = &w.indices[t*3];
+        Vector3 normal = TriangleNormal(mesh->vertices, tri[0], tri[1], tri[2]);
+        float length = Vector3Length(normal);
+        if (length == 0.0f) continue;
+        normal = Vector3Scale(normal, 1.0f/length);
+        const float *p = &mesh->vertices[tri[0]*3];
+        double d = -(normal.x*p[0] + normal.y*p[1] + normal.z*p[2]);
+        for (int k = 0; k < 3; k++) QuadricAddPlane(&quadrics[w.welded[tri[k]]], normal.x, normal.y, normal.z, d);
+    }
+
+    // a texcoord change of the full texture costs as much as a move by the mesh size
+    BoundingBox bounds = GetMeshBoundingBox(*mesh);
+    float size = Vector3Distance(bounds.min, bounds.max);
+    float uvWeight = size*size;
+    double maxCost = (double)maxError*maxError;
+    double usedCost = 0.0;
+
+    Collapse *collapses = MemAlloc(vertexCount*sizeof(Collapse));
+    int *collapseTarget = MemAlloc(vertexCount*sizeof(int));
+    int *remap = MemAlloc(vertexCount*sizeof(int));
+    unsigned char *touched = MemAlloc(vertexCount);
+    while (triangleCount > targetTriangles)
+    {
+        // cheapest collapse of every corner onto one of its neighbors
+        for (int v = 0; v < vertexCount; v++)
+        {
+            collapses[v] = (Collapse){ .cost = FLT_MAX, .vertex = v };
+            collapseTarget[v] = -1;
+            remap[v] = v;
+        }
+        for (int i = 0; i < triangleCount*3; i++)
+        {
+            int u = w.welded[w.indices[i]];
+            if (locked[u]) continue;
+            for (int k = 1; k < 3; k++)
+            {
+                int v = w.welded[w.indices[i - i%3 + (i%3 + k)%3]];
+                double cost = QuadricError(&quadrics[u], &mesh->vertices[v*3]);
+                if (cost > maxCost || cost >= collapses[u].cost) continue;
+                float uvChange = WedgeTexcoordChange(&w, u, v);
+                if (uvChange < 0.0f) continue;
+                cost += uvChange*uvWeight;
+                if (cost <= maxCost && cost < collapses[u].cost)
+                {
+                    collapses[u].cost = (float)cost;
+                    collapseTarget[u] = v;
+                }
+            }
+        }
+        qsort(collapses, vertexCount, sizeof(Collapse), CompareCollapses);
+
+        // A collapse removes about two triangles. The pass stops a little above the cost of
+        // the collapses it needs, the expensive ones wait for the next pass, where the cheap
+        // ones that were blocked below have been made.
+        int needed = (triangleCount - targetTriangles + 1)/2;
+        float passLimit = collapses[(needed < vertexCount ? needed : vertexCount) - 1].cost*1.5f;
+
+        // collapses in one pass must not share triangles, so the adjacency stays valid
+        memset(touched, 0, vertexCount);
+        int collapseCount = 0;
+        int removed = 0;
+        for (int n = 0; n < vertexCount && triangleCount - removed > targetTriangles; n++)
+        {
+            int u = collapses[n].vertex;
+            int v = collapseTarget[u];
+            if (v < 0 || (collapseCount > 0 && collapses[n].cost > passLimit)) break;
+            if (touched[u] || touched[v]) continue;
+            if (CollapseFlips(&w, u, v)) continue;
+
+            int wedge = u;
+            do
+            {
+                if (w.adjacencyStart[wedge] < w.adjacencyStart[wedge + 1]) remap[wedge] = FindWedgeTarget(&w, wedge, v);
+                for (int a = w.adjacencyStart[wedge]; a < w.adjacencyStart[wedge + 1]; a++)
+                {
+                    int t = w.adjacency[a];
+                    for (int k = 0; k < 3; k++) touched[w.welded[w.indices[t*3 + k]]] = 1;
+                    removed += TriangleHasCorner(&w, t, v);
+                }
+                wedge = w.nextWedge[wedge];
+            } while (wedge != u);
+            QuadricAdd(&quadrics[v], &quadrics[u]);
+            if (collapses[n].cost > usedCost) usedCost = collapses[n].cost;
+            collapseCount++;
+        }
+        if (collapseCount == 0) break;
+
+        // wedges of one corner may now meet in a triangle, so degenerate ones are found by corner
+        int kept = 0;
+        for (int t = 0; t < triangleCount; t++)
+        {
+            int a = remap[w.indices[t*3]], b = remap[w.indices[t*3 + 1]], c = remap[w.indices[t*3 + 2]];
+            if (w.welded[a] == w.welded[b] || w.welded[b] == w.welded[c] || w.welded[a] == w.welded[c]) continue;
+            w.indices[kept*3] = a;
+            w.indices[kept*3 + 1] = b;
+            w.indices[kept*3 + 2] = c;
+            kept++;
+        }
+        triangleCount = kept;
+        BuildAdjacency(w.indices, triangleCount, vertexCount, w.adjacencyStart, w.adjacency);
+    }
+
+    Mesh result = {0};
+    if (triangleCount < mesh->triangleCount)
+    {
+        unsigned short *shortIndices = MemAlloc(triangleCount*3*sizeof(unsigned short));
+        for (int i = 0; i < triangleCount*3; i++) shortIndices[i] = (unsigned short)w.indices[i];
+        OptimizeVertexCache(shortIndices, triangleCount, vertexCount);
+        result = CopyUsedVertices(mesh, shortIndices, triangleCount);
+        MemFree(shortIndices);
+        *resultError = (float)sqrt(usedCost);
+    }
+
+    MemFree(touched);
+    MemFree(remap);
+    MemFree(collapseTarget);
+    MemFree(collapses);
+    MemFree(quadrics);
+    MemFree(locked);
+    MemFree(w.nextWedge);
+    MemFree(w.welded);
+    MemFree(w.adjacency);
+    MemFree(w.adjacencyStart);
+    MemFree(w.indices);
+    return result;
+}
+
+//----------------------------------------------------------------------------------
+// Compact vertex layout
+//----------------------------------------------------------------------------------
+
+int MeshOpt_getFloatStride(const Mesh *mesh)
+{
+    return 3*sizeof(float)
+        + (mesh->texcoords ? 2*sizeof(float) : 0)
+        + (mesh->texcoords2 ? 2*sizeof(float) : 0)
+        + (mesh->normals ? 3*sizeof(float) : 0)
+        + (mesh->tangents ? 4*sizeof(float) : 0)
+        + (mesh->colors ? 4 : 0);
+}
+
+static int GetTexcoordSize()
+{
+    return MESHOPT_HALF_TEXCOORDS ? 2*sizeof(unsigned short) : 2*sizeof(float);
+}
+
+int MeshOpt_getCompactStride(const Mesh *mesh)
+{
+    // the position is padded to 4 components to keep the attributes 4 byte aligned
+    return 4*sizeof(unsigned short)
+        + (mesh->texcoords ? GetTexcoordSize() : 0)
+        + (mesh->texcoords2 ? GetTexcoordSize() : 0)
+        + (mesh->colors ? 4 : 0);
+}
+
+static unsigned short FloatToHalf(float value)
+{
+    union { float f; unsigned int u; } bits = { value };
+    unsigned int sign = (bits.u >> 16) & 0x8000;
+    int exponent = (int)((bits.u >> 23) & 0xff) - 127 + 15;
+    unsigned int mantissa = bits.u & 0x7fffff;
+    if (exponent >= 31) return (unsigned short)(sign | 0x7c00);
+    if (exponent <= 0)
+    {
+        // subnormal
+        if (exponent < -10) return (unsigned short)sign;
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        unsigned int half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1) half++;
+        return (unsigned short)(sign | half);
+    }
+    unsigned int half = sign | (exponent << 10) | (mantissa >> 13);
+    // round to nearest, a carry into the exponent is still the right value
+    if (mantissa & 0x1000) half++;
+    return (unsigned short)half;
+}
+
+static void WriteTexcoords(unsigned char *dst, const float *uv)
+{
+    if (MESHOPT_HALF_TEXCOORDS)
+    {
+        unsigned short half[2] = { FloatToHalf(uv[0]), FloatToHalf(uv[1]) };
+        memcpy(dst, half, sizeof(half));
+    }
+    else memcpy(dst, uv, 2*sizeof(float));
+}
+
+static void SetTexcoordAttribute(int location, int stride, int offset)
+{
+    if (MESHOPT_HALF_TEXCOORDS) rlSetVertexAttribute(location, 2, MESHOPT_GL_HALF_FLOAT, false, stride, (void*)(size_t)offset);
+    else rlSetVertexAttribute(location, 2, RL_FLOAT, false, stride, (void*)(size_t)offset);
+    rlEnableVertexAttribute(location);
+}
+
+static void UnloadGpuBuffers(Mesh *mesh)
+{
+    rlUnloadVertexArray(mesh->vaoId);
+    if (mesh->vboId != NULL)
+    {
+        for (int i = 0; i < MESHOPT_VERTEX_BUFFERS; i++)
+        {
+            if (mesh->vboId[i] != 0) rlUnloadVertexBuffer(mesh->vboId[i]);
+        }
+    }
+    MemFree(mesh->vboId);
+    mesh->vboId = NULL;
+    mesh->vaoId = 0;
+}
+
+void MeshOpt_uploadFloat(Mesh *mesh)
+{
+    // UploadMesh skips meshes that have a vertex array
+    UnloadGpuBuffers(mesh);
+    UploadMesh(mesh, false);
+}
+
+int MeshOpt_uploadCompact(Mesh *mesh, Matrix *dequantize)
+{
+    if (!IsStaticMesh(mesh) || mesh->vertexCount == 0) return 0;
+
+    unsigned int vaoId = rlLoadVertexArray();
+    if (vaoId == 0) return 0;
+
+    BoundingBox bounds = GetMeshBoundingBox(*mesh);
+    Vector3 extent = Vector3Subtract(bounds.max, bounds.min);
+    float scale[3] = {
+        extent.x > 0.0f ? 65535.0f / extent.x : 0.0f,
+        extent.y > 0.0f ? 65535.0f / extent.y : 0.0f,
+        extent.z > 0.0f ? 65535.0f / extent.z : 0.0f,
+    };
+    float origin[3] = { bounds.min.x, bounds.min.y, bounds.min.z };
+
+    int stride = MeshOpt_getCompactStride(mesh);
+    int texcoordOffset = 4*sizeof(unsigned short);
+    int texcoord2Offset = texcoordOffset + (mesh->texcoords ? GetTexcoordSize() : 0);
+    int colorOffset = texcoord2Offset + (mesh->texcoords2 ? GetTexcoordSize() : 0);
+    unsigned char *data = MemAlloc(mesh->vertexCount*stride);
+    for (int v = 0; v < mesh->vertexCount; v++)
+    {
+        unsigned char *vertex = data + v*stride;
+        unsigned short position[4] = { 0 };
+        for (int k = 0; k < 3; k++)
+        {
+            float q = (mesh->vertices[v*3 + k] - origin[k]) * scale[k] + 0.5f;
+            position[k] = (unsigned short)Clamp(q, 0.0f, 65535.0f);
+        }
+        memcpy(vertex, position, sizeof(position));
+        if (mesh->texcoords) WriteTexcoords(vertex + texcoordOffset, &mesh->texcoords[v*2]);
+        if (mesh->texcoords2) WriteTexcoords(vertex + texcoord2Offset, &mesh->texcoords2[v*2]);
+        if (mesh->colors) memcpy(vertex + colorOffset, &mesh->colors[v*4], 4);
+    }
+
+    // the float buffers of UploadMesh are replaced as a whole
+    UnloadGpuBuffers(mesh);
+    mesh->vboId = MemAlloc(MESHOPT_VERTEX_BUFFERS*sizeof(unsigned int));
+    mesh->vaoId = vaoId;
+    rlEnableVertexArray(vaoId);
+    mesh->vboId[MESHOPT_VBO_VERTICES] = rlLoadVertexBuffer(data, mesh->vertexCount*stride, false);
+    if (mesh->vboId[MESHOPT_VBO_VERTICES] == 0)
+    {
+        rlDisableVertexArray();
+        UnloadGpuBuffers(mesh);
+        MemFree(data);
+        return 0;
+    }
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, MESHOPT_GL_UNSIGNED_SHORT, true, stride, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+    if (mesh->texcoords) SetTexcoordAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, stride, texcoordOffset);
+    if (mesh->texcoords2) SetTexcoordAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, stride, texcoord2Offset);
+    if (mesh->colors)
+    {
+        rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, stride, (void*)(size_t)colorOffset);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+    }
+    else
+    {
+        // same defaults as UploadMesh
+        float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, white, SHADER_ATTRIB_VEC4, 4);
+        rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+    }
+    float normal[3] = { 1.0f, 1.0f, 1.0f };
+    rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, normal, SHADER_ATTRIB_VEC3, 3);
+    rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+    rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT);
+    if (mesh->indices)
+    {
+        mesh->vboId[MESHOPT_VBO_INDICES] = rlLoadVertexBufferElement(mesh->indices, mesh->triangleCount*3*sizeof(unsigned short), false);
+    }
+    rlDisableVertexArray();
+    MemFree(data);
+
+    // stored value / 65535 * extent + min
+    *dequantize = MatrixMultiply(MatrixScale(extent.x, extent.y, extent.z), MatrixTranslate(bounds.min.x, bounds.min.y, bounds.min.z));
+    return 1;
+}
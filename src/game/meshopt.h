@@ -0,0 +1,64 @@
+#ifndef __GAME_MESHOPT_H__
+#define __GAME_MESHOPT_H__
+
+#include "raylib.h"
+
+// Load time optimizations for the static meshes of a model, see ModelImport_process.
+//
+// MeshOpt_mergeModel merges the meshes of a cluster that share a material into one mesh
+// and reorders the triangles of every mesh for the post transform vertex cache (Forsyth's
+// linear speed algorithm), then the vertices in the order of their first use so that
+// vertex fetches walk through memory linearly. The CPU arrays stay float, they are
+// what the soft rasterizer and the bundle writer read.
+//
+// MeshOpt_simplify builds the levels of detail, see ModelImport_selectLod.
+//
+// MeshOpt_uploadCompact replaces the GPU copy of a mesh with one interleaved buffer:
+// positions as 16 bit values relative to the mesh bounds, texcoords as half floats
+// and no normals or tangents, which none of the game's shaders read. The positions
+// are expanded by the returned matrix, which the caller folds into the model matrix
+// so that every shader, including raylib's default one, works unchanged.
+
+// entries of the FIFO cache that is simulated for the ACMR statistics
+#define MESHOPT_FIFO_SIZE 16
+
+typedef struct MeshOptStats {
+    int meshesBefore, meshesAfter;
+    int triangleCount;
+    // average number of vertices transformed per triangle
+    float acmrBefore, acmrAfter;
+} MeshOptStats;
+
+// Merges and reorders the meshes of the model in place. cluster (meshCount entries or
+// NULL for one cluster) limits merging to meshes with the same id; meshes with a
+// negative id, e.g. those drawn instanced, are not merged but still reordered.
+// mergedInto (meshCount entries or NULL) receives the new index of each mesh; members
+// keep their order inside a merged mesh. The vertex arrays must belong to the model,
+// not to a mapped bundle.
+MeshOptStats MeshOpt_mergeModel(Model *model, const int *cluster, int *mergedInto);
+// New mesh with copies of the meshes merged and reordered like MeshOpt_mergeModel does,
+// e.g. the levels of detail of the members of a merged mesh. The meshes must have the
+// same layout apart from tangents, which the copy has none of, like MeshOpt_simplify's,
+// and together fit the 16 bit indices.
+Mesh MeshOpt_mergeMeshes(const Mesh *meshes, int meshCount);
+// dequantize receives the matrix that maps the stored positions to mesh space; returns 0
+// if the compact layout could not be used, e.g. when vertex arrays are not supported, and
+// the mesh is left as it was or without GPU buffers; use MeshOpt_uploadFloat then
+int MeshOpt_uploadCompact(Mesh *mesh, Matrix *dequantize);
+// replaces the GPU copy of the mesh with the float layout of UploadMesh, e.g. one whose
+// arrays were merged or reordered after the model was loaded
+void MeshOpt_uploadFloat(Mesh *mesh);
+// GPU bytes per vertex of the float layout UploadMesh uses and of the compact one
+int MeshOpt_getFloatStride(const Mesh *mesh);
+int MeshOpt_getCompactStride(const Mesh *mesh);
+// Simplified copy of an indexed mesh with at most targetTriangles triangles, built by
+// collapsing edges onto existing vertices while the quadric error stays below maxError
+// (in mesh units). Vertices with the same position move together, vertices on a border
+// are locked and UV seams are kept by a texcoord cost. resultError receives the
+// largest error of a collapse that was made; returns a mesh without triangles if
+// nothing could be removed. The copy has no GPU buffers and no tangents.
+Mesh MeshOpt_simplify(const Mesh *mesh, int targetTriangles, float maxError, float *resultError);
+// average cache miss ratio of the mesh's triangle order
+float MeshOpt_getAcmr(const Mesh *mesh);
+
+#endif
@@ -0,0 +1,663 @@
+#include "modelimport.h"
+#include "meshopt.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include "alloctrack.h"
+#include <math.h>
+#include <float.h>
+#include <stddef.h>
+#include <string.h>
+
+#define MODEL_IMPORT_MAX_MODELS 16
+// slot of texcoords2 in Mesh.vboId, same layout as raylib's UploadMesh
+#define MESH_VBO_TEXCOORD2 5
+// only the first few problems are logged per model, the rest are counted
+#define MODEL_IMPORT_MAX_REPORTS 8
+// allowed position error of an instance, relative to the size of the mesh
+#define MODEL_IMPORT_INSTANCE_EPSILON 1e-4f
+// largest error of a level of detail, relative to the size of the mesh
+#define MODEL_IMPORT_LOD_MAX_ERROR 0.05f
+// meshes with fewer triangles get no levels of detail
+#define MODEL_IMPORT_LOD_MIN_TRIANGLES 64
+// largest bounds diagonal of a cluster of merged meshes, relative to the model's
+#define MODEL_IMPORT_CLUSTER_SIZE 0.25f
+
+static ModelImportInfo _modelImportInfos[MODEL_IMPORT_MAX_MODELS];
+static int _modelImportInfoCount;
+
+static int DitherBlockOf(float u, float v)
+{
+    int bx = (int)floorf((u - floorf(u)) * DITHER_BLOCKS_PER_ROW);
+    int by = (int)floorf((v - floorf(v)) * DITHER_BLOCKS_PER_ROW);
+    if (bx >= DITHER_BLOCKS_PER_ROW) bx = DITHER_BLOCKS_PER_ROW - 1;
+    if (by >= DITHER_BLOCKS_PER_ROW) by = DITHER_BLOCKS_PER_ROW - 1;
+    return by * DITHER_BLOCKS_PER_ROW + bx;
+}
+
+// u in [1,2) marks FX triangles (see dither.fs), v is written to the G-buffer and must stay in [0,1]
+static int IsDitherUvValid(float u, float v)
+{
+    return u >= 0.0f && u < 2.0f && v >= 0.0f && v <= 1.0f;
+}
+
+static void UploadTexcoords2(Mesh *mesh)
+{
+    if (mesh->vboId == NULL) return;
+    if (mesh->vboId[MESH_VBO_TEXCOORD2] != 0)
+    {
+        rlUpdateVertexBuffer(mesh->vboId[MESH_VBO_TEXCOORD2], mesh->texcoords2, mesh->vertexCount*2*sizeof(float), 0);
+        return;
+    }
+
+    rlEnableVertexArray(mesh->vaoId);
+    mesh->vboId[MESH_VBO_TEXCOORD2] = rlLoadVertexBuffer(mesh->texcoords2, mesh->vertexCount*2*sizeof(float), false);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, 2, RL_FLOAT, 0, 0, 0);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2);
+    rlDisableVertexArray();
+}
+
+static void BakeDitherBlocks(ModelImportInfo *info, int meshIndex, Mesh *mesh)
+{
+    if (mesh->texcoords == NULL)
+    {
+        TraceLog(LOG_WARNING, "ModelImport: %s mesh %d has no texcoords", info->name, meshIndex);
+        info->invalidUvCount++;
+        return;
+    }
+
+    if (mesh->texcoords2 == NULL)
+    {
+        mesh->texcoords2 = MemAlloc(mesh->vertexCount*2*sizeof(float));
+    }
+    // -1: not yet assigned to a block
+    for (int i = 0; i < mesh->vertexCount*2; i++) mesh->texcoords2[i] = -1.0f;
+
+    for (int t = 0; t < mesh->triangleCount; t++)
+    {
+        int idx[3];
+        for (int k = 0; k < 3; k++) idx[k] = mesh->indices ? mesh->indices[t*3 + k] : t*3 + k;
+
+        float cu = 0.0f, cv = 0.0f;
+        for (int k = 0; k < 3; k++)
+        {
+            cu += mesh->texcoords[idx[k]*2] / 3.0f;
+            cv += mesh->texcoords[idx[k]*2 + 1] / 3.0f;
+        }
+        int block = DitherBlockOf(cu, cv);
+        info->usedBlocks[block >> 3] |= 1 << (block & 7);
+
+        for (int k = 0; k < 3; k++)
+        {
+            float u = mesh->texcoords[idx[k]*2];
+            float v = mesh->texcoords[idx[k]*2 + 1];
+            // vertices on a block border are fine as long as the triangle's interior
+            // stays in one block, so test a point pulled slightly towards the center
+            int vertexBlock = DitherBlockOf(u + (cu - u)*0.001f, v + (cv - v)*0.001f);
+            if (!IsDitherUvValid(u, v) || vertexBlock != block)
+            {
+                if (info->invalidUvCount++ < MODEL_IMPORT_MAX_REPORTS)
+                {
+                    TraceLog(LOG_WARNING, "ModelImport: %s mesh %d triangle %d: uv (%.4f, %.4f) is outside of dither block %d",
+                        info->name, meshIndex, t, u, v, block);
+                }
+            }
+
+            float bu = (float)(block % DITHER_BLOCKS_PER_ROW) / DITHER_BLOCKS_PER_ROW;
+            float bv = (float)(block / DITHER_BLOCKS_PER_ROW) / DITHER_BLOCKS_PER_ROW;
+            float *baked = &mesh->texcoords2[idx[k]*2];
+            if (baked[0] >= 0.0f && (baked[0] != bu || baked[1] != bv))
+            {
+                // vertex is shared by triangles of different blocks
+                if (info->blockConflictCount++ < MODEL_IMPORT_MAX_REPORTS)
+                {
+                    TraceLog(LOG_WARNING, "ModelImport: %s mesh %d vertex %d is shared by different dither blocks",
+                        info->name, meshIndex, idx[k]);
+                }
+            }
+            baked[0] = bu;
+            baked[1] = bv;
+        }
+    }
+
+    for (int i = 0; i < mesh->vertexCount*2; i++)
+    {
+        if (mesh->texcoords2[i] < 0.0f) mesh->texcoords2[i] = 0.0f;
+    }
+}
+
+static int SameArray(const void *a, const void *b, int size)
+{
+    if (a == NULL || b == NULL) return a == b;
+    return memcmp(a, b, size) == 0;
+}
+
+static Vector3 GetVertex(const Mesh *mesh, int index)
+{
+    return (Vector3){ mesh->vertices[index*3], mesh->vertices[index*3 + 1], mesh->vertices[index*3 + 2] };
+}
+
+// matrix with the columns x, y, z and the translation t
+static Matrix MatrixFromColumns(Vector3 x, Vector3 y, Vector3 z, Vector3 t)
+{
+    return (Matrix){
+        x.x, y.x, z.x, t.x,
+        x.y, y.y, z.y, t.y,
+        x.z, y.z, z.z, t.z,
+        0.0f, 0.0f, 0.0f, 1.0f,
+    };
+}
+
+// Checks if mesh is a copy of source moved by a similarity transform (rotation,
+// uniform scale, translation). Topology and all vertex attributes except positions and
+// normals must match exactly; the transform is derived from a frame of three vertices
+// and then verified against every position.
+static int FindInstanceTransform(const Mesh *source, const Mesh *mesh, Matrix *transform)
+{
+    if (source->vertexCount != mesh->vertexCount || source->triangleCount != mesh->triangleCount) return 0;
+    int vertexCount = mesh->vertexCount;
+    if (vertexCount < 3 || source->vertices == NULL || mesh->vertices == NULL) return 0;
+    if (!SameArray(source->indices, mesh->indices, mesh->triangleCount*3*sizeof(unsigned short))
+        || !SameArray(source->texcoords, mesh->texcoords, vertexCount*2*sizeof(float))
+        || !SameArray(source->texcoords2, mesh->texcoords2, vertexCount*2*sizeof(float))
+        || !SameArray(source->colors, mesh->colors, vertexCount*4))
+    {
+        return 0;
+    }
+
+    BoundingBox bounds = GetMeshBoundingBox(*source);
+    float size = Vector3Length(Vector3Subtract(bounds.max, bounds.min));
+    float epsilon = MODEL_IMPORT_INSTANCE_EPSILON*(size > 1.0f ? size : 1.0f);
+
+    // two edges from the first vertex that span a triangle of usable area
+    Vector3 p0 = GetVertex(source, 0);
+    int i1 = -1, i2 = -1;
+    for (int i = 1; i < vertexCount && i1 < 0; i++)
+    {
+        if (Vector3Length(Vector3Subtract(GetVertex(source, i), p0)) > epsilon) i1 = i;
+    }
+    for (int i = 1; i < vertexCount && i1 >= 0 && i2 < 0; i++)
+    {
+        Vector3 normal = Vector3CrossProduct(Vector3Subtract(GetVertex(source, i1), p0), Vector3Subtract(GetVertex(source, i), p0));
+        if (Vector3Length(normal) > epsilon*size) i2 = i;
+    }
+    if (i2 < 0) return 0;
+
+    // the third axis is the edge normal scaled like the edges, so it maps correctly
+    // under rotation and uniform scale
+    Vector3 e1 = Vector3Subtract(GetVertex(source, i1), p0);
+    Vector3 e2 = Vector3Subtract(GetVertex(source, i2), p0);
+    Vector3 e3 = Vector3Scale(Vector3CrossProduct(e1, e2), 1.0f/Vector3Length(e1));
+    Vector3 q0 = GetVertex(mesh, 0);
+    Vector3 f1 = Vector3Subtract(GetVertex(mesh, i1), q0);
+    Vector3 f2 = Vector3Subtract(GetVertex(mesh, i2), q0);
+    float f1Length = Vector3Length(f1);
+    if (f1Length <= epsilon) return 0;
+    Vector3 f3 = Vector3Scale(Vector3CrossProduct(f1, f2), 1.0f/f1Length);
+
+    Vector3 zero = { 0.0f, 0.0f, 0.0f };
+    Matrix sourceFrame = MatrixInvert(MatrixFromColumns(e1, e2, e3, zero));
+    Matrix linear = MatrixMultiply(sourceFrame, MatrixFromColumns(f1, f2, f3, zero));
+    Vector3 offset = Vector3Subtract(q0, Vector3Transform(p0, linear));
+    Matrix result = MatrixMultiply(linear, MatrixTranslate(offset.x, offset.y, offset.z));
+
+    for (int i = 0; i < vertexCount; i++)
+    {
+        Vector3 moved = Vector3Transform(GetVertex(source, i), result);
+        if (Vector3Length(Vector3Subtract(moved, GetVertex(mesh, i))) > epsilon) return 0;
+    }
+    *transform = result;
+    return 1;
+}
+
+static void FindInstances(ModelImportInfo *info, Model *model)
+{
+    info->instanceSource = MemAlloc(model->meshCount*sizeof(int));
+    info->instanceTransform = MemAlloc(model->meshCount*sizeof(Matrix));
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        info->instanceSource[i] = -1;
+        info->instanceTransform[i] = MatrixIdentity();
+        for (int j = 0; j < i; j++)
+        {
+            // only first copies and unique meshes can become sources
+            if (info->instanceSource[j] >= 0 && info->instanceSource[j] != j) continue;
+            if (model->meshMaterial[i] != model->meshMaterial[j]) continue;
+            if (!FindInstanceTransform(&model->meshes[j], &model->meshes[i], &info->instanceTransform[i])) continue;
+            if (info->instanceSource[j] < 0) info->instanceGroupCount++, info->instancedMeshCount++;
+            info->instanceSource[j] = j;
+            info->instanceSource[i] = j;
+            info->instancedMeshCount++;
+            break;
+        }
+    }
+}
+
+static void LogInstances(ModelImportInfo *info, Model *model)
+{
+    if (info->instanceGroupCount == 0) return;
+    TraceLog(LOG_INFO, "ModelImport: %s: %d meshes drawn as %d instanced groups, draw calls %d -> %d", info->name,
+        info->instancedMeshCount, info->instanceGroupCount, model->meshCount,
+        model->meshCount - info->instancedMeshCount + info->instanceGroupCount);
+}
+
+static MeshLod *GetLod(const ModelImportInfo *info, int meshIndex, int level)
+{
+    return &info->lods[meshIndex*(MODEL_IMPORT_MAX_LODS - 1) + level - 1];
+}
+
+static void FreeLods(ModelImportInfo *info)
+{
+    for (int i = 0; i < info->lodMeshCount; i++)
+    {
+        for (int level = 1; level <= info->lodCount[i]; level++) UnloadMesh(GetLod(info, i, level)->mesh);
+    }
+    MemFree(info->lods);
+    MemFree(info->lodCount);
+    info->lods = NULL;
+    info->lodCount = NULL;
+    info->lodMeshCount = 0;
+}
+
+static void FreeMeshInfo(ModelImportInfo *info)
+{
+    MemFree(info->meshBounds);
+    MemFree(info->instanceSource);
+    MemFree(info->instanceTransform);
+    MemFree(info->meshDequantize);
+    info->meshBounds = NULL;
+    info->instanceSource = NULL;
+    info->instanceTransform = NULL;
+    info->meshDequantize = NULL;
+    info->instanceGroupCount = 0;
+    info->instancedMeshCount = 0;
+}
+
+// per mesh data, recomputed when the meshes of the model change
+static void FindMeshInfo(ModelImportInfo *info, Model *model)
+{
+    FreeMeshInfo(info);
+    info->meshBounds = MemAlloc(model->meshCount * sizeof(BoundingBox));
+    info->meshDequantize = MemAlloc(model->meshCount * sizeof(Matrix));
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        info->meshBounds[i] = GetMeshBoundingBox(model->meshes[i]);
+        info->meshDequantize[i] = MatrixIdentity();
+    }
+    FindInstances(info, model);
+}
+
+static int GetBufferBytes(const Mesh *mesh, int stride)
+{
+    return mesh->vertexCount*stride + (mesh->indices ? mesh->triangleCount*3*(int)sizeof(unsigned short) : 0);
+}
+
+// GPU buffer bytes of the model with the float layout of UploadMesh, and the vertex bytes
+// fetched per triangle
+static int MeasureFloatVertexData(const Model *model, float *fetchBytes)
+{
+    int bytes = 0;
+    float fetched = 0.0f;
+    int triangleCount = 0;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        const Mesh *mesh = &model->meshes[i];
+        int stride = MeshOpt_getFloatStride(mesh);
+        bytes += GetBufferBytes(mesh, stride);
+        fetched += MeshOpt_getAcmr(mesh)*mesh->triangleCount*stride;
+        triangleCount += mesh->triangleCount;
+    }
+    *fetchBytes = triangleCount > 0 ? fetched / triangleCount : 0.0f;
+    return bytes;
+}
+
+static int IsInstanceCopy(const ModelImportInfo *info, int meshIndex)
+{
+    return info->instanceSource[meshIndex] >= 0 && info->instanceSource[meshIndex] != meshIndex;
+}
+
+// levels of detail of every mesh on the CPU, see UploadLods
+static void SimplifyMeshes(ModelImportInfo *info, Model *model)
+{
+    info->lodMeshCount = model->meshCount;
+    info->lodCount = MemAlloc(model->meshCount*sizeof(int));
+    info->lods = MemAlloc(model->meshCount*(MODEL_IMPORT_MAX_LODS - 1)*sizeof(MeshLod));
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        const Mesh *mesh = &model->meshes[i];
+        // copies are drawn with the levels of their instance source
+        if (IsInstanceCopy(info, i) || mesh->triangleCount < MODEL_IMPORT_LOD_MIN_TRIANGLES) continue;
+
+        BoundingBox bounds = info->meshBounds[i];
+        float maxError = Vector3Distance(bounds.min, bounds.max)*MODEL_IMPORT_LOD_MAX_ERROR;
+        int triangleCount = mesh->triangleCount;
+        for (int level = 1; level < MODEL_IMPORT_MAX_LODS; level++)
+        {
+            // every level is simplified from the full mesh, so its error is measured against it
+            float error = 0.0f;
+            Mesh simplified = MeshOpt_simplify(mesh, triangleCount/2, maxError, &error);
+            if (simplified.triangleCount == 0 || simplified.triangleCount > triangleCount*3/4)
+            {
+                // not worth another level
+                UnloadMesh(simplified);
+                break;
+            }
+            *GetLod(info, i, level) = (MeshLod){ .mesh = simplified, .dequantize = MatrixIdentity(), .error = error };
+            info->lodCount[i] = level;
+            triangleCount = simplified.triangleCount;
+        }
+    }
+}
+
+// Groups the unique meshes of each material into clusters that are merged into one mesh.
+// A level of detail is picked by the distance to the bounds of the merged mesh, so a
+// cluster grows by the mesh that enlarges it least while it stays small next to the
+// model. Returns the cluster of each mesh, -1 for the ones that stay separate.
+static int *FindClusters(ModelImportInfo *info, Model *model, int *clusterCount)
+{
+    BoundingBox modelBounds = info->meshBounds[0];
+    for (int i = 1; i < model->meshCount; i++)
+    {
+        modelBounds.min = Vector3Min(modelBounds.min, info->meshBounds[i].min);
+        modelBounds.max = Vector3Max(modelBounds.max, info->meshBounds[i].max);
+    }
+    float maxSize = Vector3Distance(modelBounds.min, modelBounds.max)*MODEL_IMPORT_CLUSTER_SIZE;
+
+    int *cluster = MemAlloc(model->meshCount*sizeof(int));
+    for (int i = 0; i < model->meshCount; i++) cluster[i] = -1;
+    *clusterCount = 0;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        if (cluster[i] >= 0 || info->instanceSource[i] >= 0) continue;
+        BoundingBox bounds = info->meshBounds[i];
+        int memberCount = 1;
+        cluster[i] = *clusterCount;
+        for (;;)
+        {
+            int best = -1;
+            float bestSize = maxSize;
+            BoundingBox bestBounds = bounds;
+            for (int j = i + 1; j < model->meshCount; j++)
+            {
+                if (cluster[j] >= 0 || info->instanceSource[j] >= 0 || model->meshMaterial[j] != model->meshMaterial[i]) continue;
+                BoundingBox grown = { Vector3Min(bounds.min, info->meshBounds[j].min), Vector3Max(bounds.max, info->meshBounds[j].max) };
+                float size = Vector3Distance(grown.min, grown.max);
+                if (size > bestSize) continue;
+                best = j;
+                bestSize = size;
+                bestBounds = grown;
+            }
+            if (best < 0) break;
+            cluster[best] = *clusterCount;
+            bounds = bestBounds;
+            memberCount++;
+        }
+        if (memberCount > 1) (*clusterCount)++;
+        else cluster[i] = -1;
+    }
+    return cluster;
+}
+
+// coarsest level of a source mesh whose error is at most maxError, 0 for the mesh itself
+static int GetLevelWithin(const ModelImportInfo *info, int meshIndex, float maxError)
+{
+    int level = 0;
+    for (int k = 1; k <= info->lodCount[meshIndex]; k++)
+    {
+        if (GetLod(info, meshIndex, k)->error <= maxError) level = k;
+    }
+    return level;
+}
+
+// Replaces the levels of the source meshes by the ones of the merged meshes. Each level
+// of a merged mesh allows a larger error and merges the coarsest level of every member
+// within it; the smallest member error that removes a quarter of the triangles is taken.
+// sourceMeshes holds copies of the members of clusters, whose own meshes are gone.
+static void MergeLods(ModelImportInfo *info, Model *model, const int *mergedInto, const Mesh *sourceMeshes, int sourceCount)
+{
+    ModelImportInfo source = *info;
+    info->lodMeshCount = model->meshCount;
+    info->lodCount = MemAlloc(model->meshCount*sizeof(int));
+    info->lods = MemAlloc(model->meshCount*(MODEL_IMPORT_MAX_LODS - 1)*sizeof(MeshLod));
+
+    int *members = MemAlloc(sourceCount*sizeof(int));
+    Mesh *parts = MemAlloc(sourceCount*sizeof(Mesh));
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        if (IsInstanceCopy(info, i)) continue;
+        int memberCount = 0;
+        for (int s = 0; s < sourceCount; s++)
+        {
+            if (mergedInto[s] == i) members[memberCount++] = s;
+        }
+
+        int triangleCount = model->meshes[i].triangleCount;
+        float maxError = -1.0f;
+        for (int level = 1; level < MODEL_IMPORT_MAX_LODS;)
+        {
+            float nextError = FLT_MAX;
+            for (int m = 0; m < memberCount; m++)
+            {
+                for (int k = 1; k <= source.lodCount[members[m]]; k++)
+                {
+                    float error = GetLod(&source, members[m], k)->error;
+                    if (error > maxError && error < nextError) nextError = error;
+                }
+            }
+            if (nextError == FLT_MAX) break;
+            maxError = nextError;
+
+            int levelTriangles = 0;
+            float error = 0.0f;
+            for (int m = 0; m < memberCount; m++)
+            {
+                int s = members[m];
+                int k = GetLevelWithin(&source, s, maxError);
+                if (k > 0)
+                {
+                    const MeshLod *lod = GetLod(&source, s, k);
+                    parts[m] = lod->mesh;
+                    if (lod->error > error) error = lod->error;
+                }
+                else parts[m] = memberCount == 1 ? model->meshes[i] : sourceMeshes[s];
+                levelTriangles += parts[m].triangleCount;
+            }
+            // not worth a level yet
+            if (levelTriangles > triangleCount*3/4) continue;
+
+            *GetLod(info, i, level) = (MeshLod){ .mesh = MeshOpt_mergeMeshes(parts, memberCount), .dequantize = MatrixIdentity(), .error = error };
+            info->lodCount[i] = level++;
+            triangleCount = levelTriangles;
+        }
+    }
+    MemFree(parts);
+    MemFree(members);
+    FreeLods(&source);
+}
+
+static void UploadLods(ModelImportInfo *info, Model *model)
+{
+    int levelTriangles[MODEL_IMPORT_MAX_LODS] = { 0 };
+    int lodMeshes = 0;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        levelTriangles[0] += model->meshes[i].triangleCount;
+        int triangleCount = model->meshes[i].triangleCount;
+        for (int level = 1; level <= info->lodCount[i]; level++)
+        {
+            MeshLod *lod = GetLod(info, i, level);
+            if (!MeshOpt_uploadCompact(&lod->mesh, &lod->dequantize)) MeshOpt_uploadFloat(&lod->mesh);
+        }
+        if (info->lodCount[i] > 0) lodMeshes++;
+        // meshes without a level count with their last one
+        for (int level = 1; level < MODEL_IMPORT_MAX_LODS; level++)
+        {
+            if (level <= info->lodCount[i]) triangleCount = GetLod(info, i, level)->mesh.triangleCount;
+            levelTriangles[level] += triangleCount;
+        }
+    }
+
+    if (lodMeshes == 0) return;
+    TraceLog(LOG_INFO, "ModelImport: %s: levels of detail for %d meshes, triangles %d / %d / %d / %d", info->name,
+        lodMeshes, levelTriangles[0], levelTriangles[1], levelTriangles[2], levelTriangles[3]);
+}
+
+static void UploadCompactMeshes(ModelImportInfo *info, Model *model, int bytesBefore, float fetchBefore)
+{
+    int bytes = 0;
+    float fetched = 0.0f;
+    int triangleCount = 0;
+    int compactCount = 0;
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        Mesh *mesh = &model->meshes[i];
+        int stride = MeshOpt_getFloatStride(mesh);
+        if (MeshOpt_uploadCompact(mesh, &info->meshDequantize[i]))
+        {
+            stride = MeshOpt_getCompactStride(mesh);
+            compactCount++;
+        }
+        // merged meshes have no GPU copy yet and reordered ones a stale one
+        else MeshOpt_uploadFloat(mesh);
+        bytes += GetBufferBytes(mesh, stride);
+        fetched += MeshOpt_getAcmr(mesh)*mesh->triangleCount*stride;
+        triangleCount += mesh->triangleCount;
+    }
+    float fetchBytes = triangleCount > 0 ? fetched / triangleCount : 0.0f;
+    TraceLog(LOG_INFO, "ModelImport: %s: %d of %d meshes compacted, GPU buffers %.1f -> %.1f KB, vertex fetch per triangle %.1f -> %.1f bytes",
+        info->name, compactCount, model->meshCount, bytesBefore / 1024.0f, bytes / 1024.0f, fetchBefore, fetchBytes);
+}
+
+static ModelImportInfo *ResetInfo(Model *model, const char *name)
+{
+    ModelImportInfo *info = ModelImport_getInfo(model);
+    if (info == NULL)
+    {
+        if (_modelImportInfoCount == MODEL_IMPORT_MAX_MODELS)
+        {
+            TraceLog(LOG_ERROR, "ModelImport: too many models");
+            return NULL;
+        }
+        info = &_modelImportInfos[_modelImportInfoCount++];
+    }
+    FreeLods(info);
+    FreeMeshInfo(info);
+    *info = (ModelImportInfo){ .model = model, .name = name };
+    FindMeshInfo(info, model);
+    return info;
+}
+
+ModelImportInfo *ModelImport_register(Model *model, const char *name, int ditherBaked)
+{
+    ModelImportInfo *info = ResetInfo(model, name);
+    if (info == NULL) return NULL;
+    info->ditherBaked = ditherBaked;
+
+    float fetchBytes = 0.0f;
+    int bytes = MeasureFloatVertexData(model, &fetchBytes);
+    UploadCompactMeshes(info, model, bytes, fetchBytes);
+    LogInstances(info, model);
+    SimplifyMeshes(info, model);
+    UploadLods(info, model);
+    return info;
+}
+
+ModelImportInfo *ModelImport_process(Model *model, const char *name)
+{
+    ModelImportInfo *info = ResetInfo(model, name);
+    if (info == NULL) return NULL;
+
+    for (int i = 0; i < model->meshCount; i++)
+    {
+        BakeDitherBlocks(info, i, &model->meshes[i]);
+    }
+
+    info->ditherBaked = info->invalidUvCount == 0 && info->blockConflictCount == 0;
+    if (info->ditherBaked)
+    {
+        for (int i = 0; i < model->meshCount; i++) UploadTexcoords2(&model->meshes[i]);
+    }
+
+    int blockCount = 0;
+    for (int i = 0; i < (int)sizeof(info->usedBlocks); i++)
+    {
+        for (int b = info->usedBlocks[i]; b; b >>= 1) blockCount += b & 1;
+    }
+    TraceLog(info->ditherBaked ? LOG_INFO : LOG_WARNING, "ModelImport: %s: %d meshes, %d dither blocks used, %d invalid uvs, %d block conflicts%s",
+        name, model->meshCount, blockCount, info->invalidUvCount, info->blockConflictCount,
+        info->ditherBaked ? "" : " - falling back to per-fragment block lookup");
+
+    // The levels of detail are simplified from the source meshes, then merged along with
+    // the meshes of each cluster; instanced meshes stay separate with their own levels.
+    float fetchBytes = 0.0f;
+    int bytes = MeasureFloatVertexData(model, &fetchBytes);
+    SimplifyMeshes(info, model);
+    int clusterCount = 0;
+    int *cluster = FindClusters(info, model, &clusterCount);
+    int sourceCount = model->meshCount;
+    Mesh *sourceMeshes = MemAlloc(sourceCount*sizeof(Mesh));
+    for (int i = 0; i < sourceCount; i++)
+    {
+        if (cluster[i] >= 0) sourceMeshes[i] = MeshOpt_mergeMeshes(&model->meshes[i], 1);
+    }
+    int *mergedInto = MemAlloc(sourceCount*sizeof(int));
+    MeshOptStats stats = MeshOpt_mergeModel(model, cluster, mergedInto);
+    FindMeshInfo(info, model);
+    MergeLods(info, model, mergedInto, sourceMeshes, sourceCount);
+    for (int i = 0; i < sourceCount; i++)
+    {
+        if (cluster[i] >= 0) UnloadMesh(sourceMeshes[i]);
+    }
+    MemFree(sourceMeshes);
+    MemFree(mergedInto);
+    MemFree(cluster);
+    TraceLog(LOG_INFO, "ModelImport: %s: meshes merged %d -> %d in %d clusters, ACMR %.2f -> %.2f (%d triangles)",
+        name, stats.meshesBefore, stats.meshesAfter, clusterCount, stats.acmrBefore, stats.acmrAfter, stats.triangleCount);
+
+    UploadCompactMeshes(info, model, bytes, fetchBytes);
+    LogInstances(info, model);
+    UploadLods(info, model);
+    return info;
+}
+
+ModelImportInfo *ModelImport_getInfo(Model *model)
+{
+    for (int i = 0; i < _modelImportInfoCount; i++)
+    {
+        if (_modelImportInfos[i].model == model) return &_modelImportInfos[i];
+    }
+    return NULL;
+}
+
+int ModelImport_selectLod(const ModelImportInfo *info, int meshIndex, float pixelsPerUnit)
+{
+    if (info->lodCount == NULL) return 0;
+    int level = 0;
+    while (level < info->lodCount[meshIndex] && GetLod(info, meshIndex, level + 1)->error*pixelsPerUnit <= MODEL_IMPORT_LOD_PIXEL_ERROR)
+    {
+        level++;
+    }
+    return level;
+}
+
+Mesh ModelImport_getLodMesh(const ModelImportInfo *info, int meshIndex, int level, Matrix *dequantize)
+{
+    if (level == 0)
+    {
+        *dequantize = info->meshDequantize[meshIndex];
+        return info->model->meshes[meshIndex];
+    }
+    const MeshLod *lod = GetLod(info, meshIndex, level);
+    *dequantize = lod->dequantize;
+    return lod->mesh;
+}
+
+void ModelImport_clear()
+{
+    for (int i = 0; i < _modelImportInfoCount; i++)
+    {
+        FreeLods(&_modelImportInfos[i]);
+        FreeMeshInfo(&_modelImportInfos[i]);
+        _modelImportInfos[i] = (ModelImportInfo){0};
+    }
+    _modelImportInfoCount = 0;
+}
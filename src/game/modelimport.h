@@ -0,0 +1,69 @@
+#ifndef __GAME_MODELIMPORT_H__
+#define __GAME_MODELIMPORT_H__
+
+#include "raylib.h"
+
+// the dither texture is 128x128 pixels, divided into 16x16 blocks of 8x8 pixels
+#define DITHER_BLOCKS_PER_ROW 16
+// levels of detail per mesh, including the mesh itself as level 0
+#define MODEL_IMPORT_MAX_LODS 4
+// a coarser level is drawn while its error covers at most this many pixels of the render target
+#define MODEL_IMPORT_LOD_PIXEL_ERROR 0.75f
+
+typedef struct MeshLod {
+    Mesh mesh;
+    Matrix dequantize;
+    // geometric error of the level in mesh units
+    float error;
+} MeshLod;
+
+typedef struct ModelImportInfo {
+    Model *model;
+    const char *name;
+    // texcoords2 of every vertex holds the offset of its dither block, see DITHER_BAKED in dither.fs
+    int ditherBaked;
+    int invalidUvCount;
+    int blockConflictCount;
+    // one bit per dither block referenced by the model's triangles
+    unsigned char usedBlocks[DITHER_BLOCKS_PER_ROW * DITHER_BLOCKS_PER_ROW / 8];
+    // local space bounds of each mesh, used for culling
+    BoundingBox *meshBounds;
+    // Meshes with the same vertex data and material as an earlier mesh, up to a transform,
+    // are drawn as instances of that mesh. instanceSource is the index of the first copy
+    // (the mesh itself for the first copy) or -1 for unique meshes; instanceTransform
+    // maps the first copy onto the mesh.
+    int *instanceSource;
+    Matrix *instanceTransform;
+    int instanceGroupCount;
+    int instancedMeshCount;
+    // Meshes use the compact vertex layout of MeshOpt_uploadCompact; the GPU positions
+    // are mapped to mesh space by meshDequantize, which goes in front of the model
+    // matrix. The CPU arrays are unchanged, the soft rasterizer uses the model matrix alone.
+    Matrix *meshDequantize;
+    // Simplified copies of each mesh for distant views, see MeshOpt_simplify; those of a
+    // merged mesh are merged from the levels of its members. Level k of
+    // mesh i, 1 <= k <= lodCount[i], is lods[i*(MODEL_IMPORT_MAX_LODS - 1) + k - 1]. Only
+    // unique meshes and the first copies of instanced ones have levels.
+    MeshLod *lods;
+    int *lodCount;
+    int lodMeshCount;
+} ModelImportInfo;
+
+// Processes a freshly loaded model: validates UVs against the dither block layout
+// and bakes the block of each triangle into the vertex data, builds the levels of detail,
+// merges the nearby meshes that share a material and reorders them for the vertex cache
+// (see meshopt.h). Also computes the mesh bounds and finds repeated meshes that can be
+// drawn instanced.
+ModelImportInfo *ModelImport_process(Model *model, const char *name);
+// registers a model whose vertex data was processed before, e.g. one loaded from the bundle;
+// only its GPU buffers are replaced by the compact layout
+ModelImportInfo *ModelImport_register(Model *model, const char *name, int ditherBaked);
+ModelImportInfo *ModelImport_getInfo(Model *model);
+// coarsest level of the mesh whose error covers at most MODEL_IMPORT_LOD_PIXEL_ERROR pixels
+// when one mesh unit covers pixelsPerUnit pixels; 0 is the mesh itself
+int ModelImport_selectLod(const ModelImportInfo *info, int meshIndex, float pixelsPerUnit);
+// mesh of a level and the matrix that expands its GPU positions, see meshDequantize
+Mesh ModelImport_getLodMesh(const ModelImportInfo *info, int meshIndex, int level, Matrix *dequantize);
+void ModelImport_clear();
+
+#endif
@@ -0,0 +1,210 @@
+#include "picking.h"
+#include "readback.h"
+#include <raymath.h>
+#include <math.h>
+
+// every slot of the readback ring may hold a request, plus the one being made
+#define PICKING_PENDING_SIZE (READBACK_RING_SIZE + 1)
+
+typedef struct PickRequest {
+    Camera3D camera;
+    // mouse pixel and top left corner of the region that was read, in gbuffer coordinates
+    int pixelX, pixelY;
+    int regionX, regionY;
+    int targetWidth, targetHeight;
+    int isClick;
+    unsigned int frame;
+} PickRequest;
+
+typedef struct Picking {
+    PickRequest requests[PICKING_PENDING_SIZE];
+    int nextRequest;
+    unsigned int frame;
+    // id read for the frame objectIdFrame, attached to the gbuffer result of that frame
+    int objectId;
+    unsigned int objectIdFrame;
+    PickResult hover;
+    PickResult click;
+    int clickCount;
+    double frameCostMs;
+    PickingStats stats;
+} Picking;
+
+static Picking _picking;
+
+// the slot is only taken when the readback accepted the request, see Submit
+static PickRequest *NextRequest()
+{
+    return &_picking.requests[_picking.nextRequest];
+}
+
+static void Submit(RenderTexture2D target, Rectangle region, ReadbackCallback callback)
+{
+    if (Readback_requestTexture(target, region, callback, NextRequest()))
+    {
+        _picking.nextRequest = (_picking.nextRequest + 1) % PICKING_PENDING_SIZE;
+    }
+}
+
+// view depth, uv.y and FX flag of a gbuffer pixel; 0 for the white background
+static int DecodePixel(const unsigned char *p, PickResult *result)
+{
+    if (p[0] == 255 && p[1] == 255 && p[2] == 255) return 0;
+    // red and blue are the high and low byte of depth * 32 * 256, clamped to 16 bits
+    result->depth = (p[0]*256.0f + p[2]) / (256.0f*32.0f);
+    result->uvY = p[1] / 255.0f;
+    result->isFx = p[1] == 255;
+    return 1;
+}
+
+// point at the given view depth on the ray through the center of a gbuffer pixel
+static Vector3 GetWorldPosition(const PickRequest *request, int pixelX, int pixelY, float depth)
+{
+    Camera3D camera = request->camera;
+    Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+    Vector3 up = Vector3CrossProduct(right, forward);
+    float aspect = (float)request->targetWidth / (float)request->targetHeight;
+    float x = (pixelX + 0.5f) / request->targetWidth * 2.0f - 1.0f;
+    float y = 1.0f - (pixelY + 0.5f) / request->targetHeight * 2.0f;
+    if (camera.projection == CAMERA_ORTHOGRAPHIC)
+    {
+        float top = camera.fovy * 0.5f;
+        Vector3 origin = Vector3Add(camera.position, Vector3Add(Vector3Scale(right, x*top*aspect), Vector3Scale(up, y*top)));
+        return Vector3Add(origin, Vector3Scale(forward, depth));
+    }
+    float tanHalf = tanf(camera.fovy * 0.5f * DEG2RAD);
+    // the ray is one unit long along the view direction, so the depth scales it to the surface
+    Vector3 ray = Vector3Add(forward, Vector3Add(Vector3Scale(right, x*tanHalf*aspect), Vector3Scale(up, y*tanHalf)));
+    return Vector3Add(camera.position, Vector3Scale(ray, depth));
+}
+
+static void ReceiveObjectId(Image image, void *userData)
+{
+    double start = GetTime();
+    const PickRequest *request = userData;
+    const unsigned char *p = image.data;
+    // the id target is cleared to zero, ids are stored plus one
+    _picking.objectId = (p[0] | p[1] << 8 | p[2] << 16) - 1;
+    _picking.objectIdFrame = request->frame;
+    _picking.frameCostMs += (GetTime() - start) * 1000.0;
+}
+
+static void ReceiveGbuffer(Image image, void *userData)
+{
+    double start = GetTime();
+    const PickRequest *request = userData;
+    const unsigned char *pixels = image.data;
+    PickResult result = { .objectId = PICKING_NO_OBJECT, .frame = request->frame };
+
+    // the mouse pixel, or the nearest surface pixel around it
+    int bestDistance = -1;
+    int bestX = 0, bestY = 0;
+    for (int y = 0; y < image.height; y++)
+    {
+        for (int x = 0; x < image.width; x++)
+        {
+            PickResult pixel;
+            if (!DecodePixel(pixels + (y*image.width + x)*4, &pixel)) continue;
+            int dx = request->regionX + x - request->pixelX;
+            int dy = request->regionY + y - request->pixelY;
+            int distance = dx*dx + dy*dy;
+            if (bestDistance >= 0 && distance >= bestDistance) continue;
+            bestDistance = distance;
+            bestX = request->regionX + x;
+            bestY = request->regionY + y;
+            result.depth = pixel.depth;
+            result.uvY = pixel.uvY;
+            result.isFx = pixel.isFx;
+        }
+    }
+    if (bestDistance >= 0)
+    {
+        result.hit = 1;
+        result.position = GetWorldPosition(request, bestX, bestY, result.depth);
+        // the id pass covers the mouse pixel only
+        if (bestDistance == 0 && _picking.objectIdFrame == request->frame) result.objectId = _picking.objectId;
+    }
+
+    _picking.hover = result;
+    if (request->isClick)
+    {
+        _picking.click = result;
+        _picking.clickCount++;
+    }
+    _picking.stats.results++;
+    _picking.frameCostMs += (GetTime() - start) * 1000.0;
+}
+
+void Picking_request(RenderTexture2D gbuffer, Vector2 pixel, Camera3D camera, int isClick)
+{
+    double start = GetTime();
+    PickRequest *request = NextRequest();
+    *request = (PickRequest){
+        .camera = camera,
+        .pixelX = (int)pixel.x,
+        .pixelY = (int)pixel.y,
+        .regionX = (int)pixel.x - PICKING_RADIUS,
+        .regionY = (int)pixel.y - PICKING_RADIUS,
+        .targetWidth = gbuffer.texture.width,
+        .targetHeight = gbuffer.texture.height,
+        .isClick = isClick,
+        .frame = _picking.frame,
+    };
+    // the region is clipped at the target's edges
+    if (request->regionX < 0) request->regionX = 0;
+    if (request->regionY < 0) request->regionY = 0;
+    Rectangle region = { (float)request->regionX, (float)request->regionY,
+        (float)((int)pixel.x + PICKING_RADIUS + 1 - request->regionX), (float)((int)pixel.y + PICKING_RADIUS + 1 - request->regionY) };
+    _picking.stats.requests++;
+    Submit(gbuffer, region, ReceiveGbuffer);
+    _picking.frameCostMs += (GetTime() - start) * 1000.0;
+}
+
+void Picking_requestObjectId(RenderTexture2D idTarget)
+{
+    double start = GetTime();
+    PickRequest *request = NextRequest();
+    *request = (PickRequest){ .frame = _picking.frame };
+    Submit(idTarget, (Rectangle){ 0.0f, 0.0f, 1.0f, 1.0f }, ReceiveObjectId);
+    _picking.frameCostMs += (GetTime() - start) * 1000.0;
+}
+
+Color Picking_getIdColor(int objectId)
+{
+    unsigned int value = (unsigned int)objectId + 1;
+    return (Color){ value & 0xff, (value >> 8) & 0xff, (value >> 16) & 0xff, 255 };
+}
+
+void Picking_update()
+{
+    _picking.frame++;
+    _picking.stats.lastCostMs = (float)_picking.frameCostMs;
+    if (_picking.stats.lastCostMs > _picking.stats.maxCostMs) _picking.stats.maxCostMs = _picking.stats.lastCostMs;
+    _picking.frameCostMs = 0.0;
+}
+
+PickResult Picking_getHover()
+{
+    return _picking.hover;
+}
+
+PickResult Picking_getClick(int *clickCount)
+{
+    if (clickCount) *clickCount = _picking.clickCount;
+    return _picking.click;
+}
+
+PickingStats Picking_getStats()
+{
+    return _picking.stats;
+}
+
+void Picking_reset()
+{
+    _picking = (Picking){
+        .objectIdFrame = (unsigned int)-1,
+        .hover.objectId = PICKING_NO_OBJECT,
+        .click.objectId = PICKING_NO_OBJECT,
+    };
+}
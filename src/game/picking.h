@@ -0,0 +1,65 @@
+#ifndef __GAME_PICKING_H__
+#define __GAME_PICKING_H__
+
+#include "raylib.h"
+
+// Picking of the surface under the mouse from the scene's packed G-buffer (_target, see
+// dither.fs): red and blue hold the view depth as 16 bit fixed point, green the uv.y
+// of the surface, which selects the color row of the palette texture, with FX surfaces
+// saturated to 1. The depth saturates 8 units in front of the camera; farther surfaces
+// are hits at that depth. Only the (2*PICKING_RADIUS+1)^2 pixels around the mouse are
+// read back and decoded. With the readback ring (readback.h, on in the desktop release
+// build and game.dll) the result arrives one or two frames after the request; the CPU
+// pays for flushing the batched draws, queueing the copy and decoding, which PickingStats
+// measures, and does not wait for the GPU. Without the ring every request reads the
+// whole target and waits for it, so then requests should only be made on clicks.
+//
+// Object ids are optional: the caller renders the ids of the pixel under the mouse into
+// a 1x1 target with Picking_getIdColor and passes it to Picking_requestObjectId in the
+// same frame as Picking_request; the id is then attached to the result of that frame.
+
+// pixels on each side of the mouse that are searched for a surface when the mouse
+// pixel itself shows the background
+#define PICKING_RADIUS 2
+#define PICKING_NO_OBJECT -1
+
+typedef struct PickResult {
+    int hit;
+    // distance along the view direction, in world units
+    float depth;
+    // color row of the palette texture
+    float uvY;
+    int isFx;
+    Vector3 position;
+    // PICKING_NO_OBJECT without the id pass or over the background
+    int objectId;
+    // Picking_update frame in which the pixels were rendered
+    unsigned int frame;
+} PickResult;
+
+typedef struct PickingStats {
+    int requests;
+    int results;
+    // CPU time of picking in the last frame: requests and decoding
+    float lastCostMs;
+    float maxCostMs;
+} PickingStats;
+
+// queues a read around pixel, in gbuffer image coordinates; camera is the camera the
+// gbuffer was rendered with and isClick marks the result as a click
+void Picking_request(RenderTexture2D gbuffer, Vector2 pixel, Camera3D camera, int isClick);
+// queues the read of the 1x1 id target rendered for the same pixel
+void Picking_requestObjectId(RenderTexture2D idTarget);
+// color to draw object id with in the id pass; ids are 0 to 2^24-2
+Color Picking_getIdColor(int objectId);
+// latches the cost of the last frame, once per frame after Readback_update
+void Picking_update();
+// latest surface under the mouse
+PickResult Picking_getHover();
+// result of the latest click; clickCount increments with every click result so that
+// script actions can tell a new click from the one they have already handled
+PickResult Picking_getClick(int *clickCount);
+PickingStats Picking_getStats();
+void Picking_reset();
+
+#endif
@@ -0,0 +1,272 @@
+#include "readback.h"
+#include "rlgl.h"
+#include "alloctrack.h"
+#include <string.h>
+
+#if defined(GAME_ASYNC_READBACK)
+#include "glentry.h"
+#include <external/glad.h>
+
+typedef struct ReadbackSlot {
+    unsigned int buffer;
+    int capacity;
+    GLsync fence;
+    int width, height;
+    unsigned int requestFrame;
+    ReadbackCallback callback;
+    void *userData;
+} ReadbackSlot;
+#endif
+
+typedef struct Readback {
+#if defined(GAME_ASYNC_READBACK)
+    // slots complete in the order they were requested: oldest is the first one in flight
+    ReadbackSlot slots[READBACK_RING_SIZE];
+    int oldest;
+    int pendingCount;
+    // the entry points were looked up, and whether the context has all of them
+    int isRingChecked;
+    int isRingAvailable;
+#endif
+    // top down copy handed to the callbacks
+    unsigned char *pixels;
+    int pixelCapacity;
+    unsigned int frame;
+    ReadbackStats stats;
+} Readback;
+
+static Readback _readback;
+
+static void AddStallSample(double ms)
+{
+    _readback.stats.lastStallMs = (float)ms;
+    if (ms > _readback.stats.maxStallMs) _readback.stats.maxStallMs = (float)ms;
+}
+
+// whole target for an empty region, otherwise clipped to the target
+static Rectangle ClipRegion(Rectangle region, int width, int height)
+{
+    if (region.width <= 0.0f || region.height <= 0.0f) return (Rectangle){ 0.0f, 0.0f, (float)width, (float)height };
+    float x0 = region.x < 0.0f ? 0.0f : region.x;
+    float y0 = region.y < 0.0f ? 0.0f : region.y;
+    float x1 = region.x + region.width > width ? width : region.x + region.width;
+    float y1 = region.y + region.height > height ? height : region.y + region.height;
+    return (Rectangle){ (float)(int)x0, (float)(int)y0, (float)((int)x1 - (int)x0), (float)((int)y1 - (int)y0) };
+}
+
+static unsigned char *GetPixelBuffer(int size)
+{
+    if (size > _readback.pixelCapacity)
+    {
+        _readback.pixelCapacity = size;
+        _readback.pixels = MemRealloc(_readback.pixels, size);
+    }
+    return _readback.pixels;
+}
+
+// copies rows of RGBA8 pixels; bottomUp flips them to top down
+static void Deliver(const unsigned char *src, int srcWidth, int x, int y, int width, int height, int bottomUp,
+    ReadbackCallback callback, void *userData)
+{
+    unsigned char *dst = GetPixelBuffer(width*height*4);
+    for (int row = 0; row < height; row++)
+    {
+        int srcRow = y + (bottomUp ? height - 1 - row : row);
+        memcpy(dst + row*width*4, src + (srcRow*srcWidth + x)*4, width*4);
+    }
+    _readback.stats.completed++;
+    callback((Image){ .data = dst, .width = width, .height = height, .mipmaps = 1, .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 }, userData);
+}
+
+// synchronous path: waits for the GPU inside the Load* call
+static int ReadNow(Image image, Rectangle region, int bottomUp, double start, ReadbackCallback callback, void *userData)
+{
+    // the image and its conversion are allocated for every read
+    AllocTrack_allowFrame("synchronous readback");
+    if (image.data == NULL) return 0;
+    if (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    AddStallSample((GetTime() - start)*1000.0);
+    // bottom up images are addressed from their last row
+    int y = bottomUp ? image.height - (int)region.y - (int)region.height : (int)region.y;
+    Deliver(image.data, image.width, (int)region.x, y, (int)region.width, (int)region.height, bottomUp, callback, userData);
+    _readback.stats.lastLatencyFrames = 0;
+    UnloadImage(image);
+    return 1;
+}
+
+#if defined(GAME_ASYNC_READBACK)
+// the ring needs sync objects (GL 3.2); without them reads fall back to the synchronous path
+static int IsRingAvailable()
+{
+    Readback *rb = &_readback;
+    if (rb->isRingChecked) return rb->isRingAvailable;
+    rb->isRingChecked = 1;
+    GlEntry_load();
+    rb->isRingAvailable = glGenBuffers && glBindBuffer && glBufferData && glBindFramebuffer && glMapBufferRange
+        && glUnmapBuffer && glFenceSync && glClientWaitSync && glDeleteSync && glFlush;
+    if (!rb->isRingAvailable) TraceLog(LOG_WARNING, "Readback: no sync objects, reading synchronously");
+    return rb->isRingAvailable;
+}
+
+static int QueueRead(unsigned int framebuffer, int targetHeight, Rectangle region, ReadbackCallback callback, void *userData)
+{
+    Readback *rb = &_readback;
+    if (rb->pendingCount == READBACK_RING_SIZE)
+    {
+        rb->stats.dropped++;
+        return 0;
+    }
+
+    double start = GetTime();
+    // the read must see the draws that are still batched
+    rlDrawRenderBatchActive();
+    ReadbackSlot *slot = &rb->slots[(rb->oldest + rb->pendingCount) % READBACK_RING_SIZE];
+    int width = (int)region.width;
+    int height = (int)region.height;
+    if (slot->buffer == 0) glGenBuffers(1, &slot->buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+    if (width*height*4 > slot->capacity)
+    {
+        slot->capacity = width*height*4;
+        glBufferData(GL_PIXEL_PACK_BUFFER, slot->capacity, NULL, GL_STREAM_READ);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // GL rows start at the bottom
+    glReadPixels((int)region.x, targetHeight - (int)region.y - height, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // Readback_update polls the fence without flushing, so the fence must reach the GPU now;
+    // else it may never signal and a caller waiting for a free slot would spin forever
+    glFlush();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot->width = width;
+    slot->height = height;
+    slot->requestFrame = rb->frame;
+    slot->callback = callback;
+    slot->userData = userData;
+    rb->pendingCount++;
+    AddStallSample((GetTime() - start)*1000.0);
+    return 1;
+}
+#endif
+
+int Readback_requestTexture(RenderTexture2D target, Rectangle region, ReadbackCallback callback, void *userData)
+{
+    _readback.stats.requests++;
+    region = ClipRegion(region, target.texture.width, target.texture.height);
+    if (region.width <= 0.0f || region.height <= 0.0f) return 0;
+#if defined(GAME_ASYNC_READBACK)
+    if (IsRingAvailable()) return QueueRead(target.id, target.texture.height, region, callback, userData);
+#endif
+    double start = GetTime();
+    return ReadNow(LoadImageFromTexture(target.texture), region, 1, start, callback, userData);
+}
+
+int Readback_requestScreen(Rectangle region, ReadbackCallback callback, void *userData)
+{
+    _readback.stats.requests++;
+    region = ClipRegion(region, GetRenderWidth(), GetRenderHeight());
+    if (region.width <= 0.0f || region.height <= 0.0f) return 0;
+#if defined(GAME_ASYNC_READBACK)
+    if (IsRingAvailable()) return QueueRead(0, GetRenderHeight(), region, callback, userData);
+#endif
+    double start = GetTime();
+    rlDrawRenderBatchActive();
+    return ReadNow(LoadImageFromScreen(), region, 0, start, callback, userData);
+}
+
+void Readback_update()
+{
+    Readback *rb = &_readback;
+    rb->frame++;
+#if defined(GAME_ASYNC_READBACK)
+    while (rb->pendingCount > 0)
+    {
+        ReadbackSlot *slot = &rb->slots[rb->oldest];
+        GLenum status = glClientWaitSync(slot->fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+        double start = GetTime();
+        glDeleteSync(slot->fence);
+        slot->fence = NULL;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+        const unsigned char *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot->width*slot->height*4, GL_MAP_READ_BIT);
+        rb->oldest = (rb->oldest + 1) % READBACK_RING_SIZE;
+        rb->pendingCount--;
+        if (mapped)
+        {
+            AddStallSample((GetTime() - start)*1000.0);
+            rb->stats.lastLatencyFrames = (int)(rb->frame - slot->requestFrame);
+            Deliver(mapped, slot->width, 0, 0, slot->width, slot->height, 1, slot->callback, slot->userData);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+#endif
+}
+
+int Readback_getPendingCount()
+{
+#if defined(GAME_ASYNC_READBACK)
+    return _readback.pendingCount;
+#else
+    return 0;
+#endif
+}
+
+static void IgnorePixels(Image image, void *userData)
+{
+    (void)image;
+    (void)userData;
+}
+
+void Readback_measureStall(RenderTexture2D target)
+{
+    double start = GetTime();
+    ReadNow(LoadImageFromTexture(target.texture), (Rectangle){ 0.0f, 0.0f, (float)target.texture.width, (float)target.texture.height },
+        1, start, IgnorePixels, NULL);
+    float syncMs = (float)((GetTime() - start)*1000.0);
+#if defined(GAME_ASYNC_READBACK)
+    if (IsRingAvailable())
+    {
+        start = GetTime();
+        QueueRead(target.id, target.texture.height, (Rectangle){ 0.0f, 0.0f, (float)target.texture.width, (float)target.texture.height },
+            IgnorePixels, NULL);
+        TraceLog(LOG_INFO, "Readback: %dx%d synchronous %.3f ms, queued %.3f ms (mapped when the fence signals)",
+            target.texture.width, target.texture.height, syncMs, (GetTime() - start)*1000.0);
+        return;
+    }
+#endif
+    TraceLog(LOG_INFO, "Readback: %dx%d synchronous %.3f ms (no PBO ring: built without GAME_ASYNC_READBACK or no sync objects)",
+        target.texture.width, target.texture.height, syncMs);
+}
+
+int Readback_isAsync()
+{
+#if defined(GAME_ASYNC_READBACK)
+    return IsRingAvailable();
+#else
+    return 0;
+#endif
+}
+
+ReadbackStats Readback_getStats()
+{
+    return _readback.stats;
+}
+
+void Readback_unload()
+{
+#if defined(GAME_ASYNC_READBACK)
+    for (int i = 0; i < READBACK_RING_SIZE; i++)
+    {
+        ReadbackSlot *slot = &_readback.slots[i];
+        if (slot->fence) glDeleteSync(slot->fence);
+        if (slot->buffer) glDeleteBuffers(1, &slot->buffer);
+    }
+#endif
+    MemFree(_readback.pixels);
+    _readback = (Readback){0};
+}
@@ -0,0 +1,50 @@
+#ifndef __GAME_READBACK_H__
+#define __GAME_READBACK_H__
+
+#include "raylib.h"
+
+// Pixel readback of render textures and of the backbuffer. With GAME_ASYNC_READBACK
+// defined, reads go through a ring of pixel buffer objects: the copy is queued on the
+// GPU and a fence tells when it is done, so the results arrive one or two frames later
+// in Readback_update and rendering never waits; a request is dropped when the whole
+// ring is in flight. Without it, or on a context without sync objects, the pixels are
+// read right away and the callback runs before the request returns, which stalls until
+// the GPU has caught up. The desktop release build and game.dll (see build_game in
+// raylib_game.c) define it; GLES2 and WebGL have no ring.
+//
+// Regions are in image coordinates: origin at the top left, as the target is shown on
+// screen. Requests must be made outside of BeginTextureMode, after the target's draws.
+
+// picking keeps up to two reads per frame in flight, see picking.h
+#define READBACK_RING_SIZE 6
+
+// image is RGBA8, top row first, and only valid during the call
+typedef void (*ReadbackCallback)(Image image, void *userData);
+
+typedef struct ReadbackStats {
+    int requests;
+    int completed;
+    // requests refused because every buffer of the ring was in flight
+    int dropped;
+    // time the CPU waited for pixels: issuing and mapping the buffer, or the synchronous read
+    float lastStallMs;
+    float maxStallMs;
+    // frames between request and callback
+    int lastLatencyFrames;
+} ReadbackStats;
+
+// returns 0 if the request was dropped; width or height 0 reads the whole target
+int Readback_requestTexture(RenderTexture2D target, Rectangle region, ReadbackCallback callback, void *userData);
+int Readback_requestScreen(Rectangle region, ReadbackCallback callback, void *userData);
+// delivers finished reads, once per frame
+void Readback_update();
+// reads that were queued and not delivered yet; always 0 without the ring
+int Readback_getPendingCount();
+// reads the whole target synchronously and with the ring and logs the stall of both
+void Readback_measureStall(RenderTexture2D target);
+// 1 if reads go through the ring
+int Readback_isAsync();
+ReadbackStats Readback_getStats();
+void Readback_unload();
+
+#endif
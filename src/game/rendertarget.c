@@ -0,0 +1,113 @@
+#include "rendertarget.h"
+#include <stddef.h>
+
+#define RENDER_TARGET_POOL_SIZE 16
+// number of frames an unused target is kept before it gets unloaded
+#define RENDER_TARGET_POOL_KEEP_FRAMES 600
+
+typedef struct RenderTargetPoolEntry {
+    RenderTexture2D target;
+    int inUse;
+    int lastUsedFrame;
+} RenderTargetPoolEntry;
+
+static RenderTargetPoolEntry _renderTargetPool[RENDER_TARGET_POOL_SIZE];
+static int _renderTargetPoolFrame;
+
+static void RenderTargetPool_unloadEntry(RenderTargetPoolEntry *entry)
+{
+    UnloadRenderTexture(entry->target);
+    *entry = (RenderTargetPoolEntry){0};
+}
+
+RenderTexture2D RenderTargetPool_acquire(int width, int height)
+{
+    RenderTargetPoolEntry *freeSlot = NULL;
+    RenderTargetPoolEntry *oldest = NULL;
+    for (int i = 0; i < RENDER_TARGET_POOL_SIZE; i++)
+    {
+        RenderTargetPoolEntry *entry = &_renderTargetPool[i];
+        if (entry->target.id == 0)
+        {
+            if (!freeSlot) freeSlot = entry;
+            continue;
+        }
+        if (entry->inUse) continue;
+        if (entry->target.texture.width == width && entry->target.texture.height == height)
+        {
+            entry->inUse = 1;
+            entry->lastUsedFrame = _renderTargetPoolFrame;
+            return entry->target;
+        }
+        if (!oldest || entry->lastUsedFrame < oldest->lastUsedFrame) oldest = entry;
+    }
+
+    if (!freeSlot && oldest)
+    {
+        RenderTargetPool_unloadEntry(oldest);
+        freeSlot = oldest;
+    }
+
+    RenderTexture2D target = LoadRenderTexture(width, height);
+    SetTextureFilter(target.texture, TEXTURE_FILTER_POINT);
+    SetTextureWrap(target.texture, TEXTURE_WRAP_CLAMP);
+    if (!freeSlot)
+    {
+        // every slot is in use; hand out an untracked target, release will unload it
+        TraceLog(LOG_WARNING, "RenderTargetPool_acquire: pool exhausted, target %dx%d is not pooled", width, height);
+        return target;
+    }
+
+    freeSlot->target = target;
+    freeSlot->inUse = 1;
+    freeSlot->lastUsedFrame = _renderTargetPoolFrame;
+    return target;
+}
+
+void RenderTargetPool_release(RenderTexture2D target)
+{
+    if (target.id == 0) return;
+    for (int i = 0; i < RENDER_TARGET_POOL_SIZE; i++)
+    {
+        RenderTargetPoolEntry *entry = &_renderTargetPool[i];
+        if (entry->target.id == target.id)
+        {
+            entry->inUse = 0;
+            entry->lastUsedFrame = _renderTargetPoolFrame;
+            return;
+        }
+    }
+    UnloadRenderTexture(target);
+}
+
+void RenderTargetPool_update()
+{
+    _renderTargetPoolFrame++;
+    for (int i = 0; i < RENDER_TARGET_POOL_SIZE; i++)
+    {
+        RenderTargetPoolEntry *entry = &_renderTargetPool[i];
+        if (entry->target.id && !entry->inUse &&
+            _renderTargetPoolFrame - entry->lastUsedFrame > RENDER_TARGET_POOL_KEEP_FRAMES)
+        {
+            RenderTargetPool_unloadEntry(entry);
+        }
+    }
+}
+
+void RenderTargetPool_unloadAll()
+{
+    for (int i = 0; i < RENDER_TARGET_POOL_SIZE; i++)
+    {
+        if (_renderTargetPool[i].target.id) RenderTargetPool_unloadEntry(&_renderTargetPool[i]);
+    }
+}
+
+int RenderTargetPool_getLoadedCount()
+{
+    int count = 0;
+    for (int i = 0; i < RENDER_TARGET_POOL_SIZE; i++)
+    {
+        if (_renderTargetPool[i].target.id) count++;
+    }
+    return count;
+}
@@ -0,0 +1,16 @@
+#ifndef __GAME_RENDERTARGET_H__
+#define __GAME_RENDERTARGET_H__
+
+#include "raylib.h"
+
+// Pool of render textures keyed by size. Released targets stay loaded for a while
+// so that going back and forth between sizes (resizing, render scale changes)
+// doesn't reallocate GPU memory every time.
+RenderTexture2D RenderTargetPool_acquire(int width, int height);
+void RenderTargetPool_release(RenderTexture2D target);
+// call once per frame; unloads targets that were not used for a while
+void RenderTargetPool_update();
+void RenderTargetPool_unloadAll();
+int RenderTargetPool_getLoadedCount();
+
+#endif
@@ -0,0 +1,170 @@
+#include "replay.h"
+#include "alloctrack.h"
+#include <string.h>
+
+#define REPLAY_MAGIC "RPLY"
+#define REPLAY_VERSION 1
+// wheel moves are stored in fixed point
+#define REPLAY_WHEEL_SCALE 256.0f
+#define REPLAY_BUTTON_LEFT 1
+
+typedef struct ReplayHeader {
+    char magic[4];
+    int version;
+    float timeStep;
+    int frameCount;
+} ReplayHeader;
+
+typedef struct ReplayFrame {
+    short mouseDeltaX, mouseDeltaY;
+    short wheel;
+    unsigned char buttons;
+    unsigned char reserved;
+} ReplayFrame;
+
+typedef struct Replay {
+    ReplayFrame *frames;
+    int frameCount;
+    int frameCapacity;
+    int position;
+    int isRecording;
+    int isPlaying;
+} Replay;
+
+static Replay _replay;
+
+static short ClampShort(float value)
+{
+    if (value > 32767.0f) return 32767;
+    if (value < -32768.0f) return -32768;
+    return (short)value;
+}
+
+void Replay_startRecording()
+{
+    _replay.frameCount = 0;
+    _replay.isPlaying = 0;
+    _replay.isRecording = 1;
+    TraceLog(LOG_INFO, "Replay: recording");
+}
+
+void Replay_record(ReplayInput input)
+{
+    if (!_replay.isRecording) return;
+    if (_replay.frameCount == _replay.frameCapacity)
+    {
+        _replay.frameCapacity = _replay.frameCapacity ? _replay.frameCapacity * 2 : 1024;
+        _replay.frames = MemRealloc(_replay.frames, _replay.frameCapacity * sizeof(ReplayFrame));
+    }
+    _replay.frames[_replay.frameCount++] = (ReplayFrame){
+        .mouseDeltaX = ClampShort(input.mouseDelta.x),
+        .mouseDeltaY = ClampShort(input.mouseDelta.y),
+        .wheel = ClampShort(input.wheel * REPLAY_WHEEL_SCALE),
+        .buttons = input.leftDown ? REPLAY_BUTTON_LEFT : 0,
+    };
+}
+
+int Replay_stopRecording(const char *fileName)
+{
+    if (!_replay.isRecording) return 0;
+    _replay.isRecording = 0;
+
+    int size = sizeof(ReplayHeader) + _replay.frameCount * sizeof(ReplayFrame);
+    unsigned char *data = MemAlloc(size);
+    ReplayHeader header = {
+        .magic = REPLAY_MAGIC,
+        .version = REPLAY_VERSION,
+        .timeStep = REPLAY_TIME_STEP,
+        .frameCount = _replay.frameCount,
+    };
+    memcpy(data, &header, sizeof(header));
+    if (_replay.frameCount > 0) memcpy(data + sizeof(header), _replay.frames, _replay.frameCount * sizeof(ReplayFrame));
+    int success = SaveFileData(fileName, data, size);
+    MemFree(data);
+    TraceLog(success ? LOG_INFO : LOG_ERROR, "Replay: %s %d frames (%.1f s) to %s", success ? "saved" : "failed to save",
+        _replay.frameCount, _replay.frameCount * REPLAY_TIME_STEP, fileName);
+    return success;
+}
+
+int Replay_isRecording()
+{
+    return _replay.isRecording;
+}
+
+int Replay_play(const char *fileName)
+{
+    int size = 0;
+    unsigned char *data = LoadFileData(fileName, &size);
+    if (data == NULL) return 0;
+
+    ReplayHeader header = {0};
+    if (size >= (int)sizeof(header)) memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, REPLAY_MAGIC, 4) != 0 || header.version != REPLAY_VERSION || header.frameCount < 0
+        || size < (int)(sizeof(header) + header.frameCount * sizeof(ReplayFrame)))
+    {
+        TraceLog(LOG_ERROR, "Replay: %s is not a valid replay file", fileName);
+        UnloadFileData(data);
+        return 0;
+    }
+    if (header.timeStep != REPLAY_TIME_STEP)
+    {
+        TraceLog(LOG_WARNING, "Replay: %s was recorded with a time step of %.4f s", fileName, header.timeStep);
+    }
+
+    if (header.frameCount > _replay.frameCapacity)
+    {
+        _replay.frameCapacity = header.frameCount;
+        _replay.frames = MemRealloc(_replay.frames, _replay.frameCapacity * sizeof(ReplayFrame));
+    }
+    _replay.frameCount = header.frameCount;
+    if (header.frameCount > 0) memcpy(_replay.frames, data + sizeof(header), header.frameCount * sizeof(ReplayFrame));
+    UnloadFileData(data);
+
+    _replay.isRecording = 0;
+    _replay.isPlaying = 1;
+    _replay.position = 0;
+    return 1;
+}
+
+void Replay_rewind()
+{
+    _replay.position = 0;
+    _replay.isPlaying = 1;
+}
+
+void Replay_stop()
+{
+    _replay.isPlaying = 0;
+}
+
+int Replay_isPlaying()
+{
+    return _replay.isPlaying;
+}
+
+int Replay_next(ReplayInput *input)
+{
+    if (!_replay.isPlaying || _replay.position >= _replay.frameCount)
+    {
+        _replay.isPlaying = 0;
+        return 0;
+    }
+    ReplayFrame frame = _replay.frames[_replay.position++];
+    *input = (ReplayInput){
+        .mouseDelta = { frame.mouseDeltaX, frame.mouseDeltaY },
+        .wheel = frame.wheel / REPLAY_WHEEL_SCALE,
+        .leftDown = (frame.buttons & REPLAY_BUTTON_LEFT) != 0,
+    };
+    return 1;
+}
+
+int Replay_getFrameCount()
+{
+    return _replay.frameCount;
+}
+
+void Replay_unload()
+{
+    MemFree(_replay.frames);
+    _replay = (Replay){0};
+}
@@ -0,0 +1,38 @@
+#ifndef __GAME_REPLAY_H__
+#define __GAME_REPLAY_H__
+
+#include "raylib.h"
+
+// Records the camera input of each frame and plays it back. While recording or
+// replaying the game advances by REPLAY_TIME_STEP per frame instead of the measured
+// frame time, so a replayed camera path is the same on every run and machine.
+//
+// File layout: header, then one ReplayFrame per frame.
+
+#define REPLAY_FILE "resources/camera.replay"
+#define REPLAY_TIME_STEP (1.0f / 60.0f)
+
+typedef struct ReplayInput {
+    Vector2 mouseDelta;
+    float wheel;
+    int leftDown;
+} ReplayInput;
+
+void Replay_startRecording();
+void Replay_record(ReplayInput input);
+// stops recording and writes the frames; returns 0 if nothing could be written
+int Replay_stopRecording(const char *fileName);
+int Replay_isRecording();
+
+// loads a recording and starts playing it from the first frame
+int Replay_play(const char *fileName);
+void Replay_rewind();
+void Replay_stop();
+int Replay_isPlaying();
+// input of the next frame; returns 0 when the recording is finished
+int Replay_next(ReplayInput *input);
+int Replay_getFrameCount();
+
+void Replay_unload();
+
+#endif
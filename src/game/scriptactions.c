@@ -1,4 +1,8 @@
 #include "main.h"
+#include "scriptactions.h"
+#include "tween.h"
+#include "jobs.h"
+#include "sdffont.h"
 
 
 
@@ -6,38 +10,117 @@ typedef struct ScriptAction_DrawRectData {
     const char *title;
     const char *text;
     Rectangle rect;
+    // the panel slides in from this position when its first step is entered
+    Vector2 slideFrom;
+    float slideDuration;
+    // animated position, see ScriptAction_enterTextRect
+    Vector2 position;
+    // placed by ScriptActions_layoutTextRects when the script is loaded
+    GlyphLayout titleLayout;
+    GlyphLayout textLayout;
 } ScriptAction_DrawRectData;
 
-void* ScriptAction_DrawTextRectData_new(const char *title, const char *text, Rectangle rect)
+void* ScriptAction_DrawTextRectData_new(const char *title, const char *text, Rectangle rect, Vector2 slideFrom, float slideDuration)
 {
     ScriptAction_DrawRectData *data = pool_alloc(sizeof(ScriptAction_DrawRectData), 
         &(ScriptAction_DrawRectData){
             .title = title,
             .text = text,
             .rect = rect,
+            .slideFrom = slideFrom,
+            .slideDuration = slideDuration,
+            .position = (Vector2){rect.x, rect.y},
         });
     return data;
 }
 
-void ScriptAction_drawTextRect(Script *script, ScriptAction *action)
+void ScriptAction_enterTextRect(Script *script, ScriptAction *action)
+{
+    ScriptAction_DrawRectData *data = action->actionData;
+    // only slide in when the panel appears, not on later steps that still show it
+    float duration = script->currentActionId == action->actionIdStart ? data->slideDuration : 0.0f;
+    Tween_add(&data->position.x, data->slideFrom.x, data->rect.x, duration, TWEEN_EASE_OUT);
+    Tween_add(&data->position.y, data->slideFrom.y, data->rect.y, duration, TWEEN_EASE_OUT);
+}
+
+void ScriptAction_updateTextRect(Script *script, ScriptAction *action)
 {
     ScriptAction_DrawRectData *data = action->actionData;
+    if (Tween_isAnimating(&data->position.x) || Tween_isAnimating(&data->position.y)) Script_invalidateUi();
+}
+
+void ScriptAction_drawTextRect(Script *script, ScriptAction *action)
+{
+    ScriptAction_DrawRectData *source = action->actionData;
+    ScriptAction_DrawRectData *data = &(ScriptAction_DrawRectData){
+        .title = source->title,
+        .text = source->text,
+        .rect = {source->position.x, source->position.y, source->rect.width, source->rect.height},
+    };
     DrawRectangleRec(data->rect, WHITE);
     DrawRectangleLinesEx(data->rect, 1, BLACK);
     DrawRectangleLinesEx((Rectangle){data->rect.x + 1, data->rect.y + 1, data->rect.width - 2, data->rect.height - 2}, 1, BLACK);
-    DrawTextBoxAligned(_fntMedium, data->title, data->rect.x + 6, data->rect.y + 6, data->rect.width - 12, data->rect.height - 12, 0.5f, 0.0f, WHITE);
-    DrawTextBoxAligned(_fntMedium, data->text, data->rect.x + 6, data->rect.y + 32, data->rect.width - 12, data->rect.height - 36, 0.0f, 0.0f, WHITE);
+    // the layouts are only redone here after a change of the font or the wrap mode
+    DrawTextBoxLayout(&source->titleLayout, _fntMedium, data->title, data->rect.x + 6, data->rect.y + 6, data->rect.width - 12, data->rect.height - 12, 0.5f, 0.0f, WHITE);
+    DrawTextBoxLayout(&source->textLayout, _fntMedium, data->text, data->rect.x + 6, data->rect.y + 32, data->rect.width - 12, data->rect.height - 36, 0.0f, 0.0f, WHITE);
     // DrawTextEx(fntMedium, data->text, (Vector2){data->rect.x + 4, data->rect.y + 4}, fntMedium.baseSize * 2.0f, -2.0f, WHITE);
 }
 
+typedef struct TextRectLayoutJob {
+    ScriptAction_DrawRectData **panels;
+} TextRectLayoutJob;
+
+// even indices lay out the title of a panel, odd ones its text
+static void LayoutTextRect(int index, void *userData)
+{
+    TextRectLayoutJob *job = userData;
+    ScriptAction_DrawRectData *data = job->panels[index / 2];
+    int width = data->rect.width - 12;
+    if (index % 2 == 0) LayoutTextBox(&data->titleLayout, _fntMedium, data->title, width);
+    else LayoutTextBox(&data->textLayout, _fntMedium, data->text, width);
+}
+
+void ScriptActions_layoutTextRects(Script *script)
+{
+    double start = GetTime();
+    int panelCount = 0;
+    for (int i = 0; i < script->actionCount; i++)
+    {
+        if (script->actions[i].drawUi == ScriptAction_drawTextRect) panelCount++;
+    }
+    if (panelCount == 0) return;
+
+    // the buffers come from the script's arena, which is not shared with the workers
+    ScriptAction_DrawRectData **panels = Arena_alloc(&script->arena, panelCount * sizeof(ScriptAction_DrawRectData*));
+    int textBytes = 0;
+    panelCount = 0;
+    for (int i = 0; i < script->actionCount; i++)
+    {
+        if (script->actions[i].drawUi != ScriptAction_drawTextRect) continue;
+        ScriptAction_DrawRectData *data = script->actions[i].actionData;
+        data->titleLayout.glyphCapacity = data->title ? TextLength(data->title) : 0;
+        data->titleLayout.glyphs = Arena_alloc(&script->arena, data->titleLayout.glyphCapacity * sizeof(TextGlyph));
+        data->textLayout.glyphCapacity = data->text ? TextLength(data->text) : 0;
+        data->textLayout.glyphs = Arena_alloc(&script->arena, data->textLayout.glyphCapacity * sizeof(TextGlyph));
+        textBytes += data->titleLayout.glyphCapacity + data->textLayout.glyphCapacity;
+        panels[panelCount++] = data;
+    }
+
+    Jobs_parallelFor(panelCount * 2, LayoutTextRect, &(TextRectLayoutJob){ panels });
+    TraceLog(LOG_INFO, "Script: laid out %d text panels (%d bytes of text) in %.2f ms on %d threads", panelCount,
+        textBytes, (GetTime() - start) * 1000.0, Jobs_getThreadCount());
+}
+
 typedef struct ScriptAction_DrawMagnifiedTextureData {
     Rectangle srcRect;
     Rectangle dstRect;
     Texture2D *texture;
-    Shader shader;
+    // srcRect in texels of the texture size it was computed for
+    Rectangle texelRect;
+    int texelRectWidth, texelRectHeight;
 } ScriptAction_DrawMagnifiedTextureData;
 
-void* ScriptAction_DrawMagnifiedTextureData_new(Rectangle srcRect, Rectangle dstRect, Texture2D *texture, Shader shader)
+void* ScriptAction_DrawMagnifiedTextureData_new(Rectangle srcRect, Rectangle dstRect, Texture2D *texture)
 {
     ScriptAction_DrawMagnifiedTextureData *data = pool_alloc(sizeof(ScriptAction_DrawMagnifiedTextureData), 
         &(ScriptAction_DrawMagnifiedTextureData){
@@ -46,18 +129,14 @@ void* ScriptAction_DrawMagnifiedTextureData_new(Rectangle srcRect, Rectangle dst
                 srcRect.width / texture->width, srcRect.height / texture->height},
             .dstRect = dstRect,
             .texture = texture,
-            .shader = shader,
         });
     return data;
 }
 
-void ScriptAction_drawMagnifiedTexture(Script *script, ScriptAction *action)
+// frame around the magnified area and the lines to the magnified view, drawn into the UI layer
+void ScriptAction_drawMagnifierFrame(Script *script, ScriptAction *action)
 {
     ScriptAction_DrawMagnifiedTextureData *data = action->actionData;
-    Rectangle srcRect = data->srcRect;
-    Texture2D texture = *data->texture;
-    srcRect.x *= texture.width;
-    srcRect.y = (1.0f - srcRect.y - srcRect.height) * texture.height;
     Rectangle srcRectScreen = data->srcRect;
     float screenWidth = GetScreenWidth();
     float screenHeight = GetScreenHeight();
@@ -67,9 +146,6 @@ void ScriptAction_drawMagnifiedTexture(Script *script, ScriptAction *action)
     srcRectScreen.width *= screenWidth;
     srcRectScreen.height *= screenHeight;
     // TraceLog(LOG_INFO, "srcRectScreen: %f %f %f %f", srcRectScreen.x, srcRectScreen.y, srcRectScreen.width, srcRectScreen.height);
-    srcRect.width *= texture.width;
-    srcRect.height *= -texture.height;
-    // TraceLog(LOG_INFO, "srcRect: %f %f %f %f", srcRect.x, srcRect.y, srcRect.width, srcRect.height);
     DrawRectangleLinesEx((Rectangle){srcRectScreen.x - 1.0f, srcRectScreen.y - 1.0f, srcRectScreen.width + 2.0f, srcRectScreen.height + 2.0f}, 4.0f, WHITE);
     DrawRectangleLinesEx(srcRectScreen, 2.0f, BLACK);
 
@@ -82,24 +158,42 @@ void ScriptAction_drawMagnifiedTexture(Script *script, ScriptAction *action)
         DrawLineEx((Vector2){srcRectScreen.x + srcRectScreen.width, srcRectScreen.y + srcRectScreen.height}, (Vector2){data->dstRect.x + data->dstRect.width, data->dstRect.y + data->dstRect.height}, lw, color);
     }
 
-    rlDrawRenderBatchActive();
-    rlDisableColorBlend();
-    BeginShaderMode(data->shader);
-    DrawTexturePro(texture, srcRect, data->dstRect, (Vector2){0, 0}, 0.0f, WHITE);
-    EndShaderMode();
-
-    rlDrawRenderBatchActive();
-    rlEnableColorBlend();
-
+    // keep the magnified view visible through the layer where the lines cross it
+    BeginScissorMode(data->dstRect.x, data->dstRect.y, data->dstRect.width, data->dstRect.height);
+    ClearBackground(BLANK);
+    EndScissorMode();
 
     DrawRectangleLinesEx((Rectangle){data->dstRect.x-1.0f, data->dstRect.y-1.0f, data->dstRect.width + 2.0f, data->dstRect.height + 2.0f}, 4.0f, WHITE);
     DrawRectangleLinesEx(data->dstRect, 2.0f, BLACK);
 }
 
+// the magnified scene itself changes every frame and is drawn directly; the texture
+// is the already post processed scene, so this is a plain nearest filtered blit
+void ScriptAction_drawMagnifiedTexture(Script *script, ScriptAction *action)
+{
+    ScriptAction_DrawMagnifiedTextureData *data = action->actionData;
+    Texture2D texture = *data->texture;
+    // the texture is resized with the render scale only
+    if (texture.width != data->texelRectWidth || texture.height != data->texelRectHeight)
+    {
+        Rectangle srcRect = data->srcRect;
+        srcRect.x *= texture.width;
+        srcRect.y = (1.0f - srcRect.y - srcRect.height) * texture.height;
+        srcRect.width *= texture.width;
+        srcRect.height *= -texture.height;
+        data->texelRect = srcRect;
+        data->texelRectWidth = texture.width;
+        data->texelRectHeight = texture.height;
+    }
+    DrawTexturePro(texture, data->texelRect, data->dstRect, (Vector2){0, 0}, 0.0f, WHITE);
+}
+
 typedef struct ScriptAction_JumpStepData {
     int prevStep;
     int nextStep;
     int isRelative;
+    // -1: none, 0: previous, 1: next
+    int hoveredButton;
 } ScriptAction_JumpStepData;
 
 void* ScriptAction_JumpStepData_new(int prevStep, int nextStep, int isRelative)
@@ -109,23 +203,43 @@ void* ScriptAction_JumpStepData_new(int prevStep, int nextStep, int isRelative)
             .prevStep = prevStep,
             .nextStep = nextStep,
             .isRelative = isRelative,
+            .hoveredButton = -1,
         });
     return data;
 }
 
+static Rectangle GetJumpButtonRect(int button)
+{
+    int x = GetScreenWidth() - 64, y = GetScreenHeight() - 64, sx = 40, sy = 40;
+    if (button == 0) x -= sx + 4;
+    return (Rectangle){x, y, sx, sy};
+}
+
+void ScriptAction_drawJumpButtons(Script *script, ScriptAction *action)
+{
+    ScriptAction_JumpStepData *data = action->actionData;
+    for (int button = 1; button >= 0; button--)
+    {
+        Rectangle rect = GetJumpButtonRect(button);
+        DrawRectangleRec(rect, data->hoveredButton == button ? LIGHTGRAY : WHITE);
+        DrawRectangleLinesEx(rect, 2.0f, BLACK);
+        DrawTextRich(_fntMedium, button ? ">" : "<", (Vector2){rect.x + rect.width / 2 - 4, rect.y + 6}, SdfFont_getSourceSize(_fntMedium) * 2.0f, -2.0f, 0, WHITE);
+    }
+}
+
 void ScriptAction_jumpStep(Script *script, ScriptAction *action)
 {
     ScriptAction_JumpStepData *data = action->actionData;
-    int h = GetScreenHeight();
-    int w = GetScreenWidth();
-    int x = w - 64, y = h - 64, sx = 40, sy = 40;
-    int mx = GetMouseX();
-    int my = GetMouseY();
-
-    DrawRectangle(x, y, sx, sy, WHITE);
-    DrawRectangleLinesEx((Rectangle){x,y,sx,sy},2.0f, BLACK);
-    DrawTextEx(_fntMedium, ">", (Vector2){x+sx / 2 - 4,y+6}, _fntMedium.baseSize * 2.0f, -2.0f, WHITE);
-    if ((IsMouseButtonReleased(0) && mx >= x && my >= y && mx < x + sx && my < y + sy) || IsKeyReleased(KEY_RIGHT))
+    Vector2 mouse = GetMousePosition();
+    int hoveredButton = CheckCollisionPointRec(mouse, GetJumpButtonRect(1)) ? 1
+        : CheckCollisionPointRec(mouse, GetJumpButtonRect(0)) ? 0 : -1;
+    if (hoveredButton != data->hoveredButton)
+    {
+        data->hoveredButton = hoveredButton;
+        Script_invalidateUi();
+    }
+
+    if ((IsMouseButtonReleased(0) && hoveredButton == 1) || IsKeyReleased(KEY_RIGHT))
     {
         TraceLog(LOG_INFO, "nextStep: %d", data->nextStep);
         if (data->isRelative)
@@ -138,12 +252,7 @@ void ScriptAction_jumpStep(Script *script, ScriptAction *action)
         }
     }
 
-    x-=sx + 4;
-    
-    DrawRectangle(x, y, sx, sy, WHITE);
-    DrawRectangleLinesEx((Rectangle){x,y,sx,sy},2.0f, BLACK);
-    DrawTextEx(_fntMedium, "<", (Vector2){x+sx / 2 - 4,y+6}, _fntMedium.baseSize * 2.0f, -2.0f, WHITE);
-    if ((IsMouseButtonReleased(0) && mx >= x && my >= y && mx < x + sx && my < y + sy) || IsKeyReleased(KEY_LEFT))
+    if ((IsMouseButtonReleased(0) && hoveredButton == 0) || IsKeyReleased(KEY_LEFT))
     {
         TraceLog(LOG_INFO, "prevStep: %d", data->prevStep);
         if (data->isRelative)
@@ -214,6 +323,28 @@ void ScriptAction_setDrawScene(Script *script, ScriptAction *action)
     SetSceneDrawingFunction(data->drawFn, data->drawData);
 }
 
+int ScriptAction_getDrawScene(const ScriptAction *action, void (**drawFn)(void*), void **drawData)
+{
+    if (action->action != ScriptAction_setDrawScene) return 0;
+    ScriptAction_SetDrawSceneData *data = action->actionData;
+    *drawFn = data->drawFn;
+    *drawData = data->drawData;
+    return 1;
+}
+
+void* ScriptAction_ViewportData_new(Viewport viewport)
+{
+    return pool_alloc(sizeof(Viewport), &viewport);
+}
+
+void ScriptAction_enterViewport(Script *script, ScriptAction *action)
+{
+    if (!AddViewport(*(Viewport*)action->actionData))
+    {
+        TraceLog(LOG_WARNING, "Script: step %d has more than %d viewports", script->currentActionId, VIEWPORT_MAX);
+    }
+}
+
 typedef struct ScriptAction_DrawTextureData {
     Texture2D *texture;
     Rectangle dstRect;
@@ -235,4 +366,46 @@ void ScriptAction_drawTexture(Script *script, ScriptAction *action)
 {
     ScriptAction_DrawTextureData *data = action->actionData;
     DrawTexturePro(*data->texture, data->srcRect, data->dstRect, (Vector2){0, 0}, 0.0f, WHITE);
-}
\ No newline at end of file
+}
+
+typedef struct ScriptAction_CameraData {
+    float pitch, yaw, distance;
+    float duration;
+} ScriptAction_CameraData;
+
+void* ScriptAction_CameraData_new(float pitch, float yaw, float distance, float duration)
+{
+    ScriptAction_CameraData *data = pool_alloc(sizeof(ScriptAction_CameraData), 
+        &(ScriptAction_CameraData){
+            .pitch = pitch,
+            .yaw = yaw,
+            .distance = distance,
+            .duration = duration,
+        });
+    return data;
+}
+
+void ScriptAction_enterCamera(Script *script, ScriptAction *action)
+{
+    ScriptAction_CameraData *data = action->actionData;
+    SetCameraOrbit(data->pitch, data->yaw, data->distance, data->duration);
+}
+
+void* ScriptAction_DurationData_new(float seconds)
+{
+    return pool_alloc(sizeof(float), &seconds);
+}
+
+void ScriptAction_enterFade(Script *script, ScriptAction *action)
+{
+    FadeInScene(*(float*)action->actionData);
+}
+
+void ScriptAction_autoAdvance(Script *script, ScriptAction *action)
+{
+    float seconds = *(float*)action->actionData;
+    if (Script_getStepTime() >= seconds && script->currentActionId + 1 < script->stepCount)
+    {
+        script->nextActionId = script->currentActionId + 1;
+    }
+}
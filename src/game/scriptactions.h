@@ -3,17 +3,36 @@
 
 #include "main.h"
 
-void* ScriptAction_DrawTextRectData_new(const char *title, const char *text, Rectangle rect);
+void* ScriptAction_DrawTextRectData_new(const char *title, const char *text, Rectangle rect, Vector2 slideFrom, float slideDuration);
+void ScriptAction_enterTextRect(Script *script, ScriptAction *action);
+void ScriptAction_updateTextRect(Script *script, ScriptAction *action);
 void ScriptAction_drawTextRect(Script *script, ScriptAction *action);
-void* ScriptAction_DrawMagnifiedTextureData_new(Rectangle srcRect, Rectangle dstRect, Texture2D *texture, Shader shader);
+// lays out the title and text of every text panel of the script on the worker pool, into
+// glyph buffers in the script's arena; call once the script is linked
+void ScriptActions_layoutTextRects(Script *script);
+void* ScriptAction_DrawMagnifiedTextureData_new(Rectangle srcRect, Rectangle dstRect, Texture2D *texture);
+void ScriptAction_drawMagnifierFrame(Script *script, ScriptAction *action);
 void ScriptAction_drawMagnifiedTexture(Script *script, ScriptAction *action);
 void* ScriptAction_JumpStepData_new(int prevStep, int nextStep, int isRelative);
+void ScriptAction_drawJumpButtons(Script *script, ScriptAction *action);
 void ScriptAction_jumpStep(Script *script, ScriptAction *action);
 void* ScriptAction_DrawMeshData_new(Mesh *mesh, Shader shader, Material *material, Matrix transform, Camera3D *camera);
 void ScriptAction_drawMesh(Script *script, ScriptAction *action);
 void* ScriptAction_SetDrawSceneData_new(void (*drawFn)(void*), void* drawData);
 void ScriptAction_setDrawScene(Script *script, ScriptAction *action);
+// returns 1 and the scene if the action is a setDrawScene action
+int ScriptAction_getDrawScene(const ScriptAction *action, void (**drawFn)(void*), void **drawData);
+void* ScriptAction_ViewportData_new(Viewport viewport);
+// adds the viewport when its step is entered, see AddViewport
+void ScriptAction_enterViewport(Script *script, ScriptAction *action);
 void* ScriptAction_DrawTextureData_new(Texture2D *texture, Rectangle dstRect, Rectangle srcRect);
 void ScriptAction_drawTexture(Script *script, ScriptAction *action);
+void* ScriptAction_CameraData_new(float pitch, float yaw, float distance, float duration);
+void ScriptAction_enterCamera(Script *script, ScriptAction *action);
+// data of the fade and auto advance actions: the duration in seconds
+void* ScriptAction_DurationData_new(float seconds);
+void ScriptAction_enterFade(Script *script, ScriptAction *action);
+// goes to the next step once the current one was shown for the given time
+void ScriptAction_autoAdvance(Script *script, ScriptAction *action);
 
 #endif
\ No newline at end of file
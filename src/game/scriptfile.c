@@ -0,0 +1,745 @@
+#include "scriptfile.h"
+#include "scriptactions.h"
+#include "bundle.h"
+#include "alloctrack.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SCRIPT_BINARY_MAGIC "SCRB"
+#define SCRIPT_BINARY_VERSION 1
+
+// binary layout: header, records, string table; little endian as written by the game
+typedef struct ScriptBinaryHeader {
+    char magic[4];
+    int version;
+    int recordCount;
+    int stepCount;
+    int stringBytes;
+} ScriptBinaryHeader;
+
+typedef struct ScriptParser {
+    const char *fileName;
+    const char *cursor;
+    const char *end;
+    int line;
+    int error;
+    int step;
+    int openScene;          // record of the scene that runs until the next one, -1 if none
+    ScriptRecord *records;
+    int recordCount;
+    int recordCapacity;
+    char *strings;
+    int stringBytes;
+    int stringCapacity;
+} ScriptParser;
+
+static void ScriptParser_error(ScriptParser *parser, const char *message)
+{
+    if (parser->error) return;
+    parser->error = 1;
+    TraceLog(LOG_ERROR, "Script: %s:%d: %s", parser->fileName, parser->line, message);
+}
+
+static void SkipSpace(ScriptParser *parser)
+{
+    while (parser->cursor < parser->end)
+    {
+        char c = *parser->cursor;
+        if (c == '\n') parser->line++;
+        if (c == '#')
+        {
+            while (parser->cursor < parser->end && *parser->cursor != '\n') parser->cursor++;
+            continue;
+        }
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') break;
+        parser->cursor++;
+    }
+}
+
+static int IsWordChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+static int PeekIsWord(ScriptParser *parser)
+{
+    SkipSpace(parser);
+    if (parser->cursor == parser->end) return 0;
+    char c = *parser->cursor;
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static int PeekIsNumber(ScriptParser *parser)
+{
+    SkipSpace(parser);
+    if (parser->cursor == parser->end) return 0;
+    char c = *parser->cursor;
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.';
+}
+
+static int PeekIsString(ScriptParser *parser)
+{
+    SkipSpace(parser);
+    return parser->cursor < parser->end && *parser->cursor == '"';
+}
+
+// returns the length of the word at the cursor and consumes it
+static int ReadWord(ScriptParser *parser, const char **word)
+{
+    if (!PeekIsWord(parser))
+    {
+        ScriptParser_error(parser, "expected a name");
+        return 0;
+    }
+    *word = parser->cursor;
+    while (parser->cursor < parser->end && IsWordChar(*parser->cursor)) parser->cursor++;
+    return (int)(parser->cursor - *word);
+}
+
+static int WordEquals(const char *word, int length, const char *keyword)
+{
+    return (int)strlen(keyword) == length && memcmp(word, keyword, length) == 0;
+}
+
+static int IsDirective(const char *word, int length)
+{
+    return WordEquals(word, length, "step") || WordEquals(word, length, "text") || WordEquals(word, length, "magnify")
+        || WordEquals(word, length, "scene") || WordEquals(word, length, "navigation") || WordEquals(word, length, "for")
+        || WordEquals(word, length, "label") || WordEquals(word, length, "camera") || WordEquals(word, length, "fade")
+        || WordEquals(word, length, "advance") || WordEquals(word, length, "from") || WordEquals(word, length, "viewport");
+}
+
+// keywords that may follow the names of a viewport line; reserved there only
+static int IsViewportOption(const char *word, int length)
+{
+    return WordEquals(word, length, "yaw") || WordEquals(word, length, "scale");
+}
+
+static float ReadNumber(ScriptParser *parser)
+{
+    if (!PeekIsNumber(parser))
+    {
+        ScriptParser_error(parser, "expected a number");
+        return 0.0f;
+    }
+    float sign = 1.0f;
+    if (*parser->cursor == '-' || *parser->cursor == '+')
+    {
+        if (*parser->cursor == '-') sign = -1.0f;
+        parser->cursor++;
+    }
+    float value = 0.0f;
+    int digits = 0;
+    while (parser->cursor < parser->end && *parser->cursor >= '0' && *parser->cursor <= '9')
+    {
+        value = value*10.0f + (*parser->cursor++ - '0');
+        digits++;
+    }
+    if (parser->cursor < parser->end && *parser->cursor == '.')
+    {
+        parser->cursor++;
+        float scale = 0.1f;
+        while (parser->cursor < parser->end && *parser->cursor >= '0' && *parser->cursor <= '9')
+        {
+            value += (*parser->cursor++ - '0')*scale;
+            scale *= 0.1f;
+            digits++;
+        }
+    }
+    if (digits == 0 || (parser->cursor < parser->end && IsWordChar(*parser->cursor)))
+    {
+        ScriptParser_error(parser, "malformed number");
+    }
+    return value*sign;
+}
+
+static void AppendString(ScriptParser *parser, const char *str, int length)
+{
+    if (parser->stringBytes + length > parser->stringCapacity)
+    {
+        int capacity = parser->stringCapacity ? parser->stringCapacity : 4096;
+        while (capacity < parser->stringBytes + length) capacity *= 2;
+        parser->strings = MemRealloc(parser->strings, capacity);
+        parser->stringCapacity = capacity;
+    }
+    memcpy(parser->strings + parser->stringBytes, str, length);
+    parser->stringBytes += length;
+}
+
+// reads a string literal, or with concatenate set all adjacent ones, into the string
+// table and returns its offset
+static int ReadString(ScriptParser *parser, int concatenate)
+{
+    if (!PeekIsString(parser))
+    {
+        ScriptParser_error(parser, "expected a string");
+        return SCRIPT_NO_STRING;
+    }
+
+    int offset = parser->stringBytes;
+    while (PeekIsString(parser))
+    {
+        parser->cursor++;
+        const char *run = parser->cursor;
+        while (1)
+        {
+            if (parser->cursor == parser->end || *parser->cursor == '\n')
+            {
+                ScriptParser_error(parser, "unterminated string");
+                return SCRIPT_NO_STRING;
+            }
+            char c = *parser->cursor;
+            if (c == '"')
+            {
+                AppendString(parser, run, (int)(parser->cursor - run));
+                parser->cursor++;
+                break;
+            }
+            if (c == '\\')
+            {
+                AppendString(parser, run, (int)(parser->cursor - run));
+                parser->cursor++;
+                if (parser->cursor == parser->end) continue;
+                char escaped = *parser->cursor++;
+                if (escaped == 'n') escaped = '\n';
+                else if (escaped != '"' && escaped != '\\')
+                {
+                    ScriptParser_error(parser, "unknown escape sequence");
+                    return SCRIPT_NO_STRING;
+                }
+                AppendString(parser, &escaped, 1);
+                run = parser->cursor;
+                continue;
+            }
+            parser->cursor++;
+        }
+        if (!concatenate) break;
+    }
+    AppendString(parser, "", 1);
+    return offset;
+}
+
+static int AddName(ScriptParser *parser, const char *word, int length)
+{
+    int offset = parser->stringBytes;
+    AppendString(parser, word, length);
+    AppendString(parser, "", 1);
+    return offset;
+}
+
+static ScriptRecord *AddRecord(ScriptParser *parser, int op)
+{
+    if (parser->recordCount == parser->recordCapacity)
+    {
+        parser->recordCapacity = parser->recordCapacity ? parser->recordCapacity*2 : 256;
+        parser->records = MemRealloc(parser->records, parser->recordCapacity*sizeof(ScriptRecord));
+    }
+    ScriptRecord *record = &parser->records[parser->recordCount++];
+    *record = (ScriptRecord){ .op = op, .stepStart = parser->step, .stepEnd = parser->step };
+    return record;
+}
+
+// consumes the next word if it is the keyword
+static int ReadKeyword(ScriptParser *parser, const char *keyword)
+{
+    if (!PeekIsWord(parser)) return 0;
+    const char *word = parser->cursor;
+    const char *cursor = parser->cursor;
+    int length = ReadWord(parser, &word);
+    if (!WordEquals(word, length, keyword))
+    {
+        parser->cursor = cursor;
+        return 0;
+    }
+    return 1;
+}
+
+static float ReadSeconds(ScriptParser *parser)
+{
+    float seconds = ReadNumber(parser);
+    if (seconds < 0.0f) ScriptParser_error(parser, "time must not be negative");
+    return seconds;
+}
+
+// optional "for <n>" suffix
+static void ReadDuration(ScriptParser *parser, ScriptRecord *record)
+{
+    if (!ReadKeyword(parser, "for")) return;
+    int steps = (int)ReadNumber(parser);
+    if (steps < 1) ScriptParser_error(parser, "duration must be at least one step");
+    record->stepEnd = record->stepStart + steps - 1;
+}
+
+static void ParseDirective(ScriptParser *parser, const char *word, int length)
+{
+    if (WordEquals(word, length, "step"))
+    {
+        parser->step++;
+    }
+    else if (WordEquals(word, length, "text"))
+    {
+        int index = parser->recordCount;
+        AddRecord(parser, SCRIPT_OP_TEXT);
+        ScriptArg args[9];
+        for (int i = 0; i < 4; i++) args[i].f = ReadNumber(parser);
+        args[4].str = ReadString(parser, 0);
+        args[5].str = ReadString(parser, 1);
+        // optional "from <x> <y> <seconds>": slide in from that position
+        args[6].f = args[0].f;
+        args[7].f = args[1].f;
+        args[8].f = 0.0f;
+        if (ReadKeyword(parser, "from"))
+        {
+            args[6].f = ReadNumber(parser);
+            args[7].f = ReadNumber(parser);
+            args[8].f = ReadSeconds(parser);
+        }
+        memcpy(parser->records[index].args, args, sizeof(args));
+        ReadDuration(parser, &parser->records[index]);
+    }
+    else if (WordEquals(word, length, "magnify"))
+    {
+        int index = parser->recordCount;
+        AddRecord(parser, SCRIPT_OP_MAGNIFY);
+        ScriptArg args[9];
+        for (int i = 0; i < 8; i++) args[i].f = ReadNumber(parser);
+        const char *name = NULL;
+        int nameLength = ReadWord(parser, &name);
+        args[8].str = parser->error ? SCRIPT_NO_STRING : AddName(parser, name, nameLength);
+        memcpy(parser->records[index].args, args, sizeof(args));
+        ReadDuration(parser, &parser->records[index]);
+    }
+    else if (WordEquals(word, length, "scene"))
+    {
+        if (parser->openScene >= 0) parser->records[parser->openScene].stepEnd = parser->step - 1;
+        parser->openScene = parser->recordCount;
+        int index = parser->recordCount;
+        AddRecord(parser, SCRIPT_OP_SCENE);
+        ScriptArg args[4] = { { .str = SCRIPT_NO_STRING }, { .str = SCRIPT_NO_STRING } };
+        const char *name = NULL;
+        int nameLength = ReadWord(parser, &name);
+        if (parser->error) return;
+        args[0].str = AddName(parser, name, nameLength);
+        if (PeekIsWord(parser))
+        {
+            const char *cursor = parser->cursor;
+            nameLength = ReadWord(parser, &name);
+            if (IsDirective(name, nameLength)) parser->cursor = cursor;
+            else args[1].str = AddName(parser, name, nameLength);
+        }
+        for (int i = 2; i < 4 && PeekIsNumber(parser); i++) args[i].i = (int)ReadNumber(parser);
+        memcpy(parser->records[index].args, args, sizeof(args));
+    }
+    else if (WordEquals(word, length, "navigation"))
+    {
+        int index = parser->recordCount;
+        AddRecord(parser, SCRIPT_OP_NAVIGATION);
+        ScriptArg args[3];
+        args[0].i = (int)ReadNumber(parser);
+        args[1].i = (int)ReadNumber(parser);
+        const char *mode = NULL;
+        int modeLength = ReadWord(parser, &mode);
+        if (parser->error) return;
+        if (WordEquals(mode, modeLength, "relative")) args[2].i = 1;
+        else if (WordEquals(mode, modeLength, "absolute")) args[2].i = 0;
+        else ScriptParser_error(parser, "expected relative or absolute");
+        memcpy(parser->records[index].args, args, sizeof(args));
+    }
+    else if (WordEquals(word, length, "label"))
+    {
+        int index = parser->recordCount;
+        AddRecord(parser, SCRIPT_OP_LABEL);
+        const char *name = NULL;
+        int nameLength = ReadWord(parser, &name);
+        if (parser->error) return;
+        parser->records[index].args[0].str = AddName(parser, name, nameLength);
+    }
+    else if (WordEquals(word, length, "camera"))
+    {
+        int index = parser->recordCount;
+        AddRecord(parser, SCRIPT_OP_CAMERA);
+        ScriptArg args[4];
+        for (int i = 0; i < 3; i++) args[i].f = ReadNumber(parser);
+        args[3].f = PeekIsNumber(parser) ? ReadSeconds(parser) : 0.0f;
+        memcpy(parser->records[index].args, args, sizeof(args));
+    }
+    else if (WordEquals(word, length, "fade") || WordEquals(word, length, "advance"))
+    {
+        int index = parser->recordCount;
+        AddRecord(parser, WordEquals(word, length, "fade") ? SCRIPT_OP_FADE : SCRIPT_OP_ADVANCE);
+        parser->records[index].args[0].f = ReadSeconds(parser);
+    }
+    else if (WordEquals(word, length, "viewport"))
+    {
+        int index = parser->recordCount;
+        AddRecord(parser, SCRIPT_OP_VIEWPORT);
+        ScriptArg args[10] = { [5] = { .str = SCRIPT_NO_STRING } };
+        for (int i = 0; i < 4; i++) args[i].f = ReadNumber(parser);
+        const char *name = NULL;
+        int nameLength = ReadWord(parser, &name);
+        if (parser->error) return;
+        args[4].str = AddName(parser, name, nameLength);
+        if (PeekIsWord(parser))
+        {
+            const char *cursor = parser->cursor;
+            nameLength = ReadWord(parser, &name);
+            if (IsDirective(name, nameLength) || IsViewportOption(name, nameLength)) parser->cursor = cursor;
+            else args[5].str = AddName(parser, name, nameLength);
+        }
+        for (int i = 6; i < 8 && PeekIsNumber(parser); i++) args[i].i = (int)ReadNumber(parser);
+        if (ReadKeyword(parser, "yaw")) args[8].f = ReadNumber(parser);
+        if (ReadKeyword(parser, "scale"))
+        {
+            args[9].i = (int)ReadNumber(parser);
+            if (args[9].i < RENDER_SCALE_MIN || args[9].i > RENDER_SCALE_MAX) ScriptParser_error(parser, "scale must be 1 to 4");
+        }
+        memcpy(parser->records[index].args, args, sizeof(args));
+        ReadDuration(parser, &parser->records[index]);
+    }
+    else
+    {
+        ScriptParser_error(parser, "unknown directive");
+    }
+}
+
+static ScriptProgram *FinishProgram(ScriptParser *parser, Arena *arena)
+{
+    int lastStep = parser->step;
+    for (int i = 0; i < parser->recordCount; i++)
+    {
+        ScriptRecord *record = &parser->records[i];
+        // navigation is shown on every step, the last scene runs until the end
+        if (record->op == SCRIPT_OP_NAVIGATION)
+        {
+            record->stepStart = 0;
+            record->stepEnd = lastStep;
+        }
+    }
+    if (parser->openScene >= 0) parser->records[parser->openScene].stepEnd = lastStep;
+
+    ScriptProgram *program = Arena_alloc(arena, sizeof(ScriptProgram));
+    program->recordCount = parser->recordCount;
+    program->stepCount = lastStep + 1;
+    program->stringBytes = parser->stringBytes;
+    program->records = Arena_alloc(arena, parser->recordCount*sizeof(ScriptRecord));
+    program->strings = Arena_alloc(arena, parser->stringBytes + 1);
+    if (parser->recordCount > 0) memcpy(program->records, parser->records, parser->recordCount*sizeof(ScriptRecord));
+    if (parser->stringBytes > 0) memcpy(program->strings, parser->strings, parser->stringBytes);
+    return program;
+}
+
+ScriptProgram *ScriptFile_compile(Arena *arena, const char *text, int length, const char *fileName)
+{
+    ScriptParser parser = {
+        .fileName = fileName,
+        .cursor = text,
+        .end = text + length,
+        .line = 1,
+        .openScene = -1,
+    };
+
+    while (!parser.error)
+    {
+        SkipSpace(&parser);
+        if (parser.cursor == parser.end) break;
+        const char *word = NULL;
+        int wordLength = ReadWord(&parser, &word);
+        if (!parser.error) ParseDirective(&parser, word, wordLength);
+    }
+
+    ScriptProgram *program = parser.error ? NULL : FinishProgram(&parser, arena);
+    MemFree(parser.records);
+    MemFree(parser.strings);
+    return program;
+}
+
+static int IsStringOffsetValid(const ScriptProgram *program, int offset, int optional)
+{
+    if (offset == SCRIPT_NO_STRING) return optional;
+    return offset >= 0 && offset < program->stringBytes;
+}
+
+static int IsRecordValid(const ScriptProgram *program, const ScriptRecord *record)
+{
+    if (record->stepStart < 0 || record->stepEnd >= program->stepCount) return 0;
+    switch (record->op)
+    {
+        case SCRIPT_OP_TEXT: return IsStringOffsetValid(program, record->args[4].str, 0)
+            && IsStringOffsetValid(program, record->args[5].str, 0);
+        case SCRIPT_OP_MAGNIFY: return IsStringOffsetValid(program, record->args[8].str, 0);
+        case SCRIPT_OP_SCENE: return IsStringOffsetValid(program, record->args[0].str, 0)
+            && IsStringOffsetValid(program, record->args[1].str, 1);
+        case SCRIPT_OP_NAVIGATION: return 1;
+        case SCRIPT_OP_LABEL: return IsStringOffsetValid(program, record->args[0].str, 0);
+        case SCRIPT_OP_CAMERA:
+        case SCRIPT_OP_FADE:
+        case SCRIPT_OP_ADVANCE: return 1;
+        case SCRIPT_OP_VIEWPORT: return IsStringOffsetValid(program, record->args[4].str, 0)
+            && IsStringOffsetValid(program, record->args[5].str, 1);
+        default: return 0;
+    }
+}
+
+ScriptProgram *ScriptFile_loadBinary(Arena *arena, unsigned char *data, int size, const char *fileName)
+{
+    ScriptBinaryHeader header;
+    if (size < (int)sizeof(header))
+    {
+        TraceLog(LOG_ERROR, "Script: %s: file is too small", fileName);
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, SCRIPT_BINARY_MAGIC, 4) != 0 || header.version != SCRIPT_BINARY_VERSION)
+    {
+        TraceLog(LOG_ERROR, "Script: %s: not a compiled script or wrong version", fileName);
+        return NULL;
+    }
+    long long expectedSize = (long long)sizeof(header) + (long long)header.recordCount*sizeof(ScriptRecord) + header.stringBytes;
+    if (header.recordCount < 0 || header.stringBytes < 1 || expectedSize != size || data[size - 1] != '\0')
+    {
+        TraceLog(LOG_ERROR, "Script: %s: corrupt file", fileName);
+        return NULL;
+    }
+
+    ScriptProgram *program = Arena_alloc(arena, sizeof(ScriptProgram));
+    program->recordCount = header.recordCount;
+    program->stepCount = header.stepCount;
+    program->stringBytes = header.stringBytes;
+    program->records = (ScriptRecord*)(data + sizeof(header));
+    program->strings = (char*)(data + sizeof(header) + header.recordCount*sizeof(ScriptRecord));
+    for (int i = 0; i < program->recordCount; i++)
+    {
+        if (!IsRecordValid(program, &program->records[i]))
+        {
+            TraceLog(LOG_ERROR, "Script: %s: invalid record %d", fileName, i);
+            return NULL;
+        }
+    }
+    return program;
+}
+
+static unsigned char *SerializeProgram(const ScriptProgram *program, int *size)
+{
+    ScriptBinaryHeader header = {
+        .magic = SCRIPT_BINARY_MAGIC,
+        .version = SCRIPT_BINARY_VERSION,
+        .recordCount = program->recordCount,
+        .stepCount = program->stepCount,
+        .stringBytes = program->stringBytes,
+    };
+    int recordBytes = program->recordCount*sizeof(ScriptRecord);
+    *size = sizeof(header) + recordBytes + program->stringBytes;
+    unsigned char *data = MemAlloc(*size);
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + sizeof(header), program->records, recordBytes);
+    memcpy(data + sizeof(header) + recordBytes, program->strings, program->stringBytes);
+    return data;
+}
+
+int ScriptFile_saveBinary(const ScriptProgram *program, const char *fileName)
+{
+    int size = 0;
+    unsigned char *data = SerializeProgram(program, &size);
+    int success = SaveFileData(fileName, data, size);
+    MemFree(data);
+    if (success) TraceLog(LOG_INFO, "Script: compiled %s (%d bytes)", fileName, size);
+    return success;
+}
+
+ScriptProgram *ScriptFile_load(Arena *arena, const char *fileName, int fromBundle)
+{
+    int size = 0;
+    const char *bundled = fromBundle ? Bundle_getText(fileName) : NULL;
+    if (bundled)
+    {
+        // parsed straight from the bundle, the program only references the arena
+        Bundle_getData(fileName, &size);
+        return ScriptFile_compile(arena, bundled, size - 1, fileName);
+    }
+
+    unsigned char *fileData = LoadFileData(fileName, &size);
+    if (fileData == NULL) return NULL;
+
+    ScriptProgram *program = NULL;
+    if (IsFileExtension(fileName, ".scriptbin"))
+    {
+        // the program points into the data, so it has to live in the arena
+        unsigned char *data = Arena_alloc(arena, size);
+        memcpy(data, fileData, size);
+        program = ScriptFile_loadBinary(arena, data, size, fileName);
+    }
+    else
+    {
+        program = ScriptFile_compile(arena, (const char*)fileData, size, fileName);
+    }
+    UnloadFileData(fileData);
+    return program;
+}
+
+const char *ScriptProgram_getString(const ScriptProgram *program, int offset)
+{
+    return offset == SCRIPT_NO_STRING ? NULL : program->strings + offset;
+}
+
+static void *FindBinding(const char *name, const char **names, void **values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], name) == 0) return values[i];
+    }
+    return NULL;
+}
+
+// scene name, optional model name and the two arguments of the scene's data
+static int LinkScene(const ScriptProgram *program, const ScriptBindings *bindings, const ScriptArg *args,
+    void (**drawFn)(void*), void **drawData)
+{
+    const char *name = ScriptProgram_getString(program, args[0].str);
+    const char *modelName = ScriptProgram_getString(program, args[1].str);
+    const ScriptSceneBinding *scene = NULL;
+    for (int s = 0; s < bindings->sceneCount; s++)
+    {
+        if (strcmp(bindings->scenes[s].name, name) == 0) scene = &bindings->scenes[s];
+    }
+    Model *model = modelName ? FindBinding(modelName, bindings->modelNames, (void**)bindings->models, bindings->modelCount) : NULL;
+    if (scene == NULL || (modelName && model == NULL))
+    {
+        TraceLog(LOG_ERROR, "Script: unknown scene '%s' or model '%s'", name, modelName ? modelName : "");
+        return 0;
+    }
+    *drawFn = scene->drawFn;
+    *drawData = scene->newData ? scene->newData(model, args[2].i, args[3].i) : model;
+    return 1;
+}
+
+int ScriptFile_link(Script *script, const ScriptProgram *program, const ScriptBindings *bindings)
+{
+    for (int i = 0; i < program->recordCount; i++)
+    {
+        const ScriptRecord *record = &program->records[i];
+        const ScriptArg *args = record->args;
+        ScriptAction action = { .actionIdStart = record->stepStart, .actionIdEnd = record->stepEnd };
+        switch (record->op)
+        {
+            case SCRIPT_OP_TEXT:
+            {
+                action.action = ScriptAction_updateTextRect;
+                action.drawUi = ScriptAction_drawTextRect;
+                action.enter = ScriptAction_enterTextRect;
+                action.actionData = ScriptAction_DrawTextRectData_new(
+                    ScriptProgram_getString(program, args[4].str),
+                    ScriptProgram_getString(program, args[5].str),
+                    (Rectangle){args[0].f, args[1].f, args[2].f, args[3].f},
+                    (Vector2){args[6].f, args[7].f}, args[8].f);
+            } break;
+            case SCRIPT_OP_MAGNIFY:
+            {
+                const char *name = ScriptProgram_getString(program, args[8].str);
+                Texture2D *texture = FindBinding(name, bindings->textureNames, (void**)bindings->textures, bindings->textureCount);
+                if (texture == NULL)
+                {
+                    TraceLog(LOG_ERROR, "Script: unknown texture '%s'", name);
+                    return 0;
+                }
+                action.action = ScriptAction_drawMagnifiedTexture;
+                action.drawUi = ScriptAction_drawMagnifierFrame;
+                action.actionData = ScriptAction_DrawMagnifiedTextureData_new(
+                    (Rectangle){args[0].f, args[1].f, args[2].f, args[3].f},
+                    (Rectangle){args[4].f, args[5].f, args[6].f, args[7].f},
+                    texture);
+            } break;
+            case SCRIPT_OP_SCENE:
+            {
+                void (*drawFn)(void*);
+                void *data;
+                if (!LinkScene(program, bindings, args, &drawFn, &data)) return 0;
+                action.action = ScriptAction_setDrawScene;
+                action.actionData = ScriptAction_SetDrawSceneData_new(drawFn, data);
+            } break;
+            case SCRIPT_OP_VIEWPORT:
+            {
+                void (*drawFn)(void*);
+                void *data;
+                if (!LinkScene(program, bindings, &args[4], &drawFn, &data)) return 0;
+                action.enter = ScriptAction_enterViewport;
+                action.actionData = ScriptAction_ViewportData_new((Viewport){
+                    .rect = (Rectangle){args[0].f, args[1].f, args[2].f, args[3].f},
+                    .followsOrbit = 1,
+                    .orbitYaw = args[8].f * DEG2RAD,
+                    .drawSceneFn = drawFn,
+                    .drawSceneData = data,
+                    .renderScale = args[9].i,
+                });
+            } break;
+            case SCRIPT_OP_NAVIGATION:
+            {
+                action.action = ScriptAction_jumpStep;
+                action.drawUi = ScriptAction_drawJumpButtons;
+                action.actionData = ScriptAction_JumpStepData_new(args[0].i, args[1].i, args[2].i);
+            } break;
+            case SCRIPT_OP_CAMERA:
+            {
+                action.enter = ScriptAction_enterCamera;
+                action.actionData = ScriptAction_CameraData_new(args[0].f, args[1].f, args[2].f, args[3].f);
+            } break;
+            case SCRIPT_OP_FADE:
+            {
+                action.enter = ScriptAction_enterFade;
+                action.actionData = ScriptAction_DurationData_new(args[0].f);
+            } break;
+            case SCRIPT_OP_ADVANCE:
+            {
+                action.action = ScriptAction_autoAdvance;
+                action.actionData = ScriptAction_DurationData_new(args[0].f);
+            } break;
+            case SCRIPT_OP_LABEL:
+            {
+                Script_addLabel(script, ScriptProgram_getString(program, args[0].str), record->stepStart);
+            } continue;
+            default: return 0;
+        }
+        Script_appendAction(script, action);
+    }
+    script->stepCount = program->stepCount;
+    return 1;
+}
+
+void ScriptFile_benchmark(int stepCount)
+{
+    int capacity = stepCount*160 + 64;
+    char *text = MemAlloc(capacity);
+    int length = 0;
+    for (int i = 0; i < stepCount && length < capacity - 160; i++)
+    {
+        if (i % 8 == 0) length += snprintf(text + length, capacity - length, "scene outlined flatVectorScene 2 %d\n", i & 1);
+        if (i % 100 == 0) length += snprintf(text + length, capacity - length, "label chapter%d\n", i / 100);
+        length += snprintf(text + length, capacity - length,
+            "text 20 20 200 220 \"Step %d\"\n    \"Generated body text,\\n\" \"second line.\"\n", i);
+        if (i % 16 == 0) length += snprintf(text + length, capacity - length, "magnify 180 140 16 16 20 240 200 200 sceneTexture for 2\n");
+        length += snprintf(text + length, capacity - length, "step\n");
+    }
+
+    Arena arena = {0};
+    double start = GetTime();
+    ScriptProgram *program = ScriptFile_compile(&arena, text, length, "benchmark");
+    double parseSeconds = GetTime() - start;
+    if (program)
+    {
+        int binarySize = 0;
+        unsigned char *binary = SerializeProgram(program, &binarySize);
+        Arena binaryArena = {0};
+        start = GetTime();
+        ScriptProgram *loaded = ScriptFile_loadBinary(&binaryArena, binary, binarySize, "benchmark");
+        double loadSeconds = GetTime() - start;
+
+        TraceLog(LOG_INFO, "Script benchmark: %d steps, %d records, %.1f KB text, %.1f KB arena",
+            program->stepCount, program->recordCount, length/1024.0, arena.used/1024.0);
+        TraceLog(LOG_INFO, "    text: %.2f ms, %.1f MB/s, %.0f steps/s", parseSeconds*1000.0,
+            length/parseSeconds/(1024.0*1024.0), program->stepCount/parseSeconds);
+        TraceLog(LOG_INFO, "    binary (%.1f KB): %.2f ms%s", binarySize/1024.0, loadSeconds*1000.0, loaded ? "" : " - failed");
+        Arena_free(&binaryArena);
+        MemFree(binary);
+    }
+    Arena_free(&arena);
+    MemFree(text);
+}
@@ -0,0 +1,107 @@
+#ifndef __GAME_SCRIPTFILE_H__
+#define __GAME_SCRIPTFILE_H__
+
+#include "main.h"
+#include "arena.h"
+
+// Tutorial scripts are authored as text (*.script) and can be compiled into a
+// binary form (*.scriptbin) that is loaded without parsing. Both are turned into a
+// ScriptProgram: a flat list of records plus a string table, which is then linked
+// into ScriptActions by resolving scene, model and texture names.
+//
+// Text format, tokens are separated by whitespace:
+//
+//   # comment until the end of the line
+//   step                                  starts the next step, the first step is 0
+//   text <x> <y> <w> <h> "title" "body"   text panel; adjacent body strings are concatenated,
+//                                         \n, \" and \\ are escaped like in C
+//   magnify <sx> <sy> <sw> <sh> <dx> <dy> <dw> <dh> <texture>
+//   scene <name> [model] [arg] [arg]      scene used from this step until the next scene
+//   navigation <prev> <next> relative|absolute
+//                                         next/previous buttons on every step
+//   label <name>                          names the current step, see Script_seekLabel
+//   camera <pitch> <yaw> <distance> [seconds]
+//                                         moves the orbit camera when the step is entered
+//   fade <seconds>                        fades the scene in when the step is entered
+//   advance <seconds>                     goes to the next step after the given time
+//   viewport <x> <y> <w> <h> <scene> [model] [arg] [arg] [yaw <degrees>] [scale <n>]
+//                                         another view of a scene in a screen rectangle,
+//                                         seen by the orbit camera turned by yaw degrees
+//                                         and rendered at 1/n of the resolution (default:
+//                                         the main scene's); see Viewport in main.h
+//
+// A text panel can slide in with "from <x> <y> <seconds>" after its strings. Any text,
+// magnify or viewport line can be followed by "for <n>" to show it for n steps.
+
+#define SCRIPT_RECORD_MAX_ARGS 10
+#define SCRIPT_NO_STRING -1
+
+typedef enum ScriptOp {
+    SCRIPT_OP_TEXT = 1,
+    SCRIPT_OP_MAGNIFY,
+    SCRIPT_OP_SCENE,
+    SCRIPT_OP_NAVIGATION,
+    SCRIPT_OP_LABEL,
+    SCRIPT_OP_CAMERA,
+    SCRIPT_OP_FADE,
+    SCRIPT_OP_ADVANCE,
+    SCRIPT_OP_VIEWPORT,
+} ScriptOp;
+
+typedef union ScriptArg {
+    int i;
+    float f;
+    int str;                // offset into the string table or SCRIPT_NO_STRING
+} ScriptArg;
+
+typedef struct ScriptRecord {
+    int op;
+    int stepStart, stepEnd;
+    ScriptArg args[SCRIPT_RECORD_MAX_ARGS];
+} ScriptRecord;
+
+typedef struct ScriptProgram {
+    int recordCount;
+    int stepCount;
+    int stringBytes;
+    ScriptRecord *records;
+    char *strings;
+} ScriptProgram;
+
+typedef struct ScriptSceneBinding {
+    const char *name;
+    void (*drawFn)(void *data);
+    // builds the draw data from the model and the two integer arguments,
+    // NULL: the model itself is the draw data
+    void *(*newData)(Model *model, int arg0, int arg1);
+} ScriptSceneBinding;
+
+typedef struct ScriptBindings {
+    const ScriptSceneBinding *scenes;
+    int sceneCount;
+    const char **modelNames;
+    Model **models;
+    int modelCount;
+    const char **textureNames;
+    Texture2D **textures;
+    int textureCount;
+} ScriptBindings;
+
+// parse the text form; everything, including the program itself, lives in the arena
+ScriptProgram *ScriptFile_compile(Arena *arena, const char *text, int length, const char *fileName);
+// read the binary form in place from data that must stay valid as long as the program
+ScriptProgram *ScriptFile_loadBinary(Arena *arena, unsigned char *data, int size, const char *fileName);
+int ScriptFile_saveBinary(const ScriptProgram *program, const char *fileName);
+// loads a .script or .scriptbin file, depending on the extension; with fromBundle, a
+// script text packed into the open bundle is used instead of the file
+ScriptProgram *ScriptFile_load(Arena *arena, const char *fileName, int fromBundle);
+const char *ScriptProgram_getString(const ScriptProgram *program, int offset);
+
+// adds the actions and labels of the program to the script; returns 0 if a name could
+// not be resolved
+int ScriptFile_link(Script *script, const ScriptProgram *program, const ScriptBindings *bindings);
+
+// parses a generated script with the given number of steps and logs the throughput
+void ScriptFile_benchmark(int stepCount);
+
+#endif
@@ -0,0 +1,291 @@
+#include "sdffont.h"
+#include "jobs.h"
+#include "alloctrack.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDF_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// alpha from which a pixel of the source font counts as inside the glyph
+#define SDF_INSIDE_ALPHA 128
+// distances past the spread are all the same
+#define SDF_FAR (SDF_FONT_SPREAD + 1.0f)
+
+typedef struct SdfFontEntry {
+    unsigned int textureId;
+    int sourceSize;
+} SdfFontEntry;
+
+static struct {
+    SdfFontEntry fonts[SDF_FONT_MAX];
+    int fontCount;
+    Shader shader;
+} _sdf;
+
+typedef struct SdfGlyphJob {
+    Font font;
+    Image source;
+    // cells of the glyphs in the atlas, with the spread around the glyph
+    const Rectangle *cells;
+    unsigned char *atlas;
+    int atlasWidth;
+} SdfGlyphJob;
+
+// dst[i] = min(dst[i], src[i] + add)
+static void MinAddRow(float *dst, const float *src, float add, int count)
+{
+    int i = 0;
+#if defined(SDF_USE_SSE2)
+    __m128 add4 = _mm_set1_ps(add);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_min_ps(_mm_loadu_ps(dst + i), _mm_add_ps(_mm_loadu_ps(src + i), add4)));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float value = src[i] + add;
+        if (value < dst[i]) dst[i] = value;
+    }
+}
+
+static void SquareRow(float *row, int count)
+{
+    int i = 0;
+#if defined(SDF_USE_SSE2)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 value = _mm_loadu_ps(row + i);
+        _mm_storeu_ps(row + i, _mm_mul_ps(value, value));
+    }
+#endif
+    for (; i < count; i++) row[i] *= row[i];
+}
+
+// squared distance of every pixel to the nearest pixel whose mask is target, exact up to
+// the spread; columns has room for height rows of width plus the spread on both sides
+static void DistanceTransform(const unsigned char *mask, unsigned char target, int width, int height,
+    float *columns, float *result)
+{
+    const int spread = SDF_FONT_SPREAD;
+    int stride = width + 2*spread;
+    for (int y = 0; y < height; y++)
+    {
+        float *row = columns + y*stride;
+        for (int x = 0; x < stride; x++) row[x] = SDF_FAR;
+        for (int x = 0; x < width; x++)
+        {
+            if (mask[y*width + x] == target) row[spread + x] = 0.0f;
+        }
+    }
+    // vertical distance, down and up
+    for (int y = 1; y < height; y++) MinAddRow(columns + y*stride, columns + (y - 1)*stride, 1.0f, stride);
+    for (int y = height - 2; y >= 0; y--) MinAddRow(columns + y*stride, columns + (y + 1)*stride, 1.0f, stride);
+    for (int y = 0; y < height; y++) SquareRow(columns + y*stride, stride);
+
+    // nearest column within the spread; the padding is far, so the window never leaves the row
+    for (int y = 0; y < height; y++)
+    {
+        const float *row = columns + y*stride + spread;
+        float *out = result + y*width;
+        memcpy(out, row, width*sizeof(float));
+        for (int k = 1; k <= spread; k++)
+        {
+            MinAddRow(out, row - k, (float)(k*k), width);
+            MinAddRow(out, row + k, (float)(k*k), width);
+        }
+    }
+}
+
+static void GenerateGlyph(int index, void *userData)
+{
+    SdfGlyphJob *job = userData;
+    const int spread = SDF_FONT_SPREAD;
+    Rectangle rec = job->font.recs[index];
+    Rectangle cell = job->cells[index];
+    int width = (int)cell.width;
+    int height = (int)cell.height;
+    int glyphWidth = (int)rec.width*SDF_FONT_UPSCALE;
+    int glyphHeight = (int)rec.height*SDF_FONT_UPSCALE;
+    if (width <= 0 || height <= 0) return;
+
+    int pixelCount = width*height;
+    int columnCount = (width + 2*spread)*height;
+    float *columns = MemAlloc((columnCount + 2*pixelCount)*sizeof(float) + pixelCount);
+    float *outside = columns + columnCount;
+    float *inside = outside + pixelCount;
+    unsigned char *mask = (unsigned char*)(inside + pixelCount);
+
+    // nearest neighbor upscale, the source pixels are RGBA
+    const unsigned char *source = job->source.data;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int glyphX = x - spread, glyphY = y - spread;
+            int isInside = 0;
+            if (glyphX >= 0 && glyphY >= 0 && glyphX < glyphWidth && glyphY < glyphHeight)
+            {
+                int sourceX = (int)rec.x + glyphX/SDF_FONT_UPSCALE;
+                int sourceY = (int)rec.y + glyphY/SDF_FONT_UPSCALE;
+                isInside = source[(sourceY*job->source.width + sourceX)*4 + 3] >= SDF_INSIDE_ALPHA;
+            }
+            mask[y*width + x] = (unsigned char)isInside;
+        }
+    }
+
+    // distance to the inside for outside pixels and to the outside for inside ones, both 0
+    // on their own side; the edge lies half a pixel from the centers next to it
+    DistanceTransform(mask, 1, width, height, columns, outside);
+    DistanceTransform(mask, 0, width, height, columns, inside);
+    for (int y = 0; y < height; y++)
+    {
+        unsigned char *dst = job->atlas + (((int)cell.y + y)*job->atlasWidth + (int)cell.x)*2;
+        for (int x = 0; x < width; x++)
+        {
+            int i = y*width + x;
+            float distance = mask[i] ? 0.5f - sqrtf(inside[i]) : sqrtf(outside[i]) - 0.5f;
+            float value = 0.5f - distance/(2.0f*spread);
+            value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+            dst[x*2] = 255;
+            dst[x*2 + 1] = (unsigned char)(value*255.0f + 0.5f);
+        }
+    }
+    MemFree(columns);
+}
+
+Font SdfFont_generate(Font font)
+{
+    double start = GetTime();
+    if (font.glyphCount == 0) return font;
+    if (_sdf.fontCount == SDF_FONT_MAX)
+    {
+        TraceLog(LOG_WARNING, "SdfFont_generate: no room for another font");
+        return font;
+    }
+    Image source = LoadImageFromTexture(font.texture);
+    if (source.data == NULL)
+    {
+        TraceLog(LOG_WARNING, "SdfFont_generate: the font's texture could not be read back");
+        return font;
+    }
+    ImageFormat(&source, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    // cells in shelves, the width a power of two about the square root of the area
+    const int spread = SDF_FONT_SPREAD;
+    Rectangle *cells = MemAlloc(font.glyphCount*sizeof(Rectangle));
+    float area = 0.0f;
+    for (int i = 0; i < font.glyphCount; i++)
+    {
+        area += (font.recs[i].width*SDF_FONT_UPSCALE + 2*spread)*(font.recs[i].height*SDF_FONT_UPSCALE + 2*spread);
+    }
+    int atlasWidth = 64;
+    while ((float)atlasWidth*atlasWidth < area) atlasWidth *= 2;
+    int x = 0, y = 0, shelfHeight = 0;
+    for (int i = 0; i < font.glyphCount; i++)
+    {
+        int width = (int)font.recs[i].width*SDF_FONT_UPSCALE + 2*spread;
+        int height = (int)font.recs[i].height*SDF_FONT_UPSCALE + 2*spread;
+        if (width > atlasWidth) atlasWidth = width;
+        if (x + width > atlasWidth)
+        {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        cells[i] = (Rectangle){ (float)x, (float)y, (float)width, (float)height };
+        x += width;
+        if (height > shelfHeight) shelfHeight = height;
+    }
+    int atlasHeight = y + shelfHeight;
+
+    // cells that do not cover the atlas stay transparent
+    unsigned char *atlas = MemAlloc(atlasWidth*atlasHeight*2);
+    memset(atlas, 0, atlasWidth*atlasHeight*2);
+    SdfGlyphJob job = { font, source, cells, atlas, atlasWidth };
+    Jobs_parallelFor(font.glyphCount, GenerateGlyph, &job);
+    UnloadImage(source);
+
+    Image image = { .data = atlas, .width = atlasWidth, .height = atlasHeight, .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+    Font sdf = {
+        .baseSize = font.baseSize*SDF_FONT_UPSCALE,
+        .glyphCount = font.glyphCount,
+        .glyphPadding = spread,
+        .texture = LoadTextureFromImage(image),
+        .recs = cells,
+        .glyphs = MemAlloc(font.glyphCount*sizeof(GlyphInfo)),
+    };
+    MemFree(atlas);
+    SetTextureFilter(sdf.texture, TEXTURE_FILTER_BILINEAR);
+    for (int i = 0; i < font.glyphCount; i++)
+    {
+        // the recs are the glyphs inside the cells, raylib adds the padding when drawing
+        cells[i] = (Rectangle){ cells[i].x + spread, cells[i].y + spread, font.recs[i].width*SDF_FONT_UPSCALE,
+            font.recs[i].height*SDF_FONT_UPSCALE };
+        sdf.glyphs[i] = (GlyphInfo){
+            .value = font.glyphs[i].value,
+            .offsetX = font.glyphs[i].offsetX*SDF_FONT_UPSCALE,
+            .offsetY = font.glyphs[i].offsetY*SDF_FONT_UPSCALE,
+            .advanceX = font.glyphs[i].advanceX*SDF_FONT_UPSCALE,
+        };
+    }
+    _sdf.fonts[_sdf.fontCount++] = (SdfFontEntry){ sdf.texture.id, font.baseSize };
+    TraceLog(LOG_INFO, "SdfFont_generate: %d glyphs into %dx%d in %.2f ms on %d threads", font.glyphCount, atlasWidth,
+        atlasHeight, (GetTime() - start)*1000.0, Jobs_getThreadCount());
+    return sdf;
+}
+
+static int FindFont(Font font)
+{
+    for (int i = 0; i < _sdf.fontCount; i++)
+    {
+        if (_sdf.fonts[i].textureId == font.texture.id) return i;
+    }
+    return -1;
+}
+
+void SdfFont_unload(Font font)
+{
+    int index = FindFont(font);
+    if (index < 0)
+    {
+        UnloadFont(font);
+        return;
+    }
+    _sdf.fonts[index] = _sdf.fonts[--_sdf.fontCount];
+    UnloadTexture(font.texture);
+    MemFree(font.recs);
+    MemFree(font.glyphs);
+}
+
+int SdfFont_isSdf(Font font)
+{
+    return FindFont(font) >= 0;
+}
+
+int SdfFont_getSourceSize(Font font)
+{
+    int index = FindFont(font);
+    return index < 0 ? font.baseSize : _sdf.fonts[index].sourceSize;
+}
+
+void SdfFont_setShader(Shader shader)
+{
+    _sdf.shader = shader;
+}
+
+int SdfFont_beginDraw(Font font)
+{
+    if (_sdf.shader.id == 0 || FindFont(font) < 0) return 0;
+    BeginShaderMode(_sdf.shader);
+    return 1;
+}
+
+void SdfFont_endDraw(int began)
+{
+    if (began) EndShaderMode();
+}
@@ -0,0 +1,39 @@
+#ifndef __GAME_SDFFONT_H__
+#define __GAME_SDFFONT_H__
+
+#include "raylib.h"
+
+// Signed distance field atlases for the bitmap fonts, so that one atlas draws crisp text at
+// any size. SdfFont_generate reads the glyphs of a loaded font back from its texture, puts
+// each one SDF_FONT_UPSCALE times larger into a cell of a new atlas and replaces its pixels
+// with the distance to the glyph's edge: 128 on the edge, 255 and 0 at SDF_FONT_SPREAD
+// atlas pixels inside and outside. The distance goes into the alpha channel, so a draw
+// without the shader still shows a soft glyph.
+//
+// The distance transform is the exact Euclidean one up to the spread: a pass down and up
+// the columns finds the vertical distance to the nearest pixel of the other side, a pass
+// along the rows the nearest of those within the spread. Both passes work on whole rows,
+// four pixels per instruction with SSE2. Glyphs are transformed in parallel on the worker
+// pool.
+//
+// A generated font has SDF_FONT_UPSCALE times the base size of its source and must be drawn
+// with the SDF shader (SdfFont_beginDraw), which the rich text functions of util.h do.
+
+#define SDF_FONT_UPSCALE 4
+#define SDF_FONT_SPREAD 8
+#define SDF_FONT_MAX 4
+
+// the source font stays loaded; returns the source font if it could not be read back
+Font SdfFont_generate(Font font);
+// unloads fonts of either kind
+void SdfFont_unload(Font font);
+int SdfFont_isSdf(Font font);
+// base size of the source font, the size its glyph pixels are 1:1 at; baseSize for other fonts
+int SdfFont_getSourceSize(Font font);
+// shader for the text of SDF fonts, see resources/sdf_text.fs
+void SdfFont_setShader(Shader shader);
+// begins the shader mode if the font is an SDF font and returns whether it did, for SdfFont_endDraw
+int SdfFont_beginDraw(Font font);
+void SdfFont_endDraw(int began);
+
+#endif
@@ -0,0 +1,290 @@
+#include "shadervariant.h"
+#include "rlgl.h"
+#include "alloctrack.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(GAME_GPU_TIMERS)
+#include "glentry.h"
+#include <external/glad.h>
+
+#define SHADER_TIMER_QUERY_COUNT 8
+
+typedef struct ShaderTimerQuery {
+    unsigned int query;
+    ShaderVariant *variant;
+    int pending;
+} ShaderTimerQuery;
+
+static ShaderTimerQuery _shaderTimerQueries[SHADER_TIMER_QUERY_COUNT];
+static ShaderTimerQuery *_activeShaderTimerQuery;
+static int _areShaderTimersChecked;
+static int _areShaderTimersAvailable;
+#endif
+static double _shaderTimingStart;
+
+static void ShaderVariant_addTimingSample(ShaderVariant *variant, float ms, int isGpu)
+{
+    // a variant measured both ways starts over
+    if (variant->timingIsGpu != isGpu) variant->timingSamples = 0, variant->timingTotalMs = 0.0;
+    variant->timingIsGpu = isGpu;
+    variant->timingSamples++;
+    variant->timingTotalMs += ms;
+    variant->timingLastMs = ms;
+}
+
+static char *BuildVariantSource(ShaderVariantSet *set, const char *code, int featureMask)
+{
+    if (code == NULL) return NULL;
+
+    int length = strlen(code) + 1;
+    for (int i = 0; i < set->featureCount; i++)
+    {
+        if (featureMask & (1 << i)) length += strlen(set->features[i]) + 10;
+    }
+
+    char *source = MemAlloc(length);
+    char *pos = source;
+    for (int i = 0; i < set->featureCount; i++)
+    {
+        if (featureMask & (1 << i)) pos += sprintf(pos, "#define %s\n", set->features[i]);
+    }
+    strcpy(pos, code);
+    return source;
+}
+
+void ShaderVariantSet_loadFromMemory(ShaderVariantSet *set, const char *name, const char *vsCode, const char *fsCode,
+    const char **features, int featureCount)
+{
+    *set = (ShaderVariantSet){0};
+    set->name = name;
+    if (featureCount > SHADER_VARIANT_MAX_FEATURES)
+    {
+        TraceLog(LOG_WARNING, "ShaderVariantSet_load: %s has too many features", name);
+        featureCount = SHADER_VARIANT_MAX_FEATURES;
+    }
+    for (int i = 0; i < featureCount; i++) set->features[i] = features[i];
+    set->featureCount = featureCount;
+    set->vsCode = vsCode;
+    set->fsCode = fsCode;
+}
+
+void ShaderVariantSet_load(ShaderVariantSet *set, const char *name, const char *vsFileName, const char *fsFileName,
+    const char **features, int featureCount)
+{
+    ShaderVariantSet_loadFromMemory(set, name, vsFileName ? LoadFileText(vsFileName) : NULL,
+        fsFileName ? LoadFileText(fsFileName) : NULL, features, featureCount);
+    set->vsFileName = vsFileName;
+    set->fsFileName = fsFileName;
+    set->ownsCode = 1;
+}
+
+#if defined(GAME_GPU_TIMERS)
+// drops the results still in flight for the variants of the set, whose samples would land
+// in the next set loaded there; the queries are deleted once none is in flight
+static void ReleaseShaderTimerQueries(ShaderVariantSet *set)
+{
+    int pendingCount = 0;
+    for (int i = 0; i < SHADER_TIMER_QUERY_COUNT; i++)
+    {
+        ShaderTimerQuery *timer = &_shaderTimerQueries[i];
+        if (timer->variant >= set->variants && timer->variant < set->variants + SHADER_VARIANT_MAX_VARIANTS)
+        {
+            timer->variant = NULL;
+            timer->pending = 0;
+        }
+        pendingCount += timer->pending;
+    }
+    if (pendingCount > 0 || !_areShaderTimersAvailable) return;
+    for (int i = 0; i < SHADER_TIMER_QUERY_COUNT; i++)
+    {
+        ShaderTimerQuery *timer = &_shaderTimerQueries[i];
+        if (timer->query != 0) glDeleteQueries(1, &timer->query);
+        *timer = (ShaderTimerQuery){0};
+    }
+}
+#endif
+
+void ShaderVariantSet_unload(ShaderVariantSet *set)
+{
+#if defined(GAME_GPU_TIMERS)
+    ReleaseShaderTimerQueries(set);
+#endif
+    for (int i = 0; i < SHADER_VARIANT_MAX_VARIANTS; i++)
+    {
+        if (set->variants[i].isLoaded) UnloadShader(set->variants[i].shader);
+    }
+    if (set->ownsCode && set->vsCode) UnloadFileText((char*)set->vsCode);
+    if (set->ownsCode && set->fsCode) UnloadFileText((char*)set->fsCode);
+    *set = (ShaderVariantSet){0};
+}
+
+ShaderVariant *ShaderVariantSet_get(ShaderVariantSet *set, int featureMask)
+{
+    featureMask &= (1 << set->featureCount) - 1;
+    ShaderVariant *variant = &set->variants[featureMask];
+    if (variant->isLoaded) return variant;
+
+    char *vsSource = BuildVariantSource(set, set->vsCode, featureMask);
+    char *fsSource = BuildVariantSource(set, set->fsCode, featureMask);
+    variant->shader = LoadShaderFromMemory(vsSource, fsSource);
+    variant->featureMask = featureMask;
+    variant->isLoaded = 1;
+    for (int i = 0; i < set->uniformCount; i++) variant->uniformLocs[i] = GetShaderLocation(variant->shader, set->uniformNames[i]);
+    if (vsSource) MemFree(vsSource);
+    if (fsSource) MemFree(fsSource);
+
+    TraceLog(LOG_INFO, "ShaderVariantSet: compiled %s [%s]", set->name, ShaderVariantSet_getVariantName(set, featureMask));
+    return variant;
+}
+
+void ShaderVariantSet_precompile(ShaderVariantSet *set)
+{
+    for (int i = 0; i < (1 << set->featureCount); i++) ShaderVariantSet_get(set, i);
+}
+
+// index of the uniform in the set's table, adding it and looking up its locations in the
+// loaded variants on first use; -1 when the table is full or the name too long
+static int FindUniform(ShaderVariantSet *set, const char *uniformName)
+{
+    for (int i = 0; i < set->uniformCount; i++)
+    {
+        if (strcmp(set->uniformNames[i], uniformName) == 0) return i;
+    }
+    if (set->uniformCount == SHADER_VARIANT_MAX_UNIFORMS || strlen(uniformName) >= SHADER_VARIANT_UNIFORM_NAME_LENGTH)
+    {
+        TraceLog(LOG_WARNING, "ShaderVariantSet: %s: location of %s is not cached", set->name, uniformName);
+        return -1;
+    }
+    int index = set->uniformCount++;
+    strcpy(set->uniformNames[index], uniformName);
+    for (int i = 0; i < SHADER_VARIANT_MAX_VARIANTS; i++)
+    {
+        ShaderVariant *variant = &set->variants[i];
+        if (variant->isLoaded) variant->uniformLocs[index] = GetShaderLocation(variant->shader, uniformName);
+    }
+    return index;
+}
+
+void ShaderVariantSet_setValue(ShaderVariantSet *set, const char *uniformName, const void *value, int uniformType)
+{
+    int index = FindUniform(set, uniformName);
+    for (int i = 0; i < SHADER_VARIANT_MAX_VARIANTS; i++)
+    {
+        ShaderVariant *variant = &set->variants[i];
+        if (!variant->isLoaded) continue;
+        int loc = index >= 0 ? variant->uniformLocs[index] : GetShaderLocation(variant->shader, uniformName);
+        if (loc >= 0) SetShaderValue(variant->shader, loc, value, uniformType);
+    }
+}
+
+const char *ShaderVariantSet_getVariantName(ShaderVariantSet *set, int featureMask)
+{
+    static char name[128];
+    name[0] = '\0';
+    for (int i = 0; i < set->featureCount; i++)
+    {
+        if ((featureMask & (1 << i)) == 0) continue;
+        if (name[0]) strcat(name, "+");
+        strncat(name, set->features[i], sizeof(name) - strlen(name) - 2);
+    }
+    if (name[0] == '\0') strcpy(name, "base");
+    return name;
+}
+
+void ShaderVariantSet_logStats(ShaderVariantSet *set)
+{
+    for (int i = 0; i < SHADER_VARIANT_MAX_VARIANTS; i++)
+    {
+        ShaderVariant *variant = &set->variants[i];
+        if (!variant->isLoaded || variant->timingSamples == 0) continue;
+        TraceLog(LOG_INFO, "ShaderVariantSet: %s [%s]: %.3f ms %s avg over %d samples",
+            set->name, ShaderVariantSet_getVariantName(set, i), variant->timingTotalMs / variant->timingSamples,
+            variant->timingIsGpu ? "GPU" : "CPU submit", variant->timingSamples);
+    }
+}
+
+#if defined(GAME_GPU_TIMERS)
+// timer queries need GL 3.3 or ARB_timer_query; without them the CPU submit time is measured
+static int AreShaderTimersAvailable()
+{
+    if (_areShaderTimersChecked) return _areShaderTimersAvailable;
+    _areShaderTimersChecked = 1;
+    GlEntry_load();
+    _areShaderTimersAvailable = glGenQueries && glDeleteQueries && glBeginQuery && glEndQuery && glGetQueryObjectiv
+        && glGetQueryObjectui64v;
+    if (!_areShaderTimersAvailable) TraceLog(LOG_WARNING, "ShaderVariant: no timer queries, measuring CPU submit time");
+    return _areShaderTimersAvailable;
+}
+
+static void CollectShaderTimerQueries()
+{
+    for (int i = 0; i < SHADER_TIMER_QUERY_COUNT; i++)
+    {
+        ShaderTimerQuery *timer = &_shaderTimerQueries[i];
+        if (!timer->pending) continue;
+        int available = 0;
+        glGetQueryObjectiv(timer->query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(timer->query, GL_QUERY_RESULT, &elapsedNs);
+        ShaderVariant_addTimingSample(timer->variant, (float)(elapsedNs / 1.0e6), 1);
+        timer->pending = 0;
+    }
+}
+
+static void BeginTimerQuery(ShaderVariant *variant)
+{
+    CollectShaderTimerQueries();
+    _activeShaderTimerQuery = NULL;
+    for (int i = 0; i < SHADER_TIMER_QUERY_COUNT; i++)
+    {
+        ShaderTimerQuery *timer = &_shaderTimerQueries[i];
+        if (timer->pending) continue;
+        if (timer->query == 0) glGenQueries(1, &timer->query);
+        _activeShaderTimerQuery = timer;
+        break;
+    }
+    // all queries in flight: skip this sample rather than stalling
+    if (_activeShaderTimerQuery == NULL) return;
+
+    rlDrawRenderBatchActive();
+    _activeShaderTimerQuery->variant = variant;
+    glBeginQuery(GL_TIME_ELAPSED, _activeShaderTimerQuery->query);
+}
+
+static void EndTimerQuery()
+{
+    if (_activeShaderTimerQuery == NULL) return;
+    rlDrawRenderBatchActive();
+    glEndQuery(GL_TIME_ELAPSED);
+    _activeShaderTimerQuery->pending = 1;
+    _activeShaderTimerQuery = NULL;
+}
+#endif
+
+void ShaderVariant_beginTiming(ShaderVariant *variant)
+{
+#if defined(GAME_GPU_TIMERS)
+    if (AreShaderTimersAvailable())
+    {
+        BeginTimerQuery(variant);
+        return;
+    }
+#endif
+    rlDrawRenderBatchActive();
+    _shaderTimingStart = GetTime();
+}
+
+void ShaderVariant_endTiming(ShaderVariant *variant)
+{
+#if defined(GAME_GPU_TIMERS)
+    if (AreShaderTimersAvailable())
+    {
+        EndTimerQuery();
+        return;
+    }
+#endif
+    rlDrawRenderBatchActive();
+    ShaderVariant_addTimingSample(variant, (float)((GetTime() - _shaderTimingStart) * 1000.0), 0);
+}
@@ -0,0 +1,66 @@
+#ifndef __GAME_SHADERVARIANT_H__
+#define __GAME_SHADERVARIANT_H__
+
+#include "raylib.h"
+
+#define SHADER_VARIANT_MAX_FEATURES 4
+#define SHADER_VARIANT_MAX_VARIANTS (1 << SHADER_VARIANT_MAX_FEATURES)
+// uniforms set through ShaderVariantSet_setValue whose locations are cached
+#define SHADER_VARIANT_MAX_UNIFORMS 8
+#define SHADER_VARIANT_UNIFORM_NAME_LENGTH 32
+
+typedef struct ShaderVariant {
+    Shader shader;
+    int featureMask;
+    int isLoaded;
+    // location of each of the set's uniformNames, -1 where the variant does not use it
+    int uniformLocs[SHADER_VARIANT_MAX_UNIFORMS];
+    // cost of the draws done with this variant, see ShaderVariant_beginTiming; GPU time
+    // from timer queries if timingIsGpu, otherwise CPU time to submit and flush the draws
+    int timingIsGpu;
+    int timingSamples;
+    double timingTotalMs;
+    float timingLastMs;
+} ShaderVariant;
+
+// A shader source compiled once per combination of features. Bit i of a feature
+// mask prepends "#define <features[i]>" to both shader stages.
+typedef struct ShaderVariantSet {
+    const char *name;
+    const char *vsFileName;   // NULL: raylib's default vertex shader
+    const char *fsFileName;
+    const char *features[SHADER_VARIANT_MAX_FEATURES];
+    int featureCount;
+    const char *vsCode;
+    const char *fsCode;
+    int ownsCode;           // code was loaded from files and is freed on unload
+    // uniforms set so far; their locations are looked up once per variant, when the name is
+    // first set or when the variant is compiled
+    char uniformNames[SHADER_VARIANT_MAX_UNIFORMS][SHADER_VARIANT_UNIFORM_NAME_LENGTH];
+    int uniformCount;
+    ShaderVariant variants[SHADER_VARIANT_MAX_VARIANTS];
+} ShaderVariantSet;
+
+void ShaderVariantSet_load(ShaderVariantSet *set, const char *name, const char *vsFileName, const char *fsFileName,
+    const char **features, int featureCount);
+// same as ShaderVariantSet_load, the code must stay valid until the set is unloaded
+void ShaderVariantSet_loadFromMemory(ShaderVariantSet *set, const char *name, const char *vsCode, const char *fsCode,
+    const char **features, int featureCount);
+void ShaderVariantSet_unload(ShaderVariantSet *set);
+// returns the variant for the given features, compiling it on first use
+ShaderVariant *ShaderVariantSet_get(ShaderVariantSet *set, int featureMask);
+// compiles all feature combinations so selecting a variant never hitches
+void ShaderVariantSet_precompile(ShaderVariantSet *set);
+// sets a uniform on every loaded variant; the locations are cached, see uniformNames
+void ShaderVariantSet_setValue(ShaderVariantSet *set, const char *uniformName, const void *value, int uniformType);
+void ShaderVariantSet_logStats(ShaderVariantSet *set);
+const char *ShaderVariantSet_getVariantName(ShaderVariantSet *set, int featureMask);
+
+// Measures the draws issued between begin and end. With GAME_GPU_TIMERS defined (the
+// desktop builds, see glentry.h for the entry points) and a context with timer queries
+// this is their GPU time, which arrives a few frames later. Otherwise it is the CPU time
+// to submit and flush the batch, which is driver queueing rather than the shader's cost.
+void ShaderVariant_beginTiming(ShaderVariant *variant);
+void ShaderVariant_endTiming(ShaderVariant *variant);
+
+#endif
@@ -0,0 +1,560 @@
+#include "softraster.h"
+#include "jobs.h"
+#include "alloctrack.h"
+#include <raymath.h>
+#include <math.h>
+#include <string.h>
+#include <stddef.h>
+
+#define SOFTRASTER_TILE_SIZE 32
+#define SOFTRASTER_MAX_MATERIALS 64
+// u, v, u2, v2, viewZ, r, g, b, a
+#define SOFTRASTER_ATTRIB_COUNT 9
+// same near/far planes as rlgl uses in BeginMode3D
+#define SOFTRASTER_NEAR 0.01
+#define SOFTRASTER_FAR 1000.0
+
+typedef struct SoftRasterVertex {
+    Vector4 clip;
+    float attribs[SOFTRASTER_ATTRIB_COUNT];
+} SoftRasterVertex;
+
+typedef struct SoftRasterTriangle {
+    float x[3], y[3];       // window coordinates
+    float z[3];             // depth, 0..1
+    float invW[3];
+    float attribs[3][SOFTRASTER_ATTRIB_COUNT];   // premultiplied by 1/w for perspective correct interpolation
+    float invArea;
+    int minX, minY, maxX, maxY;
+    int material;
+} SoftRasterTriangle;
+
+typedef struct SoftRaster {
+    int width, height;
+    Color clearColor;
+    Color *color;
+    float *depth;
+    // result of SoftRaster_outline
+    Color *outline;
+    int bufferCapacity;
+    int outlineDepth, outlineUv;
+    Matrix view;
+    Matrix projection;
+
+    SoftRasterTriangle *triangles;
+    int triangleCount, triangleCapacity;
+    SoftRasterMaterial materials[SOFTRASTER_MAX_MATERIALS];
+    int materialCount;
+
+    int tilesX, tilesY;
+    int *tileOffsets;       // tileCount + 1 entries, start of each tile's bin in tileTriangles
+    int *tileCursor;
+    int *tilePixels;
+    int tileCapacity;
+    int *tileTriangles;
+    int tileTriangleCapacity;
+
+    SoftRasterStats stats;
+    double beginTime;
+} SoftRaster;
+
+static SoftRaster _softRaster;
+
+static float Fract(float x)
+{
+    return x - floorf(x);
+}
+
+static unsigned char ToUnorm8(float f)
+{
+    if (f <= 0.0f) return 0;
+    if (f >= 1.0f) return 255;
+    return (unsigned char)(f * 255.0f + 0.5f);
+}
+
+static Color SampleNearest(Image image, float u, float v)
+{
+    if (image.data == NULL) return WHITE;
+    int x = (int)(Fract(u) * image.width);
+    int y = (int)(Fract(v) * image.height);
+    if (x >= image.width) x = image.width - 1;
+    if (y >= image.height) y = image.height - 1;
+    return ((Color*)image.data)[y * image.width + x];
+}
+
+static void *GrowArray(void *array, int *capacity, int required, int elementSize)
+{
+    if (required <= *capacity) return array;
+    int newCapacity = *capacity ? *capacity : 256;
+    while (newCapacity < required) newCapacity *= 2;
+    *capacity = newCapacity;
+    return MemRealloc(array, newCapacity * elementSize);
+}
+
+void SoftRaster_begin(int width, int height, Color clearColor)
+{
+    SoftRaster *sr = &_softRaster;
+    sr->beginTime = GetTime();
+    sr->width = width;
+    sr->height = height;
+    sr->clearColor = clearColor;
+    int pixelCount = width * height;
+    if (pixelCount > sr->bufferCapacity)
+    {
+        sr->color = MemRealloc(sr->color, pixelCount * sizeof(Color));
+        sr->depth = MemRealloc(sr->depth, pixelCount * sizeof(float));
+        sr->outline = MemRealloc(sr->outline, pixelCount * sizeof(Color));
+        sr->bufferCapacity = pixelCount;
+    }
+    sr->triangleCount = 0;
+    sr->materialCount = 0;
+    sr->stats = (SoftRasterStats){0};
+    sr->view = MatrixIdentity();
+    sr->projection = MatrixIdentity();
+}
+
+void SoftRaster_setCamera(Camera3D camera)
+{
+    SoftRaster *sr = &_softRaster;
+    double aspect = (double)sr->width / (double)sr->height;
+    sr->view = MatrixLookAt(camera.position, camera.target, camera.up);
+    sr->projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, SOFTRASTER_NEAR, SOFTRASTER_FAR);
+}
+
+static void AddTriangle(SoftRaster *sr, const SoftRasterVertex *a, const SoftRasterVertex *b, const SoftRasterVertex *c, int material)
+{
+    const SoftRasterVertex *v[3] = { a, b, c };
+    SoftRasterTriangle tri;
+    for (int k = 0; k < 3; k++)
+    {
+        float invW = 1.0f / v[k]->clip.w;
+        tri.x[k] = (v[k]->clip.x * invW * 0.5f + 0.5f) * sr->width;
+        tri.y[k] = (v[k]->clip.y * invW * 0.5f + 0.5f) * sr->height;
+        tri.z[k] = v[k]->clip.z * invW * 0.5f + 0.5f;
+        tri.invW[k] = invW;
+        for (int i = 0; i < SOFTRASTER_ATTRIB_COUNT; i++) tri.attribs[k][i] = v[k]->attribs[i] * invW;
+    }
+
+    // counter clockwise is front facing; back faces are culled like raylib does by default
+    float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+    if (area <= 0.0f) return;
+
+    tri.invArea = 1.0f / area;
+    tri.minX = (int)floorf(fminf(tri.x[0], fminf(tri.x[1], tri.x[2])));
+    tri.minY = (int)floorf(fminf(tri.y[0], fminf(tri.y[1], tri.y[2])));
+    tri.maxX = (int)ceilf(fmaxf(tri.x[0], fmaxf(tri.x[1], tri.x[2])));
+    tri.maxY = (int)ceilf(fmaxf(tri.y[0], fmaxf(tri.y[1], tri.y[2])));
+    if (tri.minX < 0) tri.minX = 0;
+    if (tri.minY < 0) tri.minY = 0;
+    if (tri.maxX > sr->width - 1) tri.maxX = sr->width - 1;
+    if (tri.maxY > sr->height - 1) tri.maxY = sr->height - 1;
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+    tri.material = material;
+
+    sr->triangles = GrowArray(sr->triangles, &sr->triangleCapacity, sr->triangleCount + 1, sizeof(SoftRasterTriangle));
+    sr->triangles[sr->triangleCount++] = tri;
+}
+
+static SoftRasterVertex LerpVertex(const SoftRasterVertex *a, const SoftRasterVertex *b, float t)
+{
+    SoftRasterVertex v;
+    v.clip.x = a->clip.x + (b->clip.x - a->clip.x) * t;
+    v.clip.y = a->clip.y + (b->clip.y - a->clip.y) * t;
+    v.clip.z = a->clip.z + (b->clip.z - a->clip.z) * t;
+    v.clip.w = a->clip.w + (b->clip.w - a->clip.w) * t;
+    for (int i = 0; i < SOFTRASTER_ATTRIB_COUNT; i++) v.attribs[i] = a->attribs[i] + (b->attribs[i] - a->attribs[i]) * t;
+    return v;
+}
+
+// clips against the near plane (z >= -w) and emits up to two triangles
+static void ClipAndAddTriangle(SoftRaster *sr, const SoftRasterVertex *v, int material)
+{
+    float d[3];
+    int insideCount = 0;
+    for (int k = 0; k < 3; k++)
+    {
+        d[k] = v[k].clip.z + v[k].clip.w;
+        if (d[k] >= 0.0f) insideCount++;
+    }
+    if (insideCount == 3)
+    {
+        AddTriangle(sr, &v[0], &v[1], &v[2], material);
+        return;
+    }
+    if (insideCount == 0) return;
+
+    SoftRasterVertex polygon[4];
+    int count = 0;
+    for (int k = 0; k < 3; k++)
+    {
+        int n = (k + 1) % 3;
+        if (d[k] >= 0.0f) polygon[count++] = v[k];
+        if ((d[k] >= 0.0f) != (d[n] >= 0.0f)) polygon[count++] = LerpVertex(&v[k], &v[n], d[k] / (d[k] - d[n]));
+    }
+    for (int k = 2; k < count; k++) AddTriangle(sr, &polygon[0], &polygon[k - 1], &polygon[k], material);
+}
+
+static int IsOutsideFrustumSide(const SoftRasterVertex *v)
+{
+    // trivially reject triangles that are completely beyond one of the side planes
+    if (v[0].clip.x > v[0].clip.w && v[1].clip.x > v[1].clip.w && v[2].clip.x > v[2].clip.w) return 1;
+    if (v[0].clip.x < -v[0].clip.w && v[1].clip.x < -v[1].clip.w && v[2].clip.x < -v[2].clip.w) return 1;
+    if (v[0].clip.y > v[0].clip.w && v[1].clip.y > v[1].clip.w && v[2].clip.y > v[2].clip.w) return 1;
+    if (v[0].clip.y < -v[0].clip.w && v[1].clip.y < -v[1].clip.w && v[2].clip.y < -v[2].clip.w) return 1;
+    if (v[0].clip.z > v[0].clip.w && v[1].clip.z > v[1].clip.w && v[2].clip.z > v[2].clip.w) return 1;
+    return 0;
+}
+
+void SoftRaster_drawMesh(Mesh mesh, const SoftRasterMaterial *material, Matrix transform)
+{
+    SoftRaster *sr = &_softRaster;
+    if (mesh.vertices == NULL) return;
+
+    int materialIndex = sr->materialCount - 1;
+    if (materialIndex < 0 || memcmp(&sr->materials[materialIndex], material, sizeof(SoftRasterMaterial)) != 0)
+    {
+        if (sr->materialCount == SOFTRASTER_MAX_MATERIALS)
+        {
+            TraceLog(LOG_WARNING, "SoftRaster_drawMesh: too many materials");
+            return;
+        }
+        materialIndex = sr->materialCount++;
+        sr->materials[materialIndex] = *material;
+    }
+
+    Matrix modelView = MatrixMultiply(transform, sr->view);
+    Matrix mvp = MatrixMultiply(modelView, sr->projection);
+    Matrix m = mvp;
+
+    for (int t = 0; t < mesh.triangleCount; t++)
+    {
+        SoftRasterVertex v[3];
+        for (int k = 0; k < 3; k++)
+        {
+            int idx = mesh.indices ? mesh.indices[t*3 + k] : t*3 + k;
+            float x = mesh.vertices[idx*3], y = mesh.vertices[idx*3 + 1], z = mesh.vertices[idx*3 + 2];
+            v[k].clip = (Vector4){
+                m.m0*x + m.m4*y + m.m8*z + m.m12,
+                m.m1*x + m.m5*y + m.m9*z + m.m13,
+                m.m2*x + m.m6*y + m.m10*z + m.m14,
+                m.m3*x + m.m7*y + m.m11*z + m.m15,
+            };
+            float *attribs = v[k].attribs;
+            attribs[0] = mesh.texcoords ? mesh.texcoords[idx*2] : 0.0f;
+            attribs[1] = mesh.texcoords ? mesh.texcoords[idx*2 + 1] : 0.0f;
+            attribs[2] = mesh.texcoords2 ? mesh.texcoords2[idx*2] : 0.0f;
+            attribs[3] = mesh.texcoords2 ? mesh.texcoords2[idx*2 + 1] : 0.0f;
+            attribs[4] = modelView.m2*x + modelView.m6*y + modelView.m10*z + modelView.m14;
+            for (int i = 0; i < 4; i++) attribs[5 + i] = mesh.colors ? mesh.colors[idx*4 + i] / 255.0f : 1.0f;
+        }
+        sr->stats.trianglesSubmitted++;
+        if (IsOutsideFrustumSide(v)) continue;
+        ClipAndAddTriangle(sr, v, materialIndex);
+    }
+}
+
+static int IsTopLeftEdge(float x0, float y0, float x1, float y1)
+{
+    // window coordinates are y up and triangles counter clockwise
+    return (y1 < y0) || (y1 == y0 && x1 < x0);
+}
+
+static void RasterizeTile(int tileIndex, void *userData)
+{
+    SoftRaster *sr = userData;
+    int tileX0 = (tileIndex % sr->tilesX) * SOFTRASTER_TILE_SIZE;
+    int tileY0 = (tileIndex / sr->tilesX) * SOFTRASTER_TILE_SIZE;
+    int tileX1 = tileX0 + SOFTRASTER_TILE_SIZE - 1;
+    int tileY1 = tileY0 + SOFTRASTER_TILE_SIZE - 1;
+    if (tileX1 > sr->width - 1) tileX1 = sr->width - 1;
+    if (tileY1 > sr->height - 1) tileY1 = sr->height - 1;
+
+    for (int y = tileY0; y <= tileY1; y++)
+    {
+        for (int x = tileX0; x <= tileX1; x++)
+        {
+            sr->color[y * sr->width + x] = sr->clearColor;
+            sr->depth[y * sr->width + x] = 1.0f;
+        }
+    }
+
+    int pixels = 0;
+    for (int n = sr->tileOffsets[tileIndex]; n < sr->tileOffsets[tileIndex + 1]; n++)
+    {
+        const SoftRasterTriangle *tri = &sr->triangles[sr->tileTriangles[n]];
+        const SoftRasterMaterial *material = &sr->materials[tri->material];
+        int minX = tri->minX > tileX0 ? tri->minX : tileX0;
+        int minY = tri->minY > tileY0 ? tri->minY : tileY0;
+        int maxX = tri->maxX < tileX1 ? tri->maxX : tileX1;
+        int maxY = tri->maxY < tileY1 ? tri->maxY : tileY1;
+
+        // edge functions; w0 is the weight of vertex 0 and uses the opposite edge 1->2
+        float ex[3], ey[3], ec[3];
+        int topLeft[3];
+        for (int k = 0; k < 3; k++)
+        {
+            int a = (k + 1) % 3, b = (k + 2) % 3;
+            ex[k] = -(tri->y[b] - tri->y[a]);
+            ey[k] = tri->x[b] - tri->x[a];
+            ec[k] = -(ex[k] * tri->x[a] + ey[k] * tri->y[a]);
+            topLeft[k] = IsTopLeftEdge(tri->x[a], tri->y[a], tri->x[b], tri->y[b]);
+        }
+
+        for (int y = minY; y <= maxY; y++)
+        {
+            float py = y + 0.5f;
+            float px = minX + 0.5f;
+            float w[3];
+            for (int k = 0; k < 3; k++) w[k] = ex[k] * px + ey[k] * py + ec[k];
+
+            for (int x = minX; x <= maxX; x++, w[0] += ex[0], w[1] += ex[1], w[2] += ex[2])
+            {
+                if (w[0] < 0.0f || w[1] < 0.0f || w[2] < 0.0f) continue;
+                if ((w[0] == 0.0f && !topLeft[0]) || (w[1] == 0.0f && !topLeft[1]) || (w[2] == 0.0f && !topLeft[2])) continue;
+
+                float b0 = w[0] * tri->invArea, b1 = w[1] * tri->invArea, b2 = w[2] * tri->invArea;
+                float z = b0 * tri->z[0] + b1 * tri->z[1] + b2 * tri->z[2];
+                int index = y * sr->width + x;
+                if (z > sr->depth[index] || z > 1.0f) continue;
+
+                float wInv = 1.0f / (b0 * tri->invW[0] + b1 * tri->invW[1] + b2 * tri->invW[2]);
+                float a[SOFTRASTER_ATTRIB_COUNT];
+                for (int i = 0; i < SOFTRASTER_ATTRIB_COUNT; i++)
+                {
+                    a[i] = (b0 * tri->attribs[0][i] + b1 * tri->attribs[1][i] + b2 * tri->attribs[2][i]) * wInv;
+                }
+                SoftRasterFragment fragment = {
+                    .x = x, .y = y,
+                    .u = a[0], .v = a[1], .u2 = a[2], .v2 = a[3],
+                    .viewZ = a[4],
+                    .color = { a[5], a[6], a[7], a[8] },
+                };
+                Color out;
+                if (!material->fragment(&fragment, material, &out)) continue;
+                sr->color[index] = out;
+                sr->depth[index] = z;
+                pixels++;
+            }
+        }
+    }
+    sr->tilePixels[tileIndex] = pixels;
+}
+
+static void BinTriangles(SoftRaster *sr)
+{
+    sr->tilesX = (sr->width + SOFTRASTER_TILE_SIZE - 1) / SOFTRASTER_TILE_SIZE;
+    sr->tilesY = (sr->height + SOFTRASTER_TILE_SIZE - 1) / SOFTRASTER_TILE_SIZE;
+    int tileCount = sr->tilesX * sr->tilesY;
+    if (tileCount + 1 > sr->tileCapacity)
+    {
+        sr->tileCapacity = tileCount + 1;
+        sr->tileOffsets = MemRealloc(sr->tileOffsets, sr->tileCapacity * sizeof(int));
+        sr->tileCursor = MemRealloc(sr->tileCursor, sr->tileCapacity * sizeof(int));
+        sr->tilePixels = MemRealloc(sr->tilePixels, sr->tileCapacity * sizeof(int));
+    }
+    memset(sr->tileCursor, 0, (tileCount + 1) * sizeof(int));
+
+    // counting sort keeps the submission order inside each bin
+    for (int i = 0; i < sr->triangleCount; i++)
+    {
+        SoftRasterTriangle *tri = &sr->triangles[i];
+        for (int ty = tri->minY / SOFTRASTER_TILE_SIZE; ty <= tri->maxY / SOFTRASTER_TILE_SIZE; ty++)
+        {
+            for (int tx = tri->minX / SOFTRASTER_TILE_SIZE; tx <= tri->maxX / SOFTRASTER_TILE_SIZE; tx++)
+            {
+                sr->tileCursor[ty * sr->tilesX + tx]++;
+            }
+        }
+    }
+    int total = 0;
+    for (int i = 0; i < tileCount; i++)
+    {
+        sr->tileOffsets[i] = total;
+        total += sr->tileCursor[i];
+        sr->tileCursor[i] = sr->tileOffsets[i];
+    }
+    sr->tileOffsets[tileCount] = total;
+
+    sr->tileTriangles = GrowArray(sr->tileTriangles, &sr->tileTriangleCapacity, total, sizeof(int));
+    for (int i = 0; i < sr->triangleCount; i++)
+    {
+        SoftRasterTriangle *tri = &sr->triangles[i];
+        for (int ty = tri->minY / SOFTRASTER_TILE_SIZE; ty <= tri->maxY / SOFTRASTER_TILE_SIZE; ty++)
+        {
+            for (int tx = tri->minX / SOFTRASTER_TILE_SIZE; tx <= tri->maxX / SOFTRASTER_TILE_SIZE; tx++)
+            {
+                sr->tileTriangles[sr->tileCursor[ty * sr->tilesX + tx]++] = i;
+            }
+        }
+    }
+}
+
+void SoftRaster_end()
+{
+    SoftRaster *sr = &_softRaster;
+    BinTriangles(sr);
+    double rasterStart = GetTime();
+    int tileCount = sr->tilesX * sr->tilesY;
+    Jobs_parallelFor(tileCount, RasterizeTile, sr);
+
+    sr->stats.trianglesRasterized = sr->triangleCount;
+    sr->stats.tileCount = tileCount;
+    for (int i = 0; i < tileCount; i++) sr->stats.pixelsShaded += sr->tilePixels[i];
+    sr->stats.setupMs = (rasterStart - sr->beginTime) * 1000.0;
+    sr->stats.rasterMs = (GetTime() - rasterStart) * 1000.0;
+}
+
+const Color *SoftRaster_getPixels()
+{
+    return _softRaster.color;
+}
+
+SoftRasterStats SoftRaster_getStats()
+{
+    return _softRaster.stats;
+}
+
+void SoftRaster_shutdown()
+{
+    SoftRaster *sr = &_softRaster;
+    MemFree(sr->color);
+    MemFree(sr->depth);
+    MemFree(sr->outline);
+    MemFree(sr->triangles);
+    MemFree(sr->tileOffsets);
+    MemFree(sr->tileCursor);
+    MemFree(sr->tilePixels);
+    MemFree(sr->tileTriangles);
+    *sr = (SoftRaster){0};
+}
+
+//----------------------------------------------------------------------------------
+// Outline post pass, a port of outline.fs; the texels are normalized like the
+// shader reads them and the neighbors are clamped at the borders like _target
+//----------------------------------------------------------------------------------
+
+static Vector4 LoadTexel(const SoftRaster *sr, int x, int y)
+{
+    x = x < 0 ? 0 : x >= sr->width ? sr->width - 1 : x;
+    y = y < 0 ? 0 : y >= sr->height ? sr->height - 1 : y;
+    Color c = sr->color[y * sr->width + x];
+    return (Vector4){ c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f };
+}
+
+// depth packed by SoftRaster_ditherFragment into red and blue
+static float Decode16bit(Vector4 texel)
+{
+    return (texel.x * 255.0f * 256.0f + texel.z * 255.0f) / 256.0f;
+}
+
+static Color OutlinePixel(const SoftRaster *sr, int x, int y)
+{
+    // dither green of the palette and the red and blue that go with it, see mapGreenToRedBlue
+    static const float palette[][3] = {
+        { 65.0f, 85.0f, 95.0f }, { 105.0f, 100.0f, 100.0f }, { 185.0f, 100.0f, 100.0f }, { 140.0f, 80.0f, 215.0f },
+        { 115.0f, 215.0f, 85.0f }, { 200.0f, 230.0f, 110.0f }, { 245.0f, 220.0f, 255.0f },
+    };
+    Vector4 texel = LoadTexel(sr, x, y);
+    Vector3 color = { 0.0f, texel.w, 0.0f };
+    float green = texel.w * 255.0f;
+    for (int i = 0; i < (int)(sizeof(palette) / sizeof(palette[0])); i++)
+    {
+        if (green < palette[i][0] + 1.0f && green > palette[i][0] - 1.0f)
+        {
+            color = (Vector3){ palette[i][1], palette[i][0], palette[i][2] };
+            break;
+        }
+    }
+    color = Vector3Scale(color, 1.0f / 255.0f);
+    if (texel.x == 1.0f && texel.y == 1.0f && texel.z == 1.0f && texel.w == 1.0f) color = (Vector3){ 1.0f, 1.0f, 1.0f };
+
+    float isEdge = 1.0f;
+    if (sr->outlineDepth || sr->outlineUv)
+    {
+        Vector4 neighbors[4] = { LoadTexel(sr, x, y + 1), LoadTexel(sr, x + 1, y), LoadTexel(sr, x, y - 1), LoadTexel(sr, x - 1, y) };
+        float z = Decode16bit(texel);
+        float zn[4];
+        int isBehindFx = texel.y >= 1.0f;
+        for (int k = 0; k < 4; k++)
+        {
+            zn[k] = Decode16bit(neighbors[k]);
+            isBehindFx = isBehindFx || (neighbors[k].y >= 1.0f && z + 0.5f > zn[k]);
+        }
+
+        int edge = 0;
+        z += 0.0001f;
+        for (int k = 0; k < 4 && sr->outlineUv && !isBehindFx; k++)
+        {
+            edge = edge || (z < zn[k] && fabsf(texel.y - neighbors[k].y) > 0.00001f);
+        }
+        if (sr->outlineDepth && !isBehindFx) edge = edge || z + 0.75f < (zn[0] + zn[1] + zn[2] + zn[3]) * 0.25f;
+        if (edge) isEdge = 0.0f;
+        else if (sr->outlineUv && !isBehindFx)
+        {
+            z -= 0.0001f;
+            for (int k = 0; k < 4; k++)
+            {
+                if (texel.y - neighbors[k].y <= -0.000001f && z <= zn[k]) isEdge = 0.0f;
+            }
+        }
+    }
+    return (Color){ ToUnorm8(color.x * isEdge), ToUnorm8(color.y * isEdge), ToUnorm8(color.z * isEdge), 255 };
+}
+
+static void OutlineRow(int y, void *userData)
+{
+    SoftRaster *sr = userData;
+    for (int x = 0; x < sr->width; x++) sr->outline[y * sr->width + x] = OutlinePixel(sr, x, y);
+}
+
+const Color *SoftRaster_outline(int depthEdges, int uvEdges)
+{
+    SoftRaster *sr = &_softRaster;
+    double start = GetTime();
+    sr->outlineDepth = depthEdges;
+    sr->outlineUv = uvEdges;
+    Jobs_parallelFor(sr->height, OutlineRow, sr);
+    sr->stats.outlineMs = (GetTime() - start) * 1000.0;
+    return sr->outline;
+}
+
+int SoftRaster_ditherFragment(const SoftRasterFragment *fragment, const SoftRasterMaterial *material, Color *out)
+{
+    float blockX, blockY;
+    if (material->ditherBaked)
+    {
+        blockX = fragment->u2;
+        blockY = fragment->v2;
+    }
+    else
+    {
+        blockX = floorf(Fract(fragment->u) * 16.0f) / 16.0f;
+        blockY = floorf(Fract(fragment->v) * 16.0f) / 16.0f;
+    }
+
+    float u = (fragment->x + 0.5f) / 128.0f;
+    float v = (fragment->y + 0.5f) / 128.0f;
+    if (fragment->u > 1.0f) v += Fract(material->time * -1.0f) / 16.0f;
+    u = Fract(u * 16.0f) / 16.0f + blockX;
+    v = Fract(v * 16.0f) / 16.0f + blockY;
+    Color color = SampleNearest(material->texture, u, v);
+    // pink transparent color
+    if (color.r > 229 && color.g < 128 && color.b > 229) return 0;
+
+    float z = Clamp(-fragment->viewZ * 32.0f * 256.0f, 0.0f, 65535.0f);
+    out->r = (unsigned char)floorf(z / 256.0f);
+    out->g = ToUnorm8(fragment->v + (fragment->u > 1.0f ? 1.0f : 0.0f));
+    out->b = ToUnorm8(fmodf(z, 256.0f) / 255.0f);
+    out->a = color.g;
+    return 1;
+}
+
+int SoftRaster_unlitFragment(const SoftRasterFragment *fragment, const SoftRasterMaterial *material, Color *out)
+{
+    Color texel = SampleNearest(material->texture, fragment->u, fragment->v);
+    out->r = ToUnorm8(texel.r / 255.0f * material->diffuse.r / 255.0f * fragment->color.x);
+    out->g = ToUnorm8(texel.g / 255.0f * material->diffuse.g / 255.0f * fragment->color.y);
+    out->b = ToUnorm8(texel.b / 255.0f * material->diffuse.b / 255.0f * fragment->color.z);
+    out->a = ToUnorm8(texel.a / 255.0f * material->diffuse.a / 255.0f * fragment->color.w);
+    return 1;
+}
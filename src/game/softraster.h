@@ -0,0 +1,65 @@
+#ifndef __GAME_SOFTRASTER_H__
+#define __GAME_SOFTRASTER_H__
+
+#include "raylib.h"
+
+// CPU triangle rasterizer for the 3D scene pass. Meshes are transformed and clipped
+// when they are drawn, binned into screen tiles at SoftRaster_end and the tiles are
+// rasterized in parallel with a depth buffer. The color buffer uses the same layout
+// as a render texture (row 0 is the bottom row), so it can be uploaded to _target
+// and go through the normal post processing.
+//
+// Nothing in here touches GL: textures are CPU images supplied by the caller and
+// SoftRaster_outline is the CPU version of the outline.fs post pass, so a frame can be
+// rendered without a window (see Game_renderSoftRaster).
+
+typedef struct SoftRasterFragment {
+    int x, y;                   // window coordinates, y up like gl_FragCoord
+    float u, v;                 // texcoords
+    float u2, v2;               // texcoords2
+    float viewZ;                // z of the view space position
+    Vector4 color;              // vertex color, 0..1
+} SoftRasterFragment;
+
+typedef struct SoftRasterMaterial SoftRasterMaterial;
+
+// returns 0 to discard the fragment
+typedef int (*SoftRasterFragmentFn)(const SoftRasterFragment *fragment, const SoftRasterMaterial *material, Color *out);
+
+typedef struct SoftRasterMaterial {
+    SoftRasterFragmentFn fragment;
+    Image texture;              // R8G8B8A8 albedo texture, no data samples as white like raylib's default texture
+    Color diffuse;
+    float time;
+    int ditherBaked;            // dither block comes from texcoords2, see DITHER_BAKED in dither.fs
+} SoftRasterMaterial;
+
+typedef struct SoftRasterStats {
+    int trianglesSubmitted;
+    int trianglesRasterized;    // after culling and clipping
+    int pixelsShaded;           // fragments that passed the depth test
+    int tileCount;
+    double setupMs;
+    double rasterMs;
+    double outlineMs;
+} SoftRasterStats;
+
+void SoftRaster_begin(int width, int height, Color clearColor);
+void SoftRaster_setCamera(Camera3D camera);
+void SoftRaster_drawMesh(Mesh mesh, const SoftRasterMaterial *material, Matrix transform);
+void SoftRaster_end();
+// color buffer of the last finished frame, width*height R8G8B8A8 pixels
+const Color *SoftRaster_getPixels();
+SoftRasterStats SoftRaster_getStats();
+void SoftRaster_shutdown();
+
+// runs outline.fs with the given OUTLINE_DEPTH / OUTLINE_UV features over the color buffer
+// of the last finished frame; returns width*height R8G8B8A8 pixels in the same layout
+const Color *SoftRaster_outline(int depthEdges, int uvEdges);
+
+// reproduces dither.fs: packed depth in red/blue, uv.y (+1 for FX) in green, dither green in alpha
+int SoftRaster_ditherFragment(const SoftRasterFragment *fragment, const SoftRasterMaterial *material, Color *out);
+// reproduces raylib's default shader: texture * diffuse * vertex color
+int SoftRaster_unlitFragment(const SoftRasterFragment *fragment, const SoftRasterMaterial *material, Color *out);
+
+#endif
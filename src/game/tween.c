@@ -0,0 +1,136 @@
+#include "tween.h"
+#include "raylib.h"
+#include "alloctrack.h"
+
+typedef struct TweenSet {
+    int count;
+    int capacity;
+    float **targets;
+    float *from;
+    float *delta;
+    double *start;
+    float *invDuration;
+    unsigned char *easing;
+    double time;
+} TweenSet;
+
+static TweenSet _tweens;
+
+static void ReserveTweens(int capacity)
+{
+    if (capacity <= _tweens.capacity) return;
+    capacity = _tweens.capacity ? _tweens.capacity * 2 : 64;
+    _tweens.targets = MemRealloc(_tweens.targets, capacity * sizeof(float*));
+    _tweens.from = MemRealloc(_tweens.from, capacity * sizeof(float));
+    _tweens.delta = MemRealloc(_tweens.delta, capacity * sizeof(float));
+    _tweens.start = MemRealloc(_tweens.start, capacity * sizeof(double));
+    _tweens.invDuration = MemRealloc(_tweens.invDuration, capacity * sizeof(float));
+    _tweens.easing = MemRealloc(_tweens.easing, capacity * sizeof(unsigned char));
+    _tweens.capacity = capacity;
+}
+
+static int FindTween(const float *target)
+{
+    for (int i = 0; i < _tweens.count; i++)
+    {
+        if (_tweens.targets[i] == target) return i;
+    }
+    return -1;
+}
+
+static void RemoveTween(int index)
+{
+    int last = --_tweens.count;
+    _tweens.targets[index] = _tweens.targets[last];
+    _tweens.from[index] = _tweens.from[last];
+    _tweens.delta[index] = _tweens.delta[last];
+    _tweens.start[index] = _tweens.start[last];
+    _tweens.invDuration[index] = _tweens.invDuration[last];
+    _tweens.easing[index] = _tweens.easing[last];
+}
+
+void Tween_add(float *target, float from, float to, float duration, TweenEasing easing)
+{
+    int index = FindTween(target);
+    if (duration <= 0.0f)
+    {
+        if (index >= 0) RemoveTween(index);
+        *target = to;
+        return;
+    }
+    if (index < 0)
+    {
+        ReserveTweens(_tweens.count + 1);
+        index = _tweens.count++;
+    }
+    _tweens.targets[index] = target;
+    _tweens.from[index] = from;
+    _tweens.delta[index] = to - from;
+    _tweens.start[index] = _tweens.time;
+    _tweens.invDuration[index] = 1.0f / duration;
+    _tweens.easing[index] = (unsigned char)easing;
+    *target = from;
+}
+
+static float Ease(int easing, float t)
+{
+    switch (easing)
+    {
+        case TWEEN_EASE_OUT:
+        {
+            float u = 1.0f - t;
+            return 1.0f - u * u * u;
+        }
+        case TWEEN_EASE_IN_OUT:
+            return t * t * (3.0f - 2.0f * t);
+        default:
+            return t;
+    }
+}
+
+void Tween_update(double time)
+{
+    _tweens.time = time;
+    for (int i = 0; i < _tweens.count; i++)
+    {
+        float t = (float)(time - _tweens.start[i]) * _tweens.invDuration[i];
+        if (t >= 1.0f)
+        {
+            *_tweens.targets[i] = _tweens.from[i] + _tweens.delta[i];
+            RemoveTween(i--);
+            continue;
+        }
+        if (t < 0.0f) t = 0.0f;
+        *_tweens.targets[i] = _tweens.from[i] + _tweens.delta[i] * Ease(_tweens.easing[i], t);
+    }
+}
+
+int Tween_getActiveCount()
+{
+    return _tweens.count;
+}
+
+int Tween_isAnimating(const float *target)
+{
+    return FindTween(target) >= 0;
+}
+
+void Tween_stopAll(int finish)
+{
+    for (int i = 0; finish && i < _tweens.count; i++)
+    {
+        *_tweens.targets[i] = _tweens.from[i] + _tweens.delta[i];
+    }
+    _tweens.count = 0;
+}
+
+void Tween_unload()
+{
+    MemFree(_tweens.targets);
+    MemFree(_tweens.from);
+    MemFree(_tweens.delta);
+    MemFree(_tweens.start);
+    MemFree(_tweens.invDuration);
+    MemFree(_tweens.easing);
+    _tweens = (TweenSet){0};
+}
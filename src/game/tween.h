@@ -0,0 +1,25 @@
+#ifndef __GAME_TWEEN_H__
+#define __GAME_TWEEN_H__
+
+// Time based interpolation of float values, e.g. panel positions, the camera orbit
+// or fades. Active tweens are kept in parallel arrays and advanced in a single pass
+// per frame; Tween_update returns immediately when nothing is animating. A value
+// can only be driven by one tween at a time, adding another one replaces it.
+
+typedef enum TweenEasing {
+    TWEEN_LINEAR,
+    TWEEN_EASE_OUT,
+    TWEEN_EASE_IN_OUT,
+} TweenEasing;
+
+// starts at the time of the last Tween_update; the target is set to from right away
+void Tween_add(float *target, float from, float to, float duration, TweenEasing easing);
+// advances all tweens to the given time, finished tweens are set to their end value
+void Tween_update(double time);
+int Tween_getActiveCount();
+int Tween_isAnimating(const float *target);
+// stops all tweens; finish: set the targets to their end values first
+void Tween_stopAll(int finish);
+void Tween_unload();
+
+#endif
@@ -1,6 +1,9 @@
-#include "raylib.h"
+#include "util.h"
+#include "sdffont.h"
 #include "rlgl.h"
+#include <stdio.h>
 #include <string.h>
+#include <float.h>
 
 static int textLineSpacing = 0;
 void SetTextLineSpacingEx(int spacing)
@@ -18,235 +21,446 @@ static int hexToInt(char chr)
     return -1;
 }
 
-// Measure string size for Font
-static Vector2 MeasureTextRich(Font font, const char *text, float fontSize, float spacing, int wrapWidth)
-{
-    Vector2 textSize = { 0 };
-
-    if ((font.texture.id == 0) || (text == NULL)) return textSize; // Security check
+// words per paragraph that the optimal mode can break, longer paragraphs are broken greedily
+#define TEXT_LAYOUT_MAX_WORDS 256
 
-    int size = TextLength(text);    // Get size in bytes of text
-    int tempByteCounter = 0;        // Used to count longer text line num chars
-    int byteCounter = 0;
+typedef struct TextWord {
+    int start, end;
+    // advances of the word's glyphs and of the whitespace after it, spacing included
+    float width;
+    float spaceWidth;
+    // followed by '\n' or the end of the text
+    int isLast;
+} TextWord;
 
-    float textWidth = 0.0f;
-    float tempTextWidth = 0.0f;     // Used to count longer text line width
+static TextWrapMode textWrapMode = TEXT_WRAP_GREEDY;
+void SetTextWrapMode(TextWrapMode mode)
+{
+    textWrapMode = mode;
+}
 
-    float textHeight = fontSize;
-    float scaleFactor = fontSize/(float)font.baseSize;
+TextWrapMode GetTextWrapMode()
+{
+    return textWrapMode;
+}
 
-    int letter = 0;                 // Current character
-    int index = 0;                  // Index position in sprite font
+// length of the color tag at text[i], 0 if there is none
+static int GetColorTagLength(const char *text, int i, int size)
+{
+    if (text[i] != '[') return 0;
+    if (strncmp(&text[i], "[color=", 7) == 0 && size - i >= 11 && text[i+11] == ']')
+    {
+        int r = hexToInt(text[i + 7]);
+        int g = hexToInt(text[i + 8]);
+        int b = hexToInt(text[i + 9]);
+        int a = hexToInt(text[i + 10]);
+        if (r >= 0 && g >= 0 && b >= 0 && a >= 0) return 12;
+    }
+    if (strncmp(&text[i], "[/color]", 8) == 0) return 8;
+    return 0;
+}
 
-    for (int i = 0; i < size;)
+// applies the color tag at text[i] to tint and returns its length, 0 if there is none
+static int ApplyColorTag(const char *text, int i, int size, Color *tint, Color *colorStack, int *colorStackIndex, int alpha)
+{
+    int length = GetColorTagLength(text, i, size);
+    if (length == 12)
     {
-        byteCounter++;
+        int r = hexToInt(text[i + 7]);
+        int g = hexToInt(text[i + 8]);
+        int b = hexToInt(text[i + 9]);
+        int a = hexToInt(text[i + 10]);
+        if (*colorStackIndex < 16) colorStack[(*colorStackIndex)++] = *tint;
+        else TraceLog(LOG_WARNING, "Color stack overflow");
+        *tint = (Color){r | r << 4, g | g << 4, b | b << 4, (a | a << 4) * alpha / 255 };
+    }
+    else if (length == 8 && *colorStackIndex > 0)
+    {
+        *tint = colorStack[--(*colorStackIndex)];
+    }
+    return length;
+}
 
-        int next = 0;
-        letter = GetCodepointNext(&text[i], &next);
-        index = GetGlyphIndex(font, letter);
+static float GetGlyphAdvance(Font font, int codepoint, float scaleFactor, float spacing)
+{
+    int index = GetGlyphIndex(font, codepoint);
+    if (font.glyphs[index].advanceX == 0) return (float)font.recs[index].width*scaleFactor + spacing;
+    return (float)font.glyphs[index].advanceX*scaleFactor + spacing;
+}
 
-        if (letter == '[')
+// reads the word at text[*i] and the whitespace after it, and a '\n' that ends it
+static void NextWord(const TextLayout *layout, const char *text, int size, int *i, TextWord *word)
+{
+    float scaleFactor = layout->fontSize/layout->font.baseSize;
+    *word = (TextWord){ .start = *i };
+    while (*i < size)
+    {
+        int tagLength = GetColorTagLength(text, *i, size);
+        if (tagLength > 0)
         {
-            // check for color tag
-            if (strncmp(&text[i], "[color=", 7) == 0 && size - i >= 11 && text[i+11] == ']')
-            {
-                int r = hexToInt(text[i + 7]);
-                int g = hexToInt(text[i + 8]);
-                int b = hexToInt(text[i + 9]);
-                int a = hexToInt(text[i + 10]);
-                if (r >= 0 && g >= 0 && b >= 0 && a >= 0)
-                {
-                    i+= 12;
-                    continue;
-                }
-            }
-            if (strncmp(&text[i], "[/color]", 8) == 0)
-            {
-                i += 8;
-                continue;
-            }
+            *i += tagLength;
+            continue;
         }
+        int codepointByteCount = 0;
+        int codepoint = GetCodepointNext(&text[*i], &codepointByteCount);
+        if (codepoint == ' ' || codepoint == '\t' || codepoint == '\n') break;
+        word->width += GetGlyphAdvance(layout->font, codepoint, scaleFactor, layout->spacing);
+        *i += codepointByteCount;
+    }
+    word->end = *i;
+    while (*i < size && (text[*i] == ' ' || text[*i] == '\t'))
+    {
+        word->spaceWidth += GetGlyphAdvance(layout->font, text[*i], scaleFactor, layout->spacing);
+        (*i)++;
+    }
+    word->isLast = *i >= size || text[*i] == '\n';
+    if (*i < size && text[*i] == '\n') (*i)++;
+}
 
-        i += next;
+// advance is the sum of the glyph advances; like MeasureTextEx the width has no spacing after the last glyph
+static void AddLine(TextLayout *layout, int start, int end, float advance)
+{
+    if (layout->lineCount == TEXT_LAYOUT_MAX_LINES)
+    {
+        layout->isTruncated = 1;
+        return;
+    }
+    layout->lines[layout->lineCount++] = (TextLine){ start, end, advance > 0.0f ? advance - layout->spacing : 0.0f };
+}
 
-        if (letter != '\n')
+static void BreakParagraphGreedy(TextLayout *layout, const char *text, int size, int *i, float wrapWidth)
+{
+    TextWord word;
+    int lineStart = -1;
+    int lineEnd = 0;
+    float lineAdvance = 0.0f;
+    float pendingSpace = 0.0f;
+    do
+    {
+        NextWord(layout, text, size, i, &word);
+        if (lineStart >= 0 && wrapWidth > 0.0f && lineAdvance + pendingSpace + word.width - layout->spacing > wrapWidth)
         {
-            if (font.glyphs[index].advanceX != 0) textWidth += font.glyphs[index].advanceX;
-            else textWidth += (font.recs[index].width + font.glyphs[index].offsetX);
+            AddLine(layout, lineStart, lineEnd, lineAdvance);
+            lineStart = -1;
         }
-        else
+        if (lineStart < 0)
         {
-            if (tempTextWidth < textWidth) tempTextWidth = textWidth;
-            byteCounter = 0;
-            textWidth = 0;
-
-            // NOTE: Line spacing is a global variable, use SetTextLineSpacing() to setup
-            textHeight += (fontSize + textLineSpacing);
+            lineStart = word.start;
+            lineAdvance = word.width;
         }
-
-        if (tempByteCounter < byteCounter) tempByteCounter = byteCounter;
+        else lineAdvance += pendingSpace + word.width;
+        lineEnd = word.end;
+        pendingSpace = word.spaceWidth;
     }
+    while (!word.isLast);
+    AddLine(layout, lineStart, lineEnd, lineAdvance);
+}
 
-    if (tempTextWidth < textWidth) tempTextWidth = textWidth;
+// returns 0 without consuming the paragraph when it has too many words
+static int BreakParagraphOptimal(TextLayout *layout, const char *text, int size, int *i, float wrapWidth)
+{
+    TextWord words[TEXT_LAYOUT_MAX_WORDS];
+    int count = 0;
+    int start = *i;
+    do
+    {
+        if (count == TEXT_LAYOUT_MAX_WORDS)
+        {
+            *i = start;
+            return 0;
+        }
+        NextWord(layout, text, size, i, &words[count]);
+    }
+    while (!words[count++].isLast);
 
-    textSize.x = tempTextWidth*scaleFactor + (float)((tempByteCounter - 1)*spacing);
-    textSize.y = textHeight;
+    // cost[k]: least cost of the first k words; lineStart[k]: first word of the last of those lines
+    float cost[TEXT_LAYOUT_MAX_WORDS + 1];
+    int lineStart[TEXT_LAYOUT_MAX_WORDS + 1];
+    cost[0] = 0.0f;
+    for (int end = 1; end <= count; end++)
+    {
+        cost[end] = FLT_MAX;
+        lineStart[end] = end - 1;
+        float advance = 0.0f;
+        for (int first = end - 1; first >= 0; first--)
+        {
+            advance += words[first].width + (first < end - 1 ? words[first].spaceWidth : 0.0f);
+            float width = advance - layout->spacing;
+            // more words only get wider; a single word that is too wide has no choice
+            if (width > wrapWidth && first < end - 1) break;
+            float slack = wrapWidth - width;
+            float lineCost = end == count || slack < 0.0f ? 0.0f : slack*slack;
+            if (cost[first] + lineCost < cost[end])
+            {
+                cost[end] = cost[first] + lineCost;
+                lineStart[end] = first;
+            }
+        }
+    }
 
-    return textSize;
+    int lineEnds[TEXT_LAYOUT_MAX_WORDS];
+    int lineCount = 0;
+    for (int end = count; end > 0; end = lineStart[end]) lineEnds[lineCount++] = end;
+    for (int line = lineCount - 1; line >= 0; line--)
+    {
+        int end = lineEnds[line];
+        int first = line == lineCount - 1 ? 0 : lineEnds[line + 1];
+        float advance = 0.0f;
+        for (int w = first; w < end; w++) advance += words[w].width + (w < end - 1 ? words[w].spaceWidth : 0.0f);
+        AddLine(layout, words[first].start, words[end - 1].end, advance);
+    }
+    return 1;
 }
 
-static float CalcNextRichtextWordWidth(Font font, const char *text, float fontSize, float spacing)
+void LayoutTextRich(TextLayout *layout, Font font, const char *text, float fontSize, float spacing, float wrapWidth,
+    TextWrapMode mode)
 {
     if (font.texture.id == 0) font = GetFontDefault();  // Safety check in case of not valid font
+    layout->font = font;
+    layout->fontSize = fontSize;
+    layout->spacing = spacing;
+    layout->size = (Vector2){ 0.0f, 0.0f };
+    layout->lineCount = 0;
+    layout->isTruncated = 0;
+    if (text == NULL) return;
 
-    float scaleFactor = fontSize/font.baseSize;
     int size = TextLength(text);
-    float textOffsetX = 0.0f;
+    int i = 0;
+    while (i < size)
+    {
+        if (mode == TEXT_WRAP_OPTIMAL && wrapWidth > 0.0f && BreakParagraphOptimal(layout, text, size, &i, wrapWidth)) continue;
+        BreakParagraphGreedy(layout, text, size, &i, wrapWidth);
+    }
+    // a final line break starts an empty line, as it does for MeasureTextEx
+    if (size > 0 && text[size - 1] == '\n') AddLine(layout, size, size, 0.0f);
 
-    for (int i=0; i < size;)
+    for (int l = 0; l < layout->lineCount; l++)
     {
-        int codepointByteCount = 0;
-        int codepoint = GetCodepointNext(&text[i], &codepointByteCount);
+        if (layout->lines[l].width > layout->size.x) layout->size.x = layout->lines[l].width;
+    }
+    // NOTE: Line spacing is a global variable, use SetTextLineSpacing() to setup
+    if (layout->lineCount > 0) layout->size.y = layout->lineCount*fontSize + (layout->lineCount - 1)*textLineSpacing;
+}
+
+typedef void (*LayoutGlyphFn)(void *userData, int codepoint, Vector2 offset, Color color, int hasColor);
+
+// calls fn for every visible glyph of the layout with its offset from the top left; the
+// color is the tint unless a tag is open
+static void ForEachLayoutGlyph(const TextLayout *layout, const char *text, Color tint, LayoutGlyphFn fn, void *userData)
+{
+    int size = TextLength(text);
+    float scaleFactor = layout->fontSize/layout->font.baseSize;         // Character quad scaling factor
+    int alpha = tint.a;
+    Color colorStack[16];
+    int colorStackIndex = 0;
 
-        if (codepoint == '[')
+    int i = 0;
+    for (int l = 0; l < layout->lineCount; l++)
+    {
+        const TextLine *line = &layout->lines[l];
+        float textOffsetY = l*(layout->fontSize + textLineSpacing);
+        float textOffsetX = 0.0f;
+        // the whitespace at the break is not drawn, tags in it still apply
+        while (i < line->start)
+        {
+            int tagLength = ApplyColorTag(text, i, size, &tint, colorStack, &colorStackIndex, alpha);
+            i += tagLength > 0 ? tagLength : 1;
+        }
+        while (i < line->end)
         {
-            // check for color tag
-            if (strncmp(&text[i], "[color=", 7) == 0 && size - i >= 11 && text[i+11] == ']')
+            int tagLength = ApplyColorTag(text, i, size, &tint, colorStack, &colorStackIndex, alpha);
+            if (tagLength > 0)
             {
-                int r = hexToInt(text[i + 7]);
-                int g = hexToInt(text[i + 8]);
-                int b = hexToInt(text[i + 9]);
-                int a = hexToInt(text[i + 10]);
-                if (r >= 0 && g >= 0 && b >= 0 && a >= 0)
-                {
-                    i+= 12;
-                    continue;
-                }
+                i += tagLength;
+                continue;
             }
-            if (strncmp(&text[i], "[/color]", 8) == 0)
+            int codepointByteCount = 0;
+            int codepoint = GetCodepointNext(&text[i], &codepointByteCount);
+            if ((codepoint != ' ') && (codepoint != '\t'))
             {
-                i += 8;
-                continue;
+                fn(userData, codepoint, (Vector2){ textOffsetX, textOffsetY }, tint, colorStackIndex > 0);
             }
+            textOffsetX += GetGlyphAdvance(layout->font, codepoint, scaleFactor, layout->spacing);
+            i += codepointByteCount;
         }
-
-        if (codepoint <= ' ')
-        {
-            return textOffsetX;
-        }
-        int index = GetGlyphIndex(font, codepoint);
-        if (font.glyphs[index].advanceX == 0) textOffsetX += ((float)font.recs[index].width*scaleFactor + spacing);
-        else textOffsetX += ((float)font.glyphs[index].advanceX*scaleFactor + spacing);
-        i+= codepointByteCount;
     }
+}
+
+typedef struct DrawGlyphContext {
+    Font font;
+    float fontSize;
+    Vector2 position;
+} DrawGlyphContext;
 
-    return textOffsetX;
+static void DrawLayoutGlyph(void *userData, int codepoint, Vector2 offset, Color color, int hasColor)
+{
+    (void)hasColor;
+    DrawGlyphContext *context = userData;
+    DrawTextCodepoint(context->font, codepoint, (Vector2){ context->position.x + offset.x, context->position.y + offset.y },
+        context->fontSize, color);
 }
 
 // Draw text using Font
 // NOTE: chars spacing is NOT proportional to fontSize
+void DrawTextLayout(const TextLayout *layout, const char *text, Vector2 position, Color tint)
+{
+    DrawGlyphContext context = { layout->font, layout->fontSize, position };
+    int isSdf = SdfFont_beginDraw(layout->font);
+    ForEachLayoutGlyph(layout, text, tint, DrawLayoutGlyph, &context);
+    SdfFont_endDraw(isSdf);
+}
+
+// Measure string size for Font, wrapped as DrawTextRich draws it
+Vector2 MeasureTextRich(Font font, const char *text, float fontSize, float spacing, int wrapWidth)
+{
+    TextLayout layout;
+    LayoutTextRich(&layout, font, text, fontSize, spacing, (float)wrapWidth, textWrapMode);
+    return layout.size;
+}
+
 void DrawTextRich(Font font, const char *text, Vector2 position, float fontSize, float spacing, int wrapWidth, Color tint)
 {
-    if (font.texture.id == 0) font = GetFontDefault();  // Safety check in case of not valid font
+    TextLayout layout;
+    LayoutTextRich(&layout, font, text, fontSize, spacing, (float)wrapWidth, textWrapMode);
+    DrawTextLayout(&layout, text, position, tint);
+}
 
-    int size = TextLength(text);    // Total size in bytes of the text, scanned by codepoints in loop
+// spacing of text boxes per unit of the scale
+#define TEXT_BOX_SPACING -1.0f
 
-    float textOffsetY = 0;          // Offset between lines (on linebreak '\n')
-    float textOffsetX = 0.0f;       // Offset X to next character to draw
+static float textBoxScale = 2.0f;
 
-    float scaleFactor = fontSize/font.baseSize;         // Character quad scaling factor
-    int alpha = tint.a;
-    Color colorStack[16];
-    int colorStackIndex = 0;
+void SetTextBoxScale(float scale)
+{
+    textBoxScale = scale;
+}
 
-    for (int i = 0; i < size;)
-    {
-        // Get next codepoint from byte string and glyph index in font
-        int codepointByteCount = 0;
-        int codepoint = GetCodepointNext(&text[i], &codepointByteCount);
-        int index = GetGlyphIndex(font, codepoint);
+float GetTextBoxScale()
+{
+    return textBoxScale;
+}
 
-        if (codepoint == '[')
-        {
-            // check for color tag
-            if (strncmp(&text[i], "[color=", 7) == 0 && size - i >= 11 && text[i+11] == ']')
-            {
-                int r = hexToInt(text[i + 7]);
-                int g = hexToInt(text[i + 8]);
-                int b = hexToInt(text[i + 9]);
-                int a = hexToInt(text[i + 10]);
-                if (r >= 0 && g >= 0 && b >= 0 && a >= 0)
-                {
-                    // valid color tag
-                    Color rgba = {r | r << 4, g | g << 4, b | b << 4, 
-                        (a | a << 4) * alpha / 255 };
-                    i+= 12;
-                    if (colorStackIndex < 16)
-                        colorStack[colorStackIndex++] = tint;
-                    else TraceLog(LOG_WARNING, "Color stack overflow");
-                    tint = rgba;
-                    continue;
-                }
-            }
-            if (strncmp(&text[i], "[/color]", 8) == 0)
-            {
-                if (colorStackIndex > 0)
-                {
-                    tint = colorStack[--colorStackIndex];
-                }
-                i += 8;
-                continue;
-            }
-        }
+float GetTextBoxFontSize(Font font)
+{
+    return SdfFont_getSourceSize(font) * textBoxScale;
+}
 
-        if (codepoint == '\n')
-        {
-            // NOTE: Line spacing is a global variable, use SetTextLineSpacing() to setup
-            textOffsetY += (fontSize + textLineSpacing);
-            textOffsetX = 0.0f;
-        }
-        else
-        {
-            float posX = position.x + textOffsetX;
-            if (font.glyphs[index].advanceX == 0) textOffsetX += ((float)font.recs[index].width*scaleFactor + spacing);
-            else textOffsetX += ((float)font.glyphs[index].advanceX*scaleFactor + spacing);
-            if ((codepoint != ' ') && (codepoint != '\t'))
-            {
-                DrawTextCodepoint(font, codepoint, (Vector2){ posX, position.y + textOffsetY }, fontSize, tint);
-            }
-            else {
-                // check next word, measure width, check if it would fit. If not, start new line.
-                float nextWordWidth = CalcNextRichtextWordWidth(font, &text[i + codepointByteCount], fontSize, spacing);
-                if (nextWordWidth + textOffsetX > wrapWidth)
-                {
-                    textOffsetY += (fontSize + textLineSpacing);
-                    textOffsetX = 0.0f;
-                    i += codepointByteCount;
-                    continue;
-                }
-            }
+Rectangle DrawTextBoxAligned(Font font, const char *text, int x, int y, int w, int h, float alignX, float alignY, Color color)
+{
+    float fontSpacing = TEXT_BOX_SPACING * textBoxScale;
+    float fontSize = GetTextBoxFontSize(font);
+    // laid out once, the alignment uses the size of the lines that are drawn
+    TextLayout layout;
+    LayoutTextRich(&layout, font, text, fontSize, fontSpacing, (float)w, textWrapMode);
+    int posX = x + (int)((w - layout.size.x) * alignX);
+    int posY = y + (int)((h - layout.size.y) * alignY);
+    DrawTextLayout(&layout, text, (Vector2){posX, posY}, color);
 
-        }
+    return (Rectangle) {
+        .x = posX, .y = posY, .width = layout.size.x, .height = layout.size.y
+    };
+}
 
-        i += codepointByteCount;   // Move text bytes counter to next codepoint
-    }
+static void StoreLayoutGlyph(void *userData, int codepoint, Vector2 offset, Color color, int hasColor)
+{
+    GlyphLayout *layout = userData;
+    if (layout->glyphCount == layout->glyphCapacity) return;
+    layout->glyphs[layout->glyphCount++] = (TextGlyph){ offset, codepoint, color, hasColor };
 }
 
-Rectangle DrawTextBoxAligned(Font font, const char *text, int x, int y, int w, int h, float alignX, float alignY, Color color)
+void LayoutTextBox(GlyphLayout *layout, Font font, const char *text, int w)
 {
-    float fontSpacing = -2.0f;
-    float fontSize = font.baseSize * 2.0f;
-    Vector2 textSize = MeasureTextRich(font, text, fontSize, fontSpacing, w);
-    int posX = x + (int)((w - textSize.x) * alignX);
-    int posY = y + (int)((h - textSize.y) * alignY);
-    DrawTextRich(font, text, (Vector2){posX, posY}, fontSize, fontSpacing, w, color);
+    TextLayout textLayout;
+    LayoutTextRich(&textLayout, font, text, GetTextBoxFontSize(font), TEXT_BOX_SPACING * textBoxScale, (float)w,
+        textWrapMode);
+    layout->glyphCount = 0;
+    layout->size = textLayout.size;
+    layout->fontTextureId = font.texture.id;
+    layout->fontSize = textLayout.fontSize;
+    layout->width = (float)w;
+    layout->mode = textWrapMode;
+    // tag colors are stored as they are, the tint's alpha is applied when drawing
+    if (text) ForEachLayoutGlyph(&textLayout, text, WHITE, StoreLayoutGlyph, layout);
+}
+
+int IsGlyphLayoutCurrent(const GlyphLayout *layout, Font font, int w)
+{
+    return layout->fontTextureId == font.texture.id && layout->fontSize == GetTextBoxFontSize(font) &&
+        layout->width == (float)w && layout->mode == textWrapMode;
+}
+
+Rectangle DrawTextBoxLayout(GlyphLayout *layout, Font font, const char *text, int x, int y, int w, int h, float alignX,
+    float alignY, Color color)
+{
+    if (!IsGlyphLayoutCurrent(layout, font, w)) LayoutTextBox(layout, font, text, w);
+    int posX = x + (int)((w - layout->size.x) * alignX);
+    int posY = y + (int)((h - layout->size.y) * alignY);
+    float fontSize = layout->fontSize;
+    int isSdf = SdfFont_beginDraw(font);
+    for (int i = 0; i < layout->glyphCount; i++)
+    {
+        const TextGlyph *glyph = &layout->glyphs[i];
+        Color tint = color;
+        if (glyph->hasColor) tint = (Color){ glyph->color.r, glyph->color.g, glyph->color.b, glyph->color.a * color.a / 255 };
+        DrawTextCodepoint(font, glyph->codepoint, (Vector2){ posX + glyph->position.x, posY + glyph->position.y }, fontSize, tint);
+    }
+    SdfFont_endDraw(isSdf);
 
     return (Rectangle) {
-        .x = posX, .y = posY, .width = textSize.x, .height = textSize.y
+        .x = posX, .y = posY, .width = layout->size.x, .height = layout->size.y
     };
 }
 
+// sum of the squared free space of every line that does not end a paragraph
+static float GetLayoutRaggedness(const TextLayout *layout, const char *text, float wrapWidth)
+{
+    float raggedness = 0.0f;
+    for (int l = 0; l < layout->lineCount - 1; l++)
+    {
+        const TextLine *line = &layout->lines[l];
+        if (text[line->end] == '\n') continue;
+        raggedness += (wrapWidth - line->width)*(wrapWidth - line->width);
+    }
+    return raggedness;
+}
+
+void BenchmarkTextLayout(Font font)
+{
+    static const char *words[] = {
+        "the", "dither", "pattern", "is", "computed", "per", "pixel", "from", "a", "[color=c22f]threshold[/color]",
+        "matrix", "and", "outlines", "come", "from", "depth", "discontinuities", "in", "the", "G-buffer,", "which",
+        "keeps", "every", "edge", "crisp", "at", "any", "render", "scale.",
+    };
+    const int wordCount = sizeof(words)/sizeof(words[0]);
+    // three long paragraphs of pseudo random words
+    static char text[6000];
+    int length = 0;
+    unsigned int seed = 1;
+    for (int paragraph = 0; paragraph < 3; paragraph++)
+    {
+        for (int w = 0; w < 100; w++)
+        {
+            seed = seed*1103515245u + 12345u;
+            length += snprintf(text + length, sizeof(text) - length, w > 0 ? " %s" : "%s", words[(seed >> 16) % wordCount]);
+        }
+        if (paragraph < 2) length += snprintf(text + length, sizeof(text) - length, "\n");
+    }
+
+    const int iterations = 200;
+    float fontSize = GetTextBoxFontSize(font);
+    float wrapWidth = 400.0f;
+    static TextLayout layout;
+    const char *modeNames[] = { "greedy", "optimal" };
+    for (int mode = TEXT_WRAP_GREEDY; mode <= TEXT_WRAP_OPTIMAL; mode++)
+    {
+        double start = GetTime();
+        for (int i = 0; i < iterations; i++) LayoutTextRich(&layout, font, text, fontSize, TEXT_BOX_SPACING * textBoxScale, wrapWidth, mode);
+        double seconds = GetTime() - start;
+        TraceLog(LOG_INFO, "text layout %s: %d bytes into %d lines in %.1f us, raggedness %.0f", modeNames[mode], length,
+            layout.lineCount, seconds / iterations * 1e6, GetLayoutRaggedness(&layout, text, wrapWidth));
+    }
+}
+
 // Rectangle DrawStyledTextBox(StyledTextBox styledTextBox)
 // {
 //     char text[1024] = {0};
@@ -3,8 +3,87 @@
 
 #include "raylib.h"
 
+// Line breaking of rich text ([color=rgba]...[/color] tags, '\n' paragraphs), shared by
+// measuring and drawing so that both see the same lines. Lines break at spaces and tabs;
+// a word wider than the wrap width gets a line of its own. The greedy mode fills each
+// line as far as it goes, the optimal mode (Knuth-Plass without hyphenation) minimizes
+// the sum of the squared free space at the end of every line but the last of each
+// paragraph, which gives more even right edges for a little more time.
+
+#define TEXT_LAYOUT_MAX_LINES 128
+
+typedef enum TextWrapMode {
+    TEXT_WRAP_GREEDY,
+    TEXT_WRAP_OPTIMAL,
+} TextWrapMode;
+
+typedef struct TextLine {
+    // bytes of the text, without the whitespace at the break
+    int start, end;
+    float width;
+} TextLine;
+
+typedef struct TextLayout {
+    Font font;
+    float fontSize;
+    float spacing;
+    Vector2 size;
+    int lineCount;
+    // lines past TEXT_LAYOUT_MAX_LINES were dropped
+    int isTruncated;
+    TextLine lines[TEXT_LAYOUT_MAX_LINES];
+} TextLayout;
+
+typedef struct TextGlyph {
+    // relative to the top left of the text
+    Vector2 position;
+    int codepoint;
+    // color of the tag around the glyph, its alpha scaled by the tint's; unused if hasColor is 0
+    Color color;
+    int hasColor;
+} TextGlyph;
+
+// Glyphs of a text box placed ahead of drawing. The caller provides the glyph buffer,
+// one glyph per byte of the text is always enough. The layout is kept until the font, the
+// text box scale, the box width or the wrap mode change.
+typedef struct GlyphLayout {
+    TextGlyph *glyphs;
+    int glyphCapacity;
+    int glyphCount;
+    Vector2 size;
+    // what the glyphs were placed for, see IsGlyphLayoutCurrent
+    unsigned int fontTextureId;
+    float fontSize;
+    float width;
+    TextWrapMode mode;
+} GlyphLayout;
+
 void SetTextLineSpacingEx(int spacing);
-void DrawTextRich(Font font, const char *text, Vector2 position, float fontSize, float spacing, Color tint);
+// mode of DrawTextBoxAligned and DrawTextRich
+void SetTextWrapMode(TextWrapMode mode);
+TextWrapMode GetTextWrapMode();
+// size of text boxes relative to the font's pixels, 2 by default; bitmap fonts blur at
+// scales that are not whole numbers, SDF fonts (see sdffont.h) stay crisp at any
+void SetTextBoxScale(float scale);
+float GetTextBoxScale();
+// size text boxes of the font are drawn at
+float GetTextBoxFontSize(Font font);
+// wrapWidth <= 0 only breaks at '\n'
+void LayoutTextRich(TextLayout *layout, Font font, const char *text, float fontSize, float spacing, float wrapWidth,
+    TextWrapMode mode);
+// draws the text the layout was made for, with the SDF shader for SDF fonts
+void DrawTextLayout(const TextLayout *layout, const char *text, Vector2 position, Color tint);
+Vector2 MeasureTextRich(Font font, const char *text, float fontSize, float spacing, int wrapWidth);
+void DrawTextRich(Font font, const char *text, Vector2 position, float fontSize, float spacing, int wrapWidth, Color tint);
 Rectangle DrawTextBoxAligned(Font font, const char *text, int x, int y, int w, int h, float alignX, float alignY, Color color);
+// places the glyphs as DrawTextBoxAligned draws the text into a box w wide; safe to call
+// from worker threads
+void LayoutTextBox(GlyphLayout *layout, Font font, const char *text, int w);
+int IsGlyphLayoutCurrent(const GlyphLayout *layout, Font font, int w);
+// DrawTextBoxAligned with a kept layout, which is only redone when it is not current
+Rectangle DrawTextBoxLayout(GlyphLayout *layout, Font font, const char *text, int x, int y, int w, int h, float alignX,
+    float alignY, Color color);
+// logs the layout time and raggedness of both modes on long paragraphs
+void BenchmarkTextLayout(Font font);
 
-#endif
\ No newline at end of file
+#endif
@@ -4,6 +4,10 @@
 extern void (*Game_init)();
 extern void (*Game_deinit)();
 extern void (*Game_update)();
+extern void (*Game_startExport)(const char*, int, float);
+extern void (*Game_startWalkthrough)(const char*);
+extern int (*Game_isBatchRunning)();
+extern int (*Game_renderSoftRaster)(const char*, int, int, int, int);
 
 static HMODULE game;
 
@@ -26,6 +30,10 @@ void load_game()
         Game_init = (void (*)())GetProcAddress(game, "Game_init");
         Game_deinit = (void (*)())GetProcAddress(game, "Game_deinit");
         Game_update = (void (*)())GetProcAddress(game, "Game_update");
+        Game_startExport = (void (*)(const char*, int, float))GetProcAddress(game, "Game_startExport");
+        Game_startWalkthrough = (void (*)(const char*))GetProcAddress(game, "Game_startWalkthrough");
+        Game_isBatchRunning = (int (*)())GetProcAddress(game, "Game_isBatchRunning");
+        Game_renderSoftRaster = (int (*)(const char*, int, int, int, int))GetProcAddress(game, "Game_renderSoftRaster");
     }
 }
 #endif
\ No newline at end of file
@@ -13,6 +13,13 @@
 
 #include "raylib.h"
 
+// The desktop build hot reloads the game code from game.dll, see build_game. With
+// GAME_UNITY_BUILD the game sources are compiled into the executable as one unit
+// instead, as on the other platforms; that is the release build (make release).
+#if defined(PLATFORM_DESKTOP) && !defined(GAME_UNITY_BUILD)
+    #define GAME_HOT_RELOAD
+#endif
+
 #if defined(PLATFORM_WEB)
     #define CUSTOM_MODAL_DIALOGS            // Force custom modal dialogs usage
     #include <emscripten/emscripten.h>      // Emscripten library - LLVM to JavaScript compiler
@@ -52,23 +59,60 @@ static const int screenHeight = 450;
 
 // TODO: Define global variables here, recommended to make them static
 
+// Batch runs, the program quits when they are done:
+// --export <file.y4m | directory> [--fps <n>] [--step-seconds <s>]: renders every step of
+//   the script offline at a fixed frame rate and writes the frames
+// --walkthrough [report file]: plays every step of the script in a hidden window and
+//   reports the frame times, used for profile guided optimization and benchmarks
+// --softraster <file.y4m | directory> [--frames <n>] [--fps <n>]: renders the scene with the
+//   CPU rasterizer without opening a window, for machines without a GPU or display
+static const char *exportPath = NULL;
+static int exportFps = 30;
+static float exportStepSeconds = 6.0f;
+static int isWalkthrough = 0;
+static const char *walkthroughReport = NULL;
+static const char *softRasterPath = NULL;
+static int softRasterFrames = 120;
+static int isBatchStarted = 0;
+static int isBatchDone = 0;
+
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
 static void UpdateDrawFrame(void);      // Update and Draw one frame
+int renderSoftRaster(void);             // Run --softraster, no window is opened
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
 #if !defined(_DEBUG)
     SetTraceLogLevel(LOG_NONE);         // Disable raylib trace log messages
 #endif
 
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) exportPath = argv[++i];
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) exportFps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--step-seconds") == 0 && i + 1 < argc) exportStepSeconds = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--softraster") == 0 && i + 1 < argc) softRasterPath = argv[++i];
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) softRasterFrames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--walkthrough") == 0)
+        {
+            isWalkthrough = 1;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) walkthroughReport = argv[++i];
+        }
+        else LOG("Unknown argument: %s\n", argv[i]);
+    }
+    // batch runs report their results through the log
+    if (exportPath || isWalkthrough || softRasterPath) SetTraceLogLevel(LOG_INFO);
+    if (softRasterPath) return renderSoftRaster() ? 0 : 1;
+
     // Initialization
     //--------------------------------------------------------------------------------------
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);  // Enable resizable window
+    if (isWalkthrough) SetConfigFlags(FLAG_WINDOW_HIDDEN);
     InitWindow(screenWidth, screenHeight, "raylib gamejam template");
     
     // TODO: Load resources / Initialize variables at this point
@@ -85,7 +129,7 @@ int main(void)
     //--------------------------------------------------------------------------------------
 
     // Main game loop
-    while (!WindowShouldClose())    // Detect window close button
+    while (!WindowShouldClose() && !isBatchDone)    // Detect window close button
     {
         UpdateDrawFrame();
     }
@@ -99,7 +143,7 @@ int main(void)
     return 0;
 }
 
-#ifdef PLATFORM_DESKTOP
+#if defined(GAME_HOT_RELOAD)
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -107,6 +151,10 @@ int main(void)
 void (*Game_init)(void**);
 void (*Game_deinit)();
 void (*Game_update)();
+void (*Game_startExport)(const char*, int, float);
+void (*Game_startWalkthrough)(const char*);
+int (*Game_isBatchRunning)();
+int (*Game_renderSoftRaster)(const char*, int, int, int, int);
 
 static void* contextData = NULL;
 
@@ -132,20 +180,35 @@ void update()
     {
         Game_update();
     }
+#if defined(GAME_FRAME_CONTROL)
+    // the game polls the input itself (see game/framepacer.h), without it the window still has to
+    else PollInputEvents();
+#endif
+}
+
+void startBatch()
+{
+    if (exportPath && Game_startExport)
+    {
+        Game_startExport(exportPath, exportFps, exportStepSeconds);
+    }
+    else if (isWalkthrough && Game_startWalkthrough)
+    {
+        Game_startWalkthrough(walkthroughReport);
+    }
+}
+
+int isBatchRunning()
+{
+    return Game_isBatchRunning ? Game_isBatchRunning() : 0;
 }
 
 void unload_game();
 void load_game();
 
 static int is_built = 0;
-static void build_game()
+static void compile_game()
 {
-    is_built = 1;
-    deinit();
-    unload_game();
-    Game_deinit = NULL;
-    Game_init = NULL;
-    Game_update = NULL;
     char buildCommand[1024] = {0};
     char cfilelist[2048] = {0};
     FilePathList files = LoadDirectoryFiles("game");
@@ -161,18 +224,67 @@ static void build_game()
     }
     UnloadDirectoryFiles(files);
 
-    sprintf(buildCommand, "gcc -I../../raylib/src -L../../raylib/src -o game.dll -shared -fPIC %s -lraylib",
-            cfilelist);
+    // opengl32 for the GL entry points of the readback ring and the GPU timers, see game/glentry.h;
+    // the game paces the frames only if this host leaves that to it, see game/framepacer.h
+#if defined(GAME_FRAME_CONTROL)
+    const char *frameControlFlag = "-DGAME_FRAME_CONTROL";
+#else
+    const char *frameControlFlag = "";
+#endif
+    sprintf(buildCommand, "gcc -I../../raylib/src -L../../raylib/src -o game.dll -shared -fPIC -DGAME_ASYNC_READBACK -DGAME_GPU_TIMERS %s %s -lraylib -lpthread -lopengl32",
+            frameControlFlag, cfilelist);
     printf("Building game: %s\n", buildCommand);
     system(buildCommand);
     load_game();
+}
+
+static void build_game()
+{
+    is_built = 1;
+    deinit();
+    unload_game();
+    Game_deinit = NULL;
+    Game_init = NULL;
+    Game_update = NULL;
+    Game_startExport = NULL;
+    Game_startWalkthrough = NULL;
+    Game_isBatchRunning = NULL;
+    Game_renderSoftRaster = NULL;
+    compile_game();
     init();
 }
+
+int renderSoftRaster()
+{
+    compile_game();
+    if (!Game_renderSoftRaster) return 0;
+    return Game_renderSoftRaster(softRasterPath, screenWidth, screenHeight, exportFps, softRasterFrames);
+}
 #else
 // simple way to make it build without specifying files
+#define GAME_BUILD_NAME "unity"
 #include "game/main.c"
-#include "game/actions.c"
+#include "game/scriptactions.c"
 #include "game/util.c"
+#include "game/rendertarget.c"
+#include "game/modelimport.c"
+#include "game/meshopt.c"
+#include "game/shadervariant.c"
+#include "game/jobs.c"
+#include "game/softraster.c"
+#include "game/drawlist.c"
+#include "game/arena.c"
+#include "game/scriptfile.c"
+#include "game/bundle.c"
+#include "game/tween.c"
+#include "game/replay.c"
+#include "game/readback.c"
+#include "game/glentry.c"
+#include "game/picking.c"
+#include "game/export.c"
+#include "game/alloctrack.c"
+#include "game/framepacer.c"
+#include "game/sdffont.c"
 int isInitialized = 0;
 void *contextData = NULL;
 void init()
@@ -194,15 +306,33 @@ void update()
     }
     Game_update();
 }
+
+void startBatch()
+{
+    if (exportPath) Game_startExport(exportPath, exportFps, exportStepSeconds);
+    else if (isWalkthrough) Game_startWalkthrough(walkthroughReport);
+}
+
+int isBatchRunning()
+{
+    return Game_isBatchRunning();
+}
+
+int renderSoftRaster()
+{
+    return Game_renderSoftRaster(softRasterPath, screenWidth, screenHeight, exportFps, softRasterFrames);
+}
 #endif
+#if defined(GAME_HOT_RELOAD)
 static int run_foreground = 0;
+#endif
 //--------------------------------------------------------------------------------------------
 // Module functions definition
 //--------------------------------------------------------------------------------------------
 // Update and draw frame
 void UpdateDrawFrame(void)
 {
-    #ifdef PLATFORM_DESKTOP
+    #if defined(GAME_HOT_RELOAD)
     if (IsKeyPressed(KEY_R) || !is_built)
     {
         if (IsKeyDown(KEY_LEFT_CONTROL))
@@ -221,4 +351,15 @@ void UpdateDrawFrame(void)
     #endif
     
     update();
+
+    // a batch run starts once the game is initialized and ends the program when it is done
+    if ((exportPath || isWalkthrough) && !isBatchStarted)
+    {
+        isBatchStarted = 1;
+        startBatch();
+    }
+    else if (isBatchStarted && !isBatchRunning())
+    {
+        isBatchDone = 1;
+    }
 }
\ No newline at end of file
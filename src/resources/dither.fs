@@ -10,14 +10,26 @@
 //          If UV.x is > 1.0, we add 1.0 to UV.y to indicate that the pixel belongs to FX (transparent)
 // - Blue: Z value from the vertex position, used to prioritize the outline.
 // - Alpha: Not used atm.
+// Variants (see shadervariant.c):
+// - DITHER_BAKED: the block offset comes from the vertex data (texcoords2), which is
+//   filled in at import time (see modelimport.c), so the fract/floor lookup per fragment is skipped.
+// - DITHER_OBJECT_ID: id pass of picking (see picking.h). The target is the single pixel
+//   of the scene target at pickOrigin, so the same fragments are discarded, and the
+//   remaining ones write the object id that is passed in colDiffuse.
 precision highp float;                // Precision required for OpenGL ES2 (WebGL)
 varying vec2 fragTexCoord;
+#ifdef DITHER_BAKED
+varying vec2 fragBlockPos;
+#endif
 varying vec4 fragColor;
 varying vec3 fragPosition;
 
 uniform sampler2D texture0;
 uniform vec4 colDiffuse;
 uniform float time;
+#ifdef DITHER_OBJECT_ID
+uniform vec2 pickOrigin;
+#endif
 
 vec2 encode16bit(float x) {
     // Ensure the value is within the 16-bit range
@@ -32,7 +44,14 @@ vec2 encode16bit(float x) {
 
 void main() {
     vec2 screenPos = gl_FragCoord.xy;
+#ifdef DITHER_OBJECT_ID
+    screenPos += pickOrigin;
+#endif
+#ifdef DITHER_BAKED
+    vec2 blockPos = fragBlockPos;
+#else
     vec2 blockPos = floor(fract(fragTexCoord) * 16.0) / 16.0;
+#endif
     vec2 uv = screenPos / vec2(128.0, 128.0);
     if (fragTexCoord.x > 1.0)
     {
@@ -48,9 +67,13 @@ void main() {
         discard;
     }
     
+#ifdef DITHER_OBJECT_ID
+    gl_FragColor = colDiffuse;
+#else
     gl_FragColor.g = fragTexCoord.y + (fragTexCoord.x > 1.0 ? 1.0 : 0.0);
     float z = -fragPosition.z * 32.0;
     gl_FragColor.rb = encode16bit(z);
     // use green channel value to reconstruct red / blue via lookup
     gl_FragColor.a = color.g;
+#endif
 }
\ No newline at end of file
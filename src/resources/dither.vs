@@ -1,8 +1,18 @@
 precision highp float;                // Precision required for OpenGL ES2 (WebGL) (on some browsers)
 attribute vec3 vertexPosition;
 attribute vec2 vertexTexCoord;
+#ifdef DITHER_BAKED
+attribute vec2 vertexTexCoord2;
+#endif
 attribute vec4 vertexColor;
+#ifdef DITHER_INSTANCED
+// model matrix per instance, mvp is view * projection only in DrawMeshInstances
+attribute mat4 instanceTransform;
+#endif
 varying vec2 fragTexCoord;
+#ifdef DITHER_BAKED
+varying vec2 fragBlockPos;
+#endif
 varying vec4 fragColor;
 varying vec3 fragPosition;
 
@@ -12,8 +22,17 @@ uniform mat4 matModel;
 uniform mat4 mvp;
 void main() {
     fragTexCoord = vertexTexCoord;
+#ifdef DITHER_BAKED
+    // dither block offset, baked per triangle at import
+    fragBlockPos = vertexTexCoord2;
+#endif
     fragColor = vertexColor;
     
+#ifdef DITHER_INSTANCED
+    gl_Position = mvp * instanceTransform * vec4(vertexPosition, 1.0);
+    fragPosition = (matView * instanceTransform * vec4(vertexPosition, 1.0)).xyz;
+#else
     gl_Position = mvp * vec4(vertexPosition, 1.0);
     fragPosition = (matView * matModel * vec4(vertexPosition, 1.0)).xyz;
+#endif
 }
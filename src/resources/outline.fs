@@ -7,6 +7,10 @@
 // - if the uv.y value is greater than 1.0, no edge detection is run, IF the current pixel is behind it.
 //   This is done to have no outline behind FX objects but still having the outline when in front.
 // The texture is 32bit float, which allows us to store the color in a single float.
+// The shader is compiled in variants (see shadervariant.c), features are enabled by defines:
+// - OUTLINE_DEPTH: outlines where a pixel sticks out of the plane of its neighbors
+// - OUTLINE_UV: outlines where the uv.y value changes
+// Without any of them, the neighbor pixels are not sampled at all.
 precision highp float;                // Precision required for OpenGL ES2 (WebGL)
 varying vec2 fragTexCoord;
 varying vec4 fragColor;
@@ -14,9 +18,6 @@ uniform sampler2D texture0;
 uniform vec4 colDiffuse;
 uniform vec2 resolution;
 
-uniform float depthOutlineEnabled;
-uniform float uvOutlineEnabled;
-
 float decode16bit(vec2 encoded) {
     // Reconstruct the 16-bit value from two 8-bit components
     float high = encoded.x * 255.0;
@@ -39,20 +40,10 @@ bool mapGreenToRedBlue(float green, float match, vec2 rg, out vec3 col)
 
 void main() {
     vec4 texelColor = texture2D(texture0, fragTexCoord.xy);
-    float z = decode16bit(texelColor.rb);
     // float zg = z * 0.1;
     // gl_FragColor = vec4(zg, zg, zg, 1.0);
     // return;
     // gl_FragColor = vec4(texelColor.bbb*10.0, 1.0);
-    vec4 texelColorN = texture2D(texture0, fragTexCoord.xy + vec2(0.0, 1.0 / resolution.y));
-    vec4 texelColorE = texture2D(texture0, fragTexCoord.xy + vec2(1.0 / resolution.x, 0.0));
-    vec4 texelColorS = texture2D(texture0, fragTexCoord.xy - vec2(0.0, 1.0 / resolution.y));
-    vec4 texelColorW = texture2D(texture0, fragTexCoord.xy - vec2(1.0 / resolution.x, 0.0));
-    
-    float zN = decode16bit(texelColorN.rb);
-    float zE = decode16bit(texelColorE.rb);
-    float zS = decode16bit(texelColorS.rb);
-    float zW = decode16bit(texelColorW.rb);
     
     // unpack color from 32bit but potential 16bit red channel
     float f = texelColor.r;
@@ -79,6 +70,18 @@ void main() {
         color = vec3(1.0);
     }
 
+#if defined(OUTLINE_DEPTH) || defined(OUTLINE_UV)
+    float z = decode16bit(texelColor.rb);
+    vec4 texelColorN = texture2D(texture0, fragTexCoord.xy + vec2(0.0, 1.0 / resolution.y));
+    vec4 texelColorE = texture2D(texture0, fragTexCoord.xy + vec2(1.0 / resolution.x, 0.0));
+    vec4 texelColorS = texture2D(texture0, fragTexCoord.xy - vec2(0.0, 1.0 / resolution.y));
+    vec4 texelColorW = texture2D(texture0, fragTexCoord.xy - vec2(1.0 / resolution.x, 0.0));
+    
+    float zN = decode16bit(texelColorN.rb);
+    float zE = decode16bit(texelColorE.rb);
+    float zS = decode16bit(texelColorS.rb);
+    float zW = decode16bit(texelColorW.rb);
+
     if (texelColor.g >= 1.0 
         || (texelColorW.g >= 1.0 && z + 0.5 > zW)
         || (texelColorE.g >= 1.0 && z + 0.5 > zE)
@@ -97,37 +100,47 @@ void main() {
     float vS = texelColorS.g;
     float vW = texelColorW.g;
     z += 0.0001;
+    bool edge = false;
+#ifdef OUTLINE_UV
     // v is the y coordinate of the UVs. If it differs, we want to draw a line (this is manually
     // defined when creating the 3d models). We only want a single pixel border. 
-    if (
-        // In the first checks here
-        // we only use the v-difference to mark the edge, if the current pixel is in front of our neighbor.
-        // without the z comparison, we would have 2 pixel wide edges
-        (z < zE && abs(v - vE) > 0.00001 && uvOutlineEnabled > 0.0) || 
-        (z < zW && abs(v - vW) > 0.00001 && uvOutlineEnabled > 0.0) || 
-        (z < zS && abs(v - vS) > 0.00001 && uvOutlineEnabled > 0.0) || 
-        (z < zN && abs(v - vN) > 0.00001 && uvOutlineEnabled > 0.0) ||
-        // This 2nd check does z based edge detection; 
-        // if the z value is closer than the assumed z value calculated using the
-        // neighboring z values, we want an edge. It "sticks out" of the plane of neighboring pixels 
-        // if this test succeeds, it means we found an edge due to a distance difference. Adding
-        // a small value to compensate for rounding errors.
-        (z + 0.75 < (zE + zW + zN + zS) * 0.25 && depthOutlineEnabled > 0.0)
-        )
+    // In the first checks here
+    // we only use the v-difference to mark the edge, if the current pixel is in front of our neighbor.
+    // without the z comparison, we would have 2 pixel wide edges
+    edge = edge ||
+        (z < zE && abs(v - vE) > 0.00001) || 
+        (z < zW && abs(v - vW) > 0.00001) || 
+        (z < zS && abs(v - vS) > 0.00001) || 
+        (z < zN && abs(v - vN) > 0.00001);
+#endif
+#ifdef OUTLINE_DEPTH
+    // This 2nd check does z based edge detection; 
+    // if the z value is closer than the assumed z value calculated using the
+    // neighboring z values, we want an edge. It "sticks out" of the plane of neighboring pixels 
+    // if this test succeeds, it means we found an edge due to a distance difference. Adding
+    // a small value to compensate for rounding errors.
+    edge = edge || (z + 0.75 < (zE + zW + zN + zS) * 0.25);
+#endif
+    if (edge)
     {
         isEdge = 0.0;
     }
+#ifdef OUTLINE_UV
     else {
         z -= 0.0001;
         // the z comparison prevents another double edge
         // the v comparison is signed and is therefore also going only to one side
-        if ((v - vW <= -0.000001 && z <= zW && uvOutlineEnabled > 0.0) ||
-            (v - vS <= -0.000001 && z <= zS && uvOutlineEnabled > 0.0) ||
-            (v - vN <= -0.000001 && z <= zN && uvOutlineEnabled > 0.0) ||
-            (v - vE <= -0.000001 && z <= zE && uvOutlineEnabled > 0.0))
+        if ((v - vW <= -0.000001 && z <= zW) ||
+            (v - vS <= -0.000001 && z <= zS) ||
+            (v - vN <= -0.000001 && z <= zN) ||
+            (v - vE <= -0.000001 && z <= zE))
         {
             isEdge = 0.0;
         }
     }
+#endif
     gl_FragColor = vec4(isEdge * color, 1.0);
+#else
+    gl_FragColor = vec4(color, 1.0);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,19 @@
+// signed distance field text, see game/sdffont.h;
+// the atlas holds the distance to the glyph's edge in the alpha channel, 0.5 on the edge
+// and more inside. The edge is smoothed over about one screen pixel, whatever the scale.
+#ifdef GL_ES
+#extension GL_OES_standard_derivatives : enable
+#endif
+precision highp float;                // Precision required for OpenGL ES2 (WebGL)
+varying vec2 fragTexCoord;
+varying vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+void main()
+{
+    float distance = texture2D(texture0, fragTexCoord).a - 0.5;
+    float width = length(vec2(dFdx(distance), dFdy(distance)))*0.70710678;
+    float alpha = smoothstep(-width, width, distance);
+    gl_FragColor = vec4(fragColor.rgb, fragColor.a*alpha)*colDiffuse;
+}
@@ -0,0 +1,95 @@
+/*******************************************************************************************
+*
+*   bundlepack - bakes the game resources into resources/game.bundle, see game/bundle.h
+*
+*   Run from the src folder ("make bundle" does that). raylib's model loader uploads
+*   meshes, so a hidden window provides the GL context.
+*
+********************************************************************************************/
+
+#include "raylib.h"
+#include "../game/bundle.c"
+#include "../game/modelimport.c"
+#include "../game/meshopt.c"
+#include "../game/alloctrack.c"
+#include <stdio.h>
+
+static const char *modelFiles[] = {
+    "resources/polyobjects.glb",
+    "resources/sampleObjects.glb",
+    "resources/flat-vector-scene.glb",
+    "resources/flat-vector-scene-outlines.glb",
+};
+
+static const char *fontFiles[] = {
+    "resources/fnt_medium.png",
+    "resources/fnt_mymono.png",
+};
+
+// packed as zero terminated text
+static const char *textFiles[] = {
+    "resources/dither.vs",
+    "resources/dither.fs",
+    "resources/outline.fs",
+    "resources/sdf_text.fs",
+    "resources/tutorial.script",
+};
+
+#define COUNT_OF(array) ((int)(sizeof(array)/sizeof(array[0])))
+
+int main(int argc, char **argv)
+{
+    const char *outFileName = argc > 1 ? argv[1] : BUNDLE_FILE;
+
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(64, 64, "bundlepack");
+
+    BundleWriter *writer = BundleWriter_create();
+    int failed = 0;
+
+    for (int i = 0; i < COUNT_OF(modelFiles); i++)
+    {
+        Model model = LoadModel(modelFiles[i]);
+        if (model.meshCount == 0)
+        {
+            failed = 1;
+            continue;
+        }
+        // bake the dither blocks now so the game can upload the vertex data as is
+        ModelImportInfo *info = ModelImport_process(&model, GetFileName(modelFiles[i]));
+        BundleWriter_addModel(writer, modelFiles[i], model, info && info->ditherBaked);
+        UnloadModel(model);
+    }
+    ModelImport_clear();
+
+    for (int i = 0; i < COUNT_OF(fontFiles); i++)
+    {
+        Font font = LoadFont(fontFiles[i]);
+        if (font.texture.id == 0 || font.texture.id == GetFontDefault().texture.id)
+        {
+            failed = 1;
+            continue;
+        }
+        BundleWriter_addFont(writer, fontFiles[i], font);
+        UnloadFont(font);
+    }
+
+    for (int i = 0; i < COUNT_OF(textFiles); i++)
+    {
+        char *text = LoadFileText(textFiles[i]);
+        if (text == NULL)
+        {
+            failed = 1;
+            continue;
+        }
+        BundleWriter_addData(writer, textFiles[i], text, (int)strlen(text) + 1);
+        UnloadFileText(text);
+    }
+
+    if (failed) TraceLog(LOG_ERROR, "bundlepack: some resources could not be loaded");
+    else if (!BundleWriter_save(writer, outFileName)) failed = 1;
+    BundleWriter_free(writer);
+
+    CloseWindow();
+    return failed;
+}